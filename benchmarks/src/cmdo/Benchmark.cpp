@@ -0,0 +1,107 @@
+#include "cmdo/Benchmark.h"
+#include <ctime>
+#include <thread>
+
+namespace cmdo {
+namespace bench {
+
+State::State(std::size_t arg)
+    : arg_(arg), itemsPerOp_(1), iterations_(0), nsPerItem_(0) {
+}
+
+void State::set_items_per_op(std::size_t items) {
+  itemsPerOp_ = items > 0 ? items : 1;
+}
+
+std::size_t State::arg() const {
+  return arg_;
+}
+
+std::size_t State::iterations() const {
+  return iterations_;
+}
+
+std::size_t State::items_per_op() const {
+  return itemsPerOp_;
+}
+
+double State::ns_per_item() const {
+  return nsPerItem_;
+}
+
+std::vector<Benchmark> &registry() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+Registrar::Registrar(std::string const &name,
+                     std::vector<std::size_t> const &args,
+                     BenchmarkFunction function) {
+  registry().push_back(Benchmark{name, args, function});
+}
+
+char const *const Reporter::FORMATS[] = {"table", "json", "csv"};
+
+bool Reporter::is_format(std::string const &format) {
+  for (char const *known : FORMATS) {
+    if (format == known) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Reporter::Reporter(std::string const &format, std::FILE *out)
+    : format_(format), out_(out), count_(0) {
+}
+
+void Reporter::begin() {
+  if (format_ == "json") {
+    char date[32];
+    std::time_t const now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ",
+                  std::gmtime(&now));
+    std::fprintf(out_, "{\n  \"context\": {\n"
+                       "    \"date\": \"%s\",\n"
+                       "    \"compiler\": \"%s\",\n"
+                       "    \"cpus\": %u\n"
+                       "  },\n  \"benchmarks\": [", date, __VERSION__,
+                 std::thread::hardware_concurrency());
+  } else if (format_ == "csv") {
+    std::fprintf(out_, "name,arg,iterations,items_per_op,ns_per_item\n");
+  } else {
+    std::fprintf(out_, "%-32s %10s %12s %14s\n", "benchmark", "arg",
+                 "iterations", "ns/item");
+  }
+  std::fflush(out_);
+}
+
+void Reporter::add(std::string const &name, State const &state) {
+  if (format_ == "json") {
+    std::fprintf(out_, "%s\n    {\"name\": \"%s\", \"arg\": %zu, "
+                       "\"iterations\": %zu, \"items_per_op\": %zu, "
+                       "\"ns_per_item\": %.3f}",
+                 count_ == 0 ? "" : ",", name.c_str(), state.arg(),
+                 state.iterations(), state.items_per_op(),
+                 state.ns_per_item());
+  } else if (format_ == "csv") {
+    std::fprintf(out_, "%s,%zu,%zu,%zu,%.3f\n", name.c_str(), state.arg(),
+                 state.iterations(), state.items_per_op(),
+                 state.ns_per_item());
+  } else {
+    std::fprintf(out_, "%-32s %10zu %12zu %14.2f\n", name.c_str(),
+                 state.arg(), state.iterations(), state.ns_per_item());
+  }
+  ++count_;
+  std::fflush(out_);
+}
+
+void Reporter::end() {
+  if (format_ == "json") {
+    std::fprintf(out_, "\n  ]\n}\n");
+  }
+  std::fflush(out_);
+}
+
+}
+}
@@ -0,0 +1,134 @@
+#ifndef CMDO_BENCHMARK_H
+#define CMDO_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cmdo {
+namespace bench {
+
+/**
+ * @brief Passed to every benchmark. Holds the benchmark argument (option
+ * count, argc, ...) and collects the timing of the measured operation.
+ */
+class State {
+public:
+  explicit State(std::size_t arg);
+
+  std::size_t arg() const;
+
+  /**
+   * @brief Runs op repeatedly, doubling the batch size until a batch takes
+   * long enough to be measured. Only the calls to op are timed.
+   */
+  template<typename F>
+  void measure(F op);
+
+  /**
+   * @brief Reports timings per item instead of per call to the measured
+   * operation (ex. per token when the operation parses a whole argv).
+   */
+  void set_items_per_op(std::size_t items);
+
+  std::size_t iterations() const;
+
+  std::size_t items_per_op() const;
+
+  /**
+   * @brief Time per item, which is per call if set_items_per_op() is not
+   * used.
+   */
+  double ns_per_item() const;
+
+private:
+  std::size_t arg_;
+  std::size_t itemsPerOp_;
+  std::size_t iterations_;
+  double nsPerItem_;
+};
+
+typedef std::function<void(State &)> BenchmarkFunction;
+
+struct Benchmark {
+  std::string name;
+  std::vector<std::size_t> args;
+  BenchmarkFunction function;
+};
+
+std::vector<Benchmark> &registry();
+
+/**
+ * @brief Writes results as they come, in one of the formats in FORMATS:
+ * "table" for people, "json" and "csv" to compare runs between versions.
+ */
+class Reporter {
+public:
+  static char const *const FORMATS[];
+
+  /**
+   * @returns false if format is not one of FORMATS.
+   */
+  static bool is_format(std::string const &format);
+
+  Reporter(std::string const &format, std::FILE *out);
+
+  void begin();
+
+  void add(std::string const &name, State const &state);
+
+  void end();
+
+private:
+  std::string format_;
+  std::FILE *out_;
+  std::size_t count_;
+};
+
+struct Registrar {
+  Registrar(std::string const &name, std::vector<std::size_t> const &args,
+            BenchmarkFunction function);
+};
+
+/**
+ * @brief Keeps the compiler from optimizing away the computation of value.
+ */
+template<typename T>
+inline void do_not_optimize(T const &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template<typename F>
+void State::measure(F op) {
+  typedef std::chrono::steady_clock Clock;
+  std::chrono::nanoseconds const minTime = std::chrono::milliseconds(50);
+
+  std::size_t batch(1);
+  while (true) {
+    Clock::time_point const start = Clock::now();
+    for (std::size_t i(0); i < batch; ++i) {
+      op();
+    }
+    std::chrono::nanoseconds const elapsed = Clock::now() - start;
+    if (elapsed >= minTime || batch >= (std::size_t(1) << 30)) {
+      iterations_ = batch;
+      nsPerItem_ = static_cast<double>(elapsed.count())
+          / (static_cast<double>(batch) * itemsPerOp_);
+      return;
+    }
+    batch *= 2;
+  }
+}
+
+}
+}
+
+#define CMDO_BENCHMARK(name, ...) \
+  static void name(::cmdo::bench::State &); \
+  static ::cmdo::bench::Registrar name##_registrar(#name, {__VA_ARGS__}, name); \
+  static void name(::cmdo::bench::State &state)
+
+#endif //CMDO_BENCHMARK_H
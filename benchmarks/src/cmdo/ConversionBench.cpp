@@ -0,0 +1,121 @@
+#include <cmdo/StringUtil.h>
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+// The stringstream conversions StringUtil used before std::from_chars, kept
+// here as the baseline.
+template<typename T>
+T stream_from_string(std::string const &str) {
+  T v;
+  std::stringstream ss;
+  ss.str(str);
+  ss >> v;
+  if (ss.fail()) {
+    throw cmdo::BadCast();
+  }
+  return v;
+}
+
+std::array<std::string, 2> const TRUE_STRINGS = {{"true", "yes"}};
+std::array<std::string, 2> const FALSE_STRINGS = {{"false", "no"}};
+
+template<>
+bool stream_from_string<bool>(std::string const &str) {
+  std::string str_(str);
+  for (char &c: str_) {
+    c = std::tolower(c);
+  }
+
+  if (std::any_of(TRUE_STRINGS.begin(),
+                  TRUE_STRINGS.end(),
+                  [str_](std::string const &s) { return s == str_; })) {
+    return true;
+  }
+  if (std::any_of(FALSE_STRINGS.begin(),
+                  FALSE_STRINGS.end(),
+                  [str_](std::string const &s) { return s == str_; })) {
+    return false;
+  }
+  throw cmdo::BadCast();
+}
+
+template<typename T>
+std::string stream_to_string(T const &v) {
+  std::stringstream ss;
+  ss << v;
+  return ss.str();
+}
+
+std::vector<std::string> const INTS{"0", "42", "-17", "123456", "2147483647"};
+std::vector<std::string> const DOUBLES{"0.5", "-1.25", "3.14159", "1e-3",
+                                       "123456.789"};
+std::vector<std::string> const BOOLS{"true", "no", "Yes", "FALSE"};
+
+template<typename T, typename F>
+void measure_conversions(cmdo::bench::State &state,
+                         std::vector<std::string> const &inputs, F convert) {
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(convert(inputs[next]));
+    next = (next + 1) % inputs.size();
+  });
+}
+
+}
+
+// The argument is unused: these run once.
+CMDO_BENCHMARK(Convert_Int_FromChars, 0) {
+  measure_conversions<int>(state, INTS, [](std::string const &s) {
+    return cmdo::from_string<int>(s);
+  });
+}
+
+CMDO_BENCHMARK(Convert_Int_Stream, 0) {
+  measure_conversions<int>(state, INTS, [](std::string const &s) {
+    return stream_from_string<int>(s);
+  });
+}
+
+CMDO_BENCHMARK(Convert_Double_FromChars, 0) {
+  measure_conversions<double>(state, DOUBLES, [](std::string const &s) {
+    return cmdo::from_string<double>(s);
+  });
+}
+
+CMDO_BENCHMARK(Convert_Double_Stream, 0) {
+  measure_conversions<double>(state, DOUBLES, [](std::string const &s) {
+    return stream_from_string<double>(s);
+  });
+}
+
+CMDO_BENCHMARK(Convert_Bool_FromString, 0) {
+  measure_conversions<bool>(state, BOOLS, [](std::string const &s) {
+    return cmdo::from_string<bool>(s);
+  });
+}
+
+CMDO_BENCHMARK(Convert_Bool_Stream, 0) {
+  measure_conversions<bool>(state, BOOLS, [](std::string const &s) {
+    return stream_from_string<bool>(s);
+  });
+}
+
+CMDO_BENCHMARK(Convert_IntToString_ToChars, 0) {
+  int v(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(cmdo::to_string(v++));
+  });
+}
+
+CMDO_BENCHMARK(Convert_IntToString_Stream, 0) {
+  int v(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(stream_to_string(v++));
+  });
+}
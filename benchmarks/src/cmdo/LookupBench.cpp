@@ -0,0 +1,141 @@
+#include <cmdo/CmdLineOptions.h>
+#include <cmdo/OptionIndex.h>
+#include <cmdo/OptionTrie.h>
+#include <string>
+#include <vector>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+void noop_handler(cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &) {
+}
+
+/**
+ * @brief Defines option_count optional arguments named -opt<i>.
+ */
+void define_options(cmdo::CmdLineOptions &options, std::size_t option_count) {
+  options.set_parser_result_handler(noop_handler);
+  for (std::size_t i(0); i < option_count; ++i) {
+    options.add_optional("-opt" + std::to_string(i), "benchmark option", "0");
+  }
+}
+
+}
+
+// Cost of one OptionIndex lookup, cycling through every indexed name.
+CMDO_BENCHMARK(Lookup_IndexFind, 10, 100, 1000, 10000) {
+  cmdo::OptionIndex index;
+  std::vector<std::string> names;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    names.push_back("-opt" + std::to_string(i));
+    index.insert(names.back(), cmdo::OptionIndex::Kind::Arg, i);
+  }
+
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(index.find(names[next]));
+    next = (next + 1) % names.size();
+  });
+}
+
+// Cost of one get_option() call, cycling through every defined option. This
+// should stay flat as the number of options grows.
+CMDO_BENCHMARK(Lookup_GetOption, 10, 100, 1000, 10000) {
+  cmdo::CmdLineOptions options("lookup benchmark");
+  define_options(options, state.arg());
+
+  std::vector<std::string> names;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    names.push_back("-opt" + std::to_string(i));
+  }
+
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(options.get_option(names[next]));
+    next = (next + 1) % names.size();
+  });
+}
+
+// Cost of one get_switch() call, cycling through every defined switch.
+CMDO_BENCHMARK(Lookup_GetSwitch, 10, 100, 1000, 10000) {
+  cmdo::CmdLineOptions options("lookup benchmark");
+  std::vector<std::string> names;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    names.push_back("-switch" + std::to_string(i));
+    options.add_switch(names.back(), "benchmark switch", false);
+  }
+
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(options.get_switch(names[next]));
+    next = (next + 1) % names.size();
+  });
+}
+
+// Cost of get_option_as<int>() on options defined with add_optional<int>(),
+// which return the value converted in parse().
+CMDO_BENCHMARK(Lookup_GetOptionAsTyped, 10, 100, 1000, 10000) {
+  cmdo::CmdLineOptions options("lookup benchmark");
+  std::vector<std::string> names;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    names.push_back("-opt" + std::to_string(i));
+    options.add_optional<int>(names.back(), "benchmark option",
+                              static_cast<int>(i));
+  }
+
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(options.get_option_as<int>(names[next]));
+    next = (next + 1) % names.size();
+  });
+}
+
+// Cost of get_option_as<int>() on options without a type, which convert the
+// value on every call.
+CMDO_BENCHMARK(Lookup_GetOptionAsUntyped, 10, 100, 1000, 10000) {
+  cmdo::CmdLineOptions options("lookup benchmark");
+  define_options(options, state.arg());
+
+  std::vector<std::string> names;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    names.push_back("-opt" + std::to_string(i));
+  }
+
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(options.get_option_as<int>(names[next]));
+    next = (next + 1) % names.size();
+  });
+}
+
+// Cost of one unique-prefix lookup, cycling through every name without its
+// last character. This should depend on the name length only.
+CMDO_BENCHMARK(Lookup_TriePrefix, 10, 100, 1000, 10000) {
+  cmdo::OptionTrie trie;
+  std::vector<std::string> prefixes;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    std::string const name = "-option_" + std::to_string(i) + "x";
+    trie.insert(name, cmdo::OptionIndex::Kind::Arg, i);
+    prefixes.push_back(name.substr(0, name.size() - 1));
+  }
+
+  std::size_t next(0);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(trie.find_prefix(prefixes[next]));
+    next = (next + 1) % prefixes.size();
+  });
+}
+
+// Cost of suggest_option() for a typo, which checks every option.
+CMDO_BENCHMARK(Lookup_SuggestOption, 10, 100, 1000, 10000) {
+  cmdo::CmdLineOptions options("lookup benchmark");
+  define_options(options, state.arg());
+
+  std::string const typo = "-otp" + std::to_string(state.arg() / 2);
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(options.suggest_option(typo));
+  });
+}
@@ -0,0 +1,347 @@
+#include <cmdo/CmdLineOptions.h>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+void noop_handler(cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &) {
+}
+
+/**
+ * @brief Defines option_count optional arguments named -opt<i>.
+ */
+void define_options(cmdo::CmdLineOptions &options, std::size_t option_count) {
+  options.set_parser_result_handler(noop_handler);
+  for (std::size_t i(0); i < option_count; ++i) {
+    options.add_optional("-opt" + std::to_string(i), "benchmark option", "0");
+  }
+}
+
+/**
+ * @brief An argv of "bench" followed by args, valid as long as args.
+ */
+std::vector<char *> make_argv(std::vector<std::string> &args) {
+  std::vector<char *> argv;
+  for (std::string &arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  return argv;
+}
+
+/**
+ * @brief Measures parse() of args, per token.
+ */
+void measure_parse(cmdo::bench::State &state, cmdo::CmdLineOptions &options,
+                   std::vector<std::string> &args) {
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(argv.size() - 1);
+  state.measure([&]() {
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  });
+}
+
+}
+
+// Cost per token of parse() with 1000 "-opt<i> value" pairs on the command
+// line, as the number of defined options grows. The per-token lookups are
+// constant; what grows is the required/validator pass over every option at
+// the end of parse(), which is spread over the 2000 tokens.
+CMDO_BENCHMARK(Parse_OptionCount, 10, 100, 1000, 10000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, state.arg());
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); i < 1000; ++i) {
+    args.push_back("-opt" + std::to_string(i % state.arg()));
+    args.push_back("1");
+  }
+  measure_parse(state, options, args);
+}
+
+// Cost per token of parse() as argc grows, with 100 defined options. Half
+// of the tokens are options with their values, half are positionals.
+CMDO_BENCHMARK(Parse_Argc, 10, 100, 1000, 10000, 100000, 1000000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, 100);
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); args.size() <= state.arg(); ++i) {
+    if (i % 2 == 0) {
+      args.push_back("-opt" + std::to_string(i % 100));
+      args.push_back("1");
+    } else {
+      args.push_back("/data/input" + std::to_string(i) + ".txt");
+      args.push_back("/data/other" + std::to_string(i) + ".txt");
+    }
+  }
+  args.resize(state.arg() + 1);
+  measure_parse(state, options, args);
+}
+
+// Cost per token of parse() with 100 options, all set on the command line,
+// as more of them get a validator. Compare with arg 0 for the overhead.
+CMDO_BENCHMARK(Parse_Validators, 0, 10, 100) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, 100);
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    options.attach_validator("-opt" + std::to_string(i), [](
+        std::string const &, std::string const &value) {
+      return !value.empty();
+    });
+  }
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); i < 100; ++i) {
+    args.push_back("-opt" + std::to_string(i));
+    args.push_back("1");
+  }
+  measure_parse(state, options, args);
+}
+
+// Cost of parse() with an empty command line and arg options bound to
+// environment variables, all of them set. Items are options.
+CMDO_BENCHMARK(Parse_Environment, 10, 100, 1000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  options.set_parser_result_handler(noop_handler);
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    std::string const variable = "CMDO_BENCH_OPT" + std::to_string(i);
+    ::setenv(variable.c_str(), "1", 1);
+    options.add_optional("-opt" + std::to_string(i), "benchmark option", "0",
+                         variable);
+  }
+
+  std::vector<std::string> args{"bench"};
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  });
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    ::unsetenv(("CMDO_BENCH_OPT" + std::to_string(i)).c_str());
+  }
+}
+
+// Cost of reset() with every option set by the last parse(). Items are
+// options.
+CMDO_BENCHMARK(Parse_Reset, 10, 100, 1000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, state.arg());
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    args.push_back("-opt" + std::to_string(i));
+    args.push_back("1");
+  }
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    options.reset();
+  });
+}
+
+// Same command line as Parse_Argc, given to parse() as a single string.
+CMDO_BENCHMARK(Parse_CommandLine, 10, 100, 1000, 10000, 100000, 1000000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, 100);
+
+  std::string line = "bench";
+  for (std::size_t i(0), count(0); count < state.arg(); ++i) {
+    if (i % 2 == 0) {
+      line += " -opt" + std::to_string(i % 100) + " 1";
+    } else {
+      line += " /data/input" + std::to_string(i) + ".txt /data/other"
+              + std::to_string(i) + ".txt";
+    }
+    count += 2;
+  }
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    options.parse(line, leftOvers);
+  });
+}
+
+// Cost per argument vector of parse_batch() on 10000 vectors of 20 tokens,
+// with a validator on every option, as the number of threads grows.
+CMDO_BENCHMARK(Parse_Batch, 1, 2, 4, 8) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, 100);
+  for (std::size_t i(0); i < 100; ++i) {
+    options.attach_validator("-opt" + std::to_string(i), [](
+        std::string const &, std::string const &value) {
+      return !value.empty();
+    });
+  }
+
+  std::vector<cmdo::CmdLineOptions::StringList> argvs(10000);
+  for (std::size_t i(0); i < argvs.size(); ++i) {
+    argvs[i].push_back("bench");
+    for (std::size_t j(0); j < 10; ++j) {
+      argvs[i].push_back("-opt" + std::to_string((i + j) % 100));
+      argvs[i].push_back(std::to_string(i));
+    }
+  }
+  state.set_items_per_op(argvs.size());
+  state.measure([&]() {
+    cmdo::CmdLineOptions::BatchResultList const results =
+        options.parse_batch(argvs, static_cast<unsigned>(state.arg()));
+    cmdo::bench::do_not_optimize(results.data());
+  });
+}
+
+// Cost per option of cloning the values of a parse, to hand them to
+// another thread.
+CMDO_BENCHMARK(ParseResult_Copy, 10, 100, 1000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, state.arg());
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    args.push_back("-opt" + std::to_string(i));
+    args.push_back("value" + std::to_string(i));
+  }
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  cmdo::CmdLineOptions::SnapshotPtr const snapshot = options.snapshot();
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    cmdo::ParseResult const copy(*snapshot);
+    cmdo::bench::do_not_optimize(&copy);
+  });
+}
+
+// parse() with 16 validators that wait 1ms each, like a file or host check,
+// as the number of validator threads grows. 0 runs them one after another.
+CMDO_BENCHMARK(Parse_SlowValidators, 0, 1, 4, 16) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, 16);
+  for (std::size_t i(0); i < 16; ++i) {
+    options.attach_validator("-opt" + std::to_string(i), [](
+        std::string const &, std::string const &) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      return true;
+    });
+  }
+  options.set_validator_threads(static_cast<unsigned>(state.arg()),
+                                std::chrono::milliseconds(100));
+
+  std::vector<std::string> args{"bench"};
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(16);
+  state.measure([&]() {
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  });
+}
+
+// parse() of the same values again, with 16 validators that wait 1ms each.
+// 1 makes them cacheable, so only the first parse calls them.
+CMDO_BENCHMARK(Parse_CachedValidators, 0, 1) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  define_options(options, 16);
+  for (std::size_t i(0); i < 16; ++i) {
+    options.attach_validator("-opt" + std::to_string(i), [](
+        std::string const &, std::string const &) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      return true;
+    }, state.arg() == 1);
+  }
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); i < 16; ++i) {
+    args.push_back("-opt" + std::to_string(i));
+    args.push_back("/models/" + std::to_string(i));
+  }
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(16);
+  state.measure([&]() {
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  });
+}
+
+// Startup of a tool with state.arg() subcommands of 20 options each:
+// defining the subcommands and parsing a command line that uses one. Only
+// the options of the selected subcommand are defined.
+CMDO_BENCHMARK(Parse_Subcommands, 10, 150, 1000) {
+  std::vector<std::string> args{"bench", "command7", "-opt3", "x"};
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.measure([&]() {
+    cmdo::CmdLineOptions options("parse benchmark");
+    options.set_parser_result_handler(noop_handler);
+    for (std::size_t i(0); i < state.arg(); ++i) {
+      options.add_subcommand("command" + std::to_string(i), "subcommand",
+                             [](cmdo::CmdLineOptions &command) {
+        define_options(command, 20);
+      });
+    }
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+    cmdo::bench::do_not_optimize(&options);
+  });
+}
+
+// Same tool, with the options of every subcommand defined at startup.
+CMDO_BENCHMARK(Parse_SubcommandsEager, 10, 150, 1000) {
+  std::vector<std::string> args{"bench", "-opt3", "x"};
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.measure([&]() {
+    cmdo::CmdLineOptions options("parse benchmark");
+    define_options(options, state.arg() * 20);
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+    cmdo::bench::do_not_optimize(&options);
+  });
+}
+
+// Cost per item of parse() with one "-shards 0,1,2,..." list of ints, split
+// and converted in bulk into one vector.
+CMDO_BENCHMARK(Parse_DelimitedList, 10, 1000, 100000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  options.set_parser_result_handler(noop_handler);
+  options.add_list<int>("-shards", "shard numbers", ',');
+
+  std::string shards;
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    shards += std::to_string(i) + ",";
+  }
+  std::vector<std::string> args{"bench", "-shards", shards};
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  });
+}
+
+// Cost per item of parse() with "-I dir<i>" repeated, collected into one
+// list.
+CMDO_BENCHMARK(Parse_RepeatedList, 10, 1000, 100000) {
+  cmdo::CmdLineOptions options("parse benchmark");
+  options.set_parser_result_handler(noop_handler);
+  options.add_list("-I", "include directories");
+
+  std::vector<std::string> args{"bench"};
+  for (std::size_t i(0); i < state.arg(); ++i) {
+    args.push_back("-I");
+    args.push_back("dir" + std::to_string(i));
+  }
+  std::vector<char *> argv = make_argv(args);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    options.parse(static_cast<int>(argv.size()), argv.data(), leftOvers);
+  });
+}
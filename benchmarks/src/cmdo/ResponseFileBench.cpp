@@ -0,0 +1,40 @@
+#include <cmdo/ResponseFile.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+/**
+ * @brief A response file with line_count paths.
+ */
+std::string make_contents(std::size_t line_count) {
+  std::string contents;
+  for (std::size_t i(0); i < line_count; ++i) {
+    contents += "/data/batch/input/file" + std::to_string(i) + ".txt\n";
+  }
+  return contents;
+}
+
+void tokenize(cmdo::bench::State &state, unsigned threads) {
+  std::string const contents = make_contents(state.arg());
+  cmdo::ResponseFile::TokenList tokens;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    tokens.clear();
+    cmdo::ResponseFile::tokenize(contents, tokens, threads);
+    cmdo::bench::do_not_optimize(tokens.data());
+  });
+}
+
+}
+
+// Items are lines.
+CMDO_BENCHMARK(ResponseFile_Tokenize, 10000, 100000, 1000000) {
+  tokenize(state, 1);
+}
+
+CMDO_BENCHMARK(ResponseFile_TokenizeParallel, 10000, 100000, 1000000) {
+  tokenize(state, std::max(1u, std::thread::hardware_concurrency()));
+}
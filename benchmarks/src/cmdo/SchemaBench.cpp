@@ -0,0 +1,52 @@
+#include <cmdo/CmdLineOptions.h>
+#include <cstdio>
+#include <string>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+/**
+ * @brief Defines n options like generated tools do: half switches, half
+ * arguments with a default, all with a description.
+ */
+void define_options(cmdo::CmdLineOptions &options, std::size_t n) {
+  for (std::size_t i(0); i < n; ++i) {
+    std::string const description = "generated option number "
+                                    + std::to_string(i);
+    if (i % 2 == 0) {
+      options.add_switch("--switch-" + std::to_string(i), description, false);
+    } else {
+      options.add_optional("--option-" + std::to_string(i), description,
+                           std::to_string(i));
+    }
+  }
+}
+
+}
+
+// Startup with n options: constructing CmdLineOptions and defining every
+// option. The whole schema is one item.
+CMDO_BENCHMARK(Schema_Define, 10, 1000, 8000) {
+  state.measure([&]() {
+    cmdo::CmdLineOptions options("schema benchmark");
+    define_options(options, state.arg());
+    cmdo::bench::do_not_optimize(&options);
+  });
+}
+
+// Same startup, with the options loaded from a schema file instead.
+CMDO_BENCHMARK(Schema_Load, 10, 1000, 8000) {
+  std::string const path = "cmdo_bench_" + std::to_string(state.arg())
+                           + ".schema";
+  {
+    cmdo::CmdLineOptions options("schema benchmark");
+    define_options(options, state.arg());
+    options.save_schema(path);
+  }
+  state.measure([&]() {
+    cmdo::CmdLineOptions options("schema benchmark");
+    options.load_schema(path);
+    cmdo::bench::do_not_optimize(&options);
+  });
+  std::remove(path.c_str());
+}
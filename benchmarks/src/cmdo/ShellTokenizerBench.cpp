@@ -0,0 +1,47 @@
+#include <cmdo/ShellTokenizer.h>
+#include <string>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+/**
+ * @brief A command line of token_count paths. Every quoted_every-th one is
+ * quoted, none if quoted_every is 0.
+ */
+std::string make_line(std::size_t token_count, std::size_t quoted_every) {
+  std::string line;
+  for (std::size_t i(0); i < token_count; ++i) {
+    std::string const path = "/data/batch/input/file" + std::to_string(i);
+    if (quoted_every != 0 && i % quoted_every == 0) {
+      line += "'" + path + " copy.txt' ";
+    } else {
+      line += path + ".txt ";
+    }
+  }
+  return line;
+}
+
+void tokenize(cmdo::bench::State &state, std::size_t quoted_every) {
+  std::string const line = make_line(state.arg(), quoted_every);
+  cmdo::ShellTokenizer tokenizer;
+  std::size_t bytes(0);
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    tokenizer.for_each_token(line, [&bytes](std::string_view token) {
+      bytes += token.size();
+    });
+    cmdo::bench::do_not_optimize(&bytes);
+  });
+}
+
+}
+
+// Items are tokens. Unquoted tokens are views into the line.
+CMDO_BENCHMARK(ShellTokenizer_Plain, 100, 10000, 1000000) {
+  tokenize(state, 0);
+}
+
+// Same line with one token in 4 quoted, which are copied.
+CMDO_BENCHMARK(ShellTokenizer_Quoted, 100, 10000, 1000000) {
+  tokenize(state, 4);
+}
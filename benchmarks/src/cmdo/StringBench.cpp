@@ -0,0 +1,169 @@
+#include <cmdo/CharScan.h>
+#include <cmdo/StringUtil.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+// The trim() and split() StringUtil had before the scanning kernels, kept
+// here as the baseline.
+void substr_trim(std::string &flag) {
+  std::string result;
+  for (size_t i(0); i < flag.size(); ++i) {
+    if (flag[i] == ' ') {
+      continue;
+    }
+    result = flag.substr(i);
+    break;
+  }
+  if (!result.empty()) {
+    size_t i(result.size() - 1);
+    while (true) {
+      if (result[i] != ' ') {
+        result = result.substr(0, i + 1);
+        break;
+      }
+      if (i == 0) {
+        break;
+      }
+      i--;
+    }
+  }
+  flag = result;
+}
+
+void stream_split(std::vector<std::string> &result, std::string const &input,
+                  char separator) {
+  auto has_data = [](std::stringstream &ss) -> bool {
+    ss.seekp(0, ss.end);
+    return ss.tellp() != 0;
+  };
+  result.clear();
+  std::stringstream ss;
+  for (char const &c : input) {
+    if (c == separator) {
+      if (has_data(ss)) {
+        result.push_back(ss.str());
+        ss.str("");
+      }
+      continue;
+    }
+    ss << c;
+  }
+  if (has_data(ss)) {
+    result.push_back(ss.str());
+  }
+}
+
+/**
+ * @brief An option name with padding spaces on both sides.
+ */
+std::string padded_name(std::size_t padding) {
+  return std::string(padding, ' ') + "-option-name" + std::string(padding, ' ');
+}
+
+/**
+ * @brief A list of item_count numbers separated by commas.
+ */
+std::string make_list(std::size_t item_count) {
+  std::string list;
+  for (std::size_t i(0); i < item_count; ++i) {
+    list += std::to_string(i) + ",";
+  }
+  return list;
+}
+
+/**
+ * @brief Measures find() of a byte at the end of a text of state.arg()
+ * bytes, per byte. Reports nothing if this CPU doesn't run level.
+ */
+void measure_find(cmdo::bench::State &state, cmdo::ScanLevel level) {
+  cmdo::ScanKernels const *kernels = cmdo::scan_kernels(level);
+  if (kernels == nullptr) {
+    return;
+  }
+  std::string const text = std::string(state.arg(), 'a') + "\n";
+  state.set_items_per_op(text.size());
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(kernels->find(text.data(), text.size(),
+                                               '\n'));
+  });
+}
+
+}
+
+// Trimming an option name, as the number of padding spaces on each side
+// grows.
+CMDO_BENCHMARK(Trim_Substr, 0, 16, 256) {
+  std::string const name = padded_name(state.arg());
+  std::string flag;
+  state.measure([&]() {
+    flag = name;
+    substr_trim(flag);
+    cmdo::bench::do_not_optimize(flag.data());
+  });
+}
+
+CMDO_BENCHMARK(Trim, 0, 16, 256) {
+  std::string const name = padded_name(state.arg());
+  std::string flag;
+  state.measure([&]() {
+    flag = name;
+    cmdo::trim(flag);
+    cmdo::bench::do_not_optimize(flag.data());
+  });
+}
+
+CMDO_BENCHMARK(Trim_View, 0, 16, 256) {
+  std::string const name = padded_name(state.arg());
+  state.measure([&]() {
+    cmdo::bench::do_not_optimize(cmdo::trim_view(name));
+  });
+}
+
+// Splitting a comma separated list. Items are list items.
+CMDO_BENCHMARK(Split_Stream, 10, 1000, 100000) {
+  std::string const list = make_list(state.arg());
+  std::vector<std::string> items;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    stream_split(items, list, ',');
+    cmdo::bench::do_not_optimize(items.data());
+  });
+}
+
+CMDO_BENCHMARK(Split, 10, 1000, 100000) {
+  std::string const list = make_list(state.arg());
+  std::vector<std::string> items;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    cmdo::split(items, list, ',');
+    cmdo::bench::do_not_optimize(items.data());
+  });
+}
+
+CMDO_BENCHMARK(Split_View, 10, 1000, 100000) {
+  std::string const list = make_list(state.arg());
+  std::vector<std::string_view> items;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    cmdo::split_view(items, list, ',');
+    cmdo::bench::do_not_optimize(items.data());
+  });
+}
+
+// Finding a byte with each kernel, as the text grows. Items are bytes.
+CMDO_BENCHMARK(Scan_Find_Scalar, 16, 256, 65536) {
+  measure_find(state, cmdo::ScanLevel::Scalar);
+}
+
+CMDO_BENCHMARK(Scan_Find_SSE2, 16, 256, 65536) {
+  measure_find(state, cmdo::ScanLevel::SSE2);
+}
+
+CMDO_BENCHMARK(Scan_Find_AVX2, 16, 256, 65536) {
+  measure_find(state, cmdo::ScanLevel::AVX2);
+}
@@ -0,0 +1,53 @@
+#include <cmdo/CmdLineOptions.h>
+#include <sstream>
+#include <string>
+#include "cmdo/Benchmark.h"
+
+namespace {
+
+void add_usage_options(cmdo::CmdLineOptions &options, std::size_t n) {
+  for (std::size_t i(0); i < n; ++i) {
+    std::string const description = "benchmark option number "
+                                    + std::to_string(i);
+    if (i % 2 == 0) {
+      options.add_switch("-switch" + std::to_string(i), description, false);
+    } else {
+      options.add_optional("-opt" + std::to_string(i), description, "0");
+    }
+  }
+}
+
+}
+
+// Cost of print_usage() as the number of options grows, half switches and
+// half arguments, once the help is rendered. Items are options.
+CMDO_BENCHMARK(Usage_Print, 10, 100, 1000) {
+  cmdo::CmdLineOptions options("Usage benchmark. Prints the help of a "
+                               "program with many options.");
+  add_usage_options(options, state.arg());
+  options.set_usage_width(80);
+
+  std::ostringstream out;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    out.str(std::string());
+    options.print_usage(out);
+    cmdo::bench::do_not_optimize(out.tellp());
+  });
+}
+
+// Same, but the help is rendered again every time, as after a parse().
+CMDO_BENCHMARK(Usage_Render, 10, 100, 1000) {
+  cmdo::CmdLineOptions options("Usage benchmark. Prints the help of a "
+                               "program with many options.");
+  add_usage_options(options, state.arg());
+
+  std::ostringstream out;
+  state.set_items_per_op(state.arg());
+  state.measure([&]() {
+    out.str(std::string());
+    options.set_usage_width(80);
+    options.print_usage(out);
+    cmdo::bench::do_not_optimize(out.tellp());
+  });
+}
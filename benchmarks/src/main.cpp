@@ -0,0 +1,51 @@
+#include <cmdo/CmdLineOptions.h>
+#include <cstdio>
+#include <iostream>
+#include "cmdo/Benchmark.h"
+
+int main(int argc, char **argv) {
+  cmdo::CmdLineOptions options("Runs the cmdo benchmarks.");
+  options.add_optional("-filter", "only run benchmarks whose name contains "
+      "this string", "");
+  options.add_optional("-format", "output format: table, json or csv",
+                       "table");
+  options.add_optional("-out", "file to write the results to, instead of "
+      "the standard output", "");
+  options.attach_validator("-format", [](std::string const &,
+                                         std::string const &value) {
+    return cmdo::bench::Reporter::is_format(value);
+  });
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  std::string const filter = options.get_option("-filter");
+  std::string const outPath = options.get_option("-out");
+
+  std::FILE *out = stdout;
+  if (!outPath.empty()) {
+    out = std::fopen(outPath.c_str(), "w");
+    if (out == nullptr) {
+      std::cerr << "* can't write to " << outPath << "\n";
+      return 1;
+    }
+  }
+
+  cmdo::bench::Reporter reporter(options.get_option("-format"), out);
+  reporter.begin();
+  for (cmdo::bench::Benchmark const &benchmark : cmdo::bench::registry()) {
+    if (benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    for (std::size_t arg : benchmark.args) {
+      cmdo::bench::State state(arg);
+      benchmark.function(state);
+      reporter.add(benchmark.name, state);
+    }
+  }
+  reporter.end();
+
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,232 @@
+#include "cmdo/CharScan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CMDO_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace cmdo {
+
+namespace {
+
+std::size_t const NPOS = std::string_view::npos;
+
+std::size_t find_scalar(char const *data, std::size_t size, char c) {
+  for (std::size_t i(0); i < size; ++i) {
+    if (data[i] == c) {
+      return i;
+    }
+  }
+  return NPOS;
+}
+
+std::size_t find_not_scalar(char const *data, std::size_t size, char c) {
+  for (std::size_t i(0); i < size; ++i) {
+    if (data[i] != c) {
+      return i;
+    }
+  }
+  return NPOS;
+}
+
+std::size_t rfind_not_scalar(char const *data, std::size_t size, char c) {
+  while (size > 0) {
+    --size;
+    if (data[size] != c) {
+      return size;
+    }
+  }
+  return NPOS;
+}
+
+#ifdef CMDO_SCAN_X86
+
+// The vector kernels compare a block at a time, and turn the comparison
+// into a bit mask with one bit per byte. What's left over is done by the
+// scalar kernels.
+
+__attribute__((target("sse2")))
+std::size_t find_sse2(char const *data, std::size_t size, char c) {
+  __m128i const needle = _mm_set1_epi8(c);
+  std::size_t i(0);
+  for (; i + 16 <= size; i += 16) {
+    __m128i const block = _mm_loadu_si128(
+        reinterpret_cast<__m128i const *>(data + i));
+    unsigned const mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+  }
+  std::size_t const found = find_scalar(data + i, size - i, c);
+  return found == NPOS ? NPOS : i + found;
+}
+
+__attribute__((target("sse2")))
+std::size_t find_not_sse2(char const *data, std::size_t size, char c) {
+  __m128i const needle = _mm_set1_epi8(c);
+  std::size_t i(0);
+  for (; i + 16 <= size; i += 16) {
+    __m128i const block = _mm_loadu_si128(
+        reinterpret_cast<__m128i const *>(data + i));
+    unsigned const mask = ~static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))) & 0xffffu;
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+  }
+  std::size_t const found = find_not_scalar(data + i, size - i, c);
+  return found == NPOS ? NPOS : i + found;
+}
+
+__attribute__((target("sse2")))
+std::size_t rfind_not_sse2(char const *data, std::size_t size, char c) {
+  __m128i const needle = _mm_set1_epi8(c);
+  std::size_t end = size;
+  for (; end >= 16; end -= 16) {
+    __m128i const block = _mm_loadu_si128(
+        reinterpret_cast<__m128i const *>(data + end - 16));
+    unsigned const mask = ~static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))) & 0xffffu;
+    if (mask != 0) {
+      return end - 16 + 31 - static_cast<std::size_t>(__builtin_clz(mask));
+    }
+  }
+  return rfind_not_scalar(data, end, c);
+}
+
+// The AVX2 kernels do their 16 byte step themselves, instead of calling the
+// SSE2 ones: going from AVX to legacy SSE code costs more than the scan.
+
+__attribute__((target("avx2")))
+std::size_t find_avx2(char const *data, std::size_t size, char c) {
+  std::size_t i(0);
+  if (size >= 32) {
+    __m256i const needle = _mm256_set1_epi8(c);
+    for (; i + 32 <= size; i += 32) {
+      __m256i const block = _mm256_loadu_si256(
+          reinterpret_cast<__m256i const *>(data + i));
+      unsigned const mask = static_cast<unsigned>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+      if (mask != 0) {
+        return i + static_cast<std::size_t>(__builtin_ctz(mask));
+      }
+    }
+  }
+  if (i + 16 <= size) {
+    __m128i const block = _mm_loadu_si128(
+        reinterpret_cast<__m128i const *>(data + i));
+    unsigned const mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    i += 16;
+  }
+  std::size_t const found = find_scalar(data + i, size - i, c);
+  return found == NPOS ? NPOS : i + found;
+}
+
+__attribute__((target("avx2")))
+std::size_t find_not_avx2(char const *data, std::size_t size, char c) {
+  std::size_t i(0);
+  if (size >= 32) {
+    __m256i const needle = _mm256_set1_epi8(c);
+    for (; i + 32 <= size; i += 32) {
+      __m256i const block = _mm256_loadu_si256(
+          reinterpret_cast<__m256i const *>(data + i));
+      unsigned const mask = ~static_cast<unsigned>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+      if (mask != 0) {
+        return i + static_cast<std::size_t>(__builtin_ctz(mask));
+      }
+    }
+  }
+  if (i + 16 <= size) {
+    __m128i const block = _mm_loadu_si128(
+        reinterpret_cast<__m128i const *>(data + i));
+    unsigned const mask = ~static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))))
+                          & 0xffffu;
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    i += 16;
+  }
+  std::size_t const found = find_not_scalar(data + i, size - i, c);
+  return found == NPOS ? NPOS : i + found;
+}
+
+__attribute__((target("avx2")))
+std::size_t rfind_not_avx2(char const *data, std::size_t size, char c) {
+  std::size_t end = size;
+  if (end >= 32) {
+    __m256i const needle = _mm256_set1_epi8(c);
+    for (; end >= 32; end -= 32) {
+      __m256i const block = _mm256_loadu_si256(
+          reinterpret_cast<__m256i const *>(data + end - 32));
+      unsigned const mask = ~static_cast<unsigned>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+      if (mask != 0) {
+        return end - 32 + 31 - static_cast<std::size_t>(__builtin_clz(mask));
+      }
+    }
+  }
+  if (end >= 16) {
+    __m128i const block = _mm_loadu_si128(
+        reinterpret_cast<__m128i const *>(data + end - 16));
+    unsigned const mask = ~static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))))
+                          & 0xffffu;
+    if (mask != 0) {
+      return end - 16 + 31 - static_cast<std::size_t>(__builtin_clz(mask));
+    }
+    end -= 16;
+  }
+  return rfind_not_scalar(data, end, c);
+}
+
+#endif
+
+ScanKernels const SCALAR_KERNELS{find_scalar, find_not_scalar,
+                                 rfind_not_scalar};
+#ifdef CMDO_SCAN_X86
+ScanKernels const SSE2_KERNELS{find_sse2, find_not_sse2, rfind_not_sse2};
+ScanKernels const AVX2_KERNELS{find_avx2, find_not_avx2, rfind_not_avx2};
+#endif
+
+}
+
+ScanKernels const *scan_kernels(ScanLevel level) {
+  switch (level) {
+    case ScanLevel::Scalar:
+      return &SCALAR_KERNELS;
+#ifdef CMDO_SCAN_X86
+    case ScanLevel::SSE2:
+      return __builtin_cpu_supports("sse2") ? &SSE2_KERNELS : nullptr;
+    case ScanLevel::AVX2:
+      return __builtin_cpu_supports("avx2") ? &AVX2_KERNELS : nullptr;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+ScanLevel best_scan_level() {
+  static ScanLevel const level = []() {
+    for (ScanLevel level : {ScanLevel::AVX2, ScanLevel::SSE2}) {
+      if (scan_kernels(level) != nullptr) {
+        return level;
+      }
+    }
+    return ScanLevel::Scalar;
+  }();
+  return level;
+}
+
+ScanKernels const &best_scan_kernels() {
+  static ScanKernels const &kernels = *scan_kernels(best_scan_level());
+  return kernels;
+}
+
+}
@@ -0,0 +1,100 @@
+#ifndef CMDO_CHARSCAN_H
+#define CMDO_CHARSCAN_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace cmdo {
+
+/**
+ * @brief Instruction sets the byte scanning kernels are built for.
+ */
+enum class ScanLevel {
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+/**
+ * @brief Kernels that scan size bytes at data for a byte. Each returns a
+ * position, or std::string_view::npos if there is none.
+ */
+struct ScanKernels {
+  // First byte equal to c.
+  std::size_t (*find)(char const *data, std::size_t size, char c);
+  // First byte not equal to c.
+  std::size_t (*find_not)(char const *data, std::size_t size, char c);
+  // Last byte not equal to c.
+  std::size_t (*rfind_not)(char const *data, std::size_t size, char c);
+};
+
+/**
+ * @brief The kernels of level, or null if this build or CPU doesn't have
+ * them. Scalar kernels are always there.
+ */
+ScanKernels const *scan_kernels(ScanLevel level);
+
+/**
+ * @brief Best level this CPU runs, detected once.
+ */
+ScanLevel best_scan_level();
+
+/**
+ * @brief Kernels of best_scan_level(), used by the functions below.
+ */
+ScanKernels const &best_scan_kernels();
+
+/**
+ * @brief Position of the first c in text at or after pos, or npos.
+ */
+inline std::size_t find_byte(std::string_view text, char c,
+                             std::size_t pos = 0) {
+  if (pos >= text.size()) {
+    return text.npos;
+  }
+  std::size_t const found = best_scan_kernels().find(text.data() + pos,
+                                                     text.size() - pos, c);
+  return found == text.npos ? found : pos + found;
+}
+
+/**
+ * @brief text without the spaces at both ends, as a view into text.
+ */
+inline std::string_view trim_view(std::string_view text) {
+  ScanKernels const &kernels = best_scan_kernels();
+  std::size_t const first = kernels.find_not(text.data(), text.size(), ' ');
+  if (first == text.npos) {
+    return text.substr(text.size());
+  }
+  std::size_t const last = kernels.rfind_not(text.data(), text.size(), ' ');
+  return text.substr(first, last - first + 1);
+}
+
+/**
+ * @brief Calls f with every non-empty line of text, without its "\n" or
+ * "\r\n", as views into text. Config files and response files both go
+ * through it, so they read line ends the same way.
+ */
+template<typename Function>
+void for_each_line(std::string_view text, Function f) {
+  ScanKernels const &kernels = best_scan_kernels();
+  char const *begin = text.data();
+  char const *const end = begin + text.size();
+  while (begin < end) {
+    std::size_t const size = static_cast<std::size_t>(end - begin);
+    std::size_t const found = kernels.find(begin, size, '\n');
+    char const *const eol = found == text.npos ? end : begin + found;
+    char const *last = eol;
+    if (last > begin && last[-1] == '\r') {
+      --last;
+    }
+    if (last > begin) {
+      f(std::string_view(begin, static_cast<std::size_t>(last - begin)));
+    }
+    begin = eol + 1;
+  }
+}
+
+}
+
+#endif //CMDO_CHARSCAN_H
@@ -1,9 +1,54 @@
 #include "cmdo/CmdLineOptions.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
 #include <iostream>
-#include <iomanip>
+#include <thread>
 
 namespace cmdo {
 
+namespace {
+
+/**
+ * @brief Times one parse() into stats, and counts it and the allocations
+ * made during it.
+ */
+class ParseScope {
+public:
+  ParseScope(ParseStats &stats,
+             CmdLineOptions::AllocationCounter const &counter)
+      : stats_(stats), counter_(counter), allocations_(0),
+        timer_(&stats, &ParseStats::parse_ns) {
+    if constexpr (STATS_ENABLED) {
+      ++stats_.parses;
+      if (counter_) {
+        allocations_ = counter_();
+      }
+    }
+  }
+
+  ParseScope(ParseScope const &) = delete;
+
+  ParseScope &operator=(ParseScope const &) = delete;
+
+  ~ParseScope() {
+    if constexpr (STATS_ENABLED) {
+      if (counter_) {
+        stats_.allocations += counter_() - allocations_;
+      }
+    }
+  }
+
+private:
+  ParseStats &stats_;
+  CmdLineOptions::AllocationCounter const &counter_;
+  std::uint64_t allocations_;
+  StatsTimer const timer_;
+};
+
+}
+
 std::string const CmdLineOptions::HELP_SWITCH_NAME{"-h"};
 
 CmdLineOptions::CmdLineOptions(std::string const &program_description)
@@ -12,8 +57,18 @@ CmdLineOptions::CmdLineOptions(std::string const &program_description)
 
 CmdLineOptions::CmdLineOptions(std::string const &program_description,
                                std::string const &additional_args)
-    : programDescription_(program_description), errorStream_(std::cerr),
-      stdStream_(std::cout), parserResultHandler_() {
+    : CmdLineOptions(program_description, additional_args,
+                     std::pmr::get_default_resource()) {
+}
+
+CmdLineOptions::CmdLineOptions(std::string const &program_description,
+                               std::string const &additional_args,
+                               std::pmr::memory_resource *resource)
+    : schema_(resource), commandLine_(resource), copyValues_(true),
+      programDescription_(program_description), errorStream_(std::cerr),
+      stdStream_(std::cout), parserResultHandler_(), suggestions_(false),
+      selected_(NO_SUBCOMMAND), usageWidth_(0), usageValid_(false),
+      usageVersion_(0), snapshot_(new_snapshot()) {
   add_switch(HELP_SWITCH_NAME, "Show program help.", false);
 
   // Default fail function.
@@ -26,267 +81,825 @@ CmdLineOptions::CmdLineOptions(std::string const &program_description,
     }
     for (std::string const &name : invalidOptions) {
       ErrorPrinter(errorStream_) << "invalid argument: "
-      << name << " = " << this->get_option(name);
+      << name << " = " << invalid_value(name);
     }
     for (std::string const &name : missingOptions) {
       ErrorPrinter(errorStream_) << "option is required: " << name;
     }
+    bool misspelled(false);
+    if (suggestions_) {
+      for (std::string const &arg : unknownInput) {
+        // Positional arguments, negative numbers included, are not typos.
+        if (arg.size() < 2 || arg[0] != '-'
+            || std::isdigit(static_cast<unsigned char>(arg[1]))) {
+          continue;
+        }
+        std::string const suggestion = schema_.suggest_option(arg);
+        if (!suggestion.empty()) {
+          ErrorPrinter(errorStream_) << "unknown option: " << arg
+          << ", did you mean " << suggestion << "?";
+          misspelled = true;
+        }
+      }
+    }
     if (!missingOptions.empty() || !invalidOptions.empty()
-        || !emptyOptions.empty()) {
+        || !emptyOptions.empty() || misspelled) {
       exit(EXIT_FAILURE);
     }
   };
+
+  fileErrorHandler_ = [this](StringList const &paths) {
+    for (std::string const &path : paths) {
+      ErrorPrinter(errorStream_) << "cannot read file: " << path;
+    }
+    exit(EXIT_FAILURE);
+  };
+}
+
+CmdLineOptions::~CmdLineOptions() {
+  stop_watching_config_file();
+}
+
+void CmdLineOptions::add_required(std::string const &name,
+                                  std::string const &description,
+                                  std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_required(name, description, env_variable);
+}
+
+void CmdLineOptions::add_optional(std::string const &name,
+                                  std::string const &description,
+                                  std::string const &default_value,
+                                  std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_optional(name, description, default_value, env_variable);
+}
+
+void CmdLineOptions::add_list(std::string const &name,
+                              std::string const &description, char delimiter,
+                              std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_list(name, description, delimiter, env_variable);
+}
+
+void CmdLineOptions::add_switch(std::string const &name,
+                                std::string const &description,
+                                bool default_setting,
+                                std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_switch(name, description, default_setting, env_variable);
+}
+
+void CmdLineOptions::attach_validator(std::string const &arg_name,
+                                      ValidatorFunction validator,
+                                      bool cacheable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.attach_validator(arg_name, std::move(validator), cacheable);
+}
+
+void CmdLineOptions::set_validator_cache(std::size_t capacity,
+                                         std::chrono::milliseconds ttl) {
+  schema_.set_validator_cache(capacity, ttl);
+}
+
+void CmdLineOptions::invalidate_validator_cache() const {
+  schema_.invalidate_validator_cache();
+}
+
+void CmdLineOptions::invalidate_validator_cache(
+    std::string const &opt_name) const {
+  schema_.invalidate_validator_cache(opt_name);
+}
+
+ValidatorCache::Stats CmdLineOptions::validator_cache_stats() const {
+  return schema_.validator_cache_stats();
+}
+
+void CmdLineOptions::set_validator_threads(unsigned threads,
+                                           std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> l(mutex_);
+  if (threads == 0) {
+    validatorPool_.reset();
+    return;
+  }
+  validatorPool_.reset(new ValidatorPool(threads, timeout));
+}
+
+void CmdLineOptions::set_abbreviations(bool enabled) {
+  std::unique_lock<std::mutex> l(mutex_);
+  schema_.set_abbreviations(enabled);
+}
+
+void CmdLineOptions::set_suggestions(bool enabled) {
+  std::unique_lock<std::mutex> l(mutex_);
+  suggestions_ = enabled;
+}
+
+std::string CmdLineOptions::suggest_option(std::string_view name) const {
+  return schema_.suggest_option(name);
+}
+
+void CmdLineOptions::add_subcommand(std::string const &name,
+                                    std::string const &description,
+                                    SubcommandFactory factory) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  if (!factory) {
+    throw BadFunction();
+  }
+  std::string niceName(name);
+  trim(niceName);
+  if (niceName.empty()) {
+    throw BadOption();
+  }
+  if (!subcommandIndex_.insert(niceName, OptionIndex::Kind::Arg,
+                               subcommands_.size())) {
+    throw OptionDefined();
+  }
+  subcommands_.push_back(Subcommand{niceName, description,
+                                    std::move(factory), nullptr});
+  invalidate_usage();
+}
+
+std::string CmdLineOptions::subcommand_name() const {
+  std::unique_lock<std::mutex> l(mutex_);
+  return selected_ == NO_SUBCOMMAND ? std::string()
+                                    : subcommands_[selected_].name;
+}
+
+CmdLineOptions &CmdLineOptions::subcommand() {
+  std::unique_lock<std::mutex> l(mutex_);
+  if (selected_ == NO_SUBCOMMAND) {
+    throw UndefinedOption();
+  }
+  return *subcommands_[selected_].options;
+}
+
+CmdLineOptions &CmdLineOptions::subcommand(std::string const &name) {
+  std::unique_lock<std::mutex> l(mutex_);
+  OptionIndex::Entry const entry = subcommandIndex_.find(name);
+  if (!entry.found()) {
+    throw UndefinedOption();
+  }
+  return build_subcommand(entry.position);
+}
+
+OptionSchema const &CmdLineOptions::schema() const {
+  return schema_;
 }
 
 void CmdLineOptions::parse(int argc, char **argv, StringList &left_overs) {
   std::unique_lock<std::mutex> l(mutex_);
+  ParseScope const scope(stats_, allocationCounter_);
+  left_overs.clear();
+
+  StringList listOfOptionsWithNoValue;
+  StringList listOfInvalidOptions;
+  clear_values();
+  copyValues_ = true;
+  int const command = collect_tokens(argc, argv);
+  auto const for_each_token = [this](auto const &f) {
+    for (std::string_view const token : tokens_) {
+      f(token);
+    }
+  };
+  schema_.parse_tokens(for_each_token, true, commandLine_, listOfOptionsWithNoValue,
+               [&left_overs](std::string_view arg) {
+                 left_overs.emplace_back(arg);
+               }, &stats_);
+  // Everything was copied, the files can go.
+  responseFiles_.reset();
+  finish_parse(left_overs, listOfOptionsWithNoValue, listOfInvalidOptions);
+
+  if (command < argc) {
+    StringList commandLeftOvers;
+    select_subcommand(argv[command]).parse(argc - command, argv + command,
+                                           commandLeftOvers);
+    left_overs.insert(left_overs.end(), commandLeftOvers.begin(),
+                      commandLeftOvers.end());
+  }
+}
+
+void CmdLineOptions::parse(int argc, char **argv, ViewList &left_overs) {
+  std::unique_lock<std::mutex> l(mutex_);
+  ParseScope const scope(stats_, allocationCounter_);
   left_overs.clear();
 
-  auto get_nice_program_name = [argv]() -> std::string {
-    std::string result = std::string(argv[0]);
-    // Remove everything but the command's name.
-    size_t const pos = result.find_last_of("/");
-    if (pos != result.npos) {
-      if (pos + 1 < result.size()) {
-        result = result.substr(pos);
+  StringList listOfOptionsWithNoValue;
+  StringList listOfInvalidOptions;
+  clear_values();
+  copyValues_ = false;
+  int const command = collect_tokens(argc, argv);
+  auto const for_each_token = [this](auto const &f) {
+    for (std::string_view const token : tokens_) {
+      f(token);
+    }
+  };
+  schema_.parse_tokens(for_each_token, false, commandLine_, listOfOptionsWithNoValue,
+               [&left_overs](std::string_view arg) {
+                 left_overs.push_back(arg);
+               }, &stats_);
+  finish_parse(StringList(), listOfOptionsWithNoValue, listOfInvalidOptions);
+
+  if (command < argc) {
+    ViewList commandLeftOvers;
+    select_subcommand(argv[command]).parse(argc - command, argv + command,
+                                           commandLeftOvers);
+    left_overs.insert(left_overs.end(), commandLeftOvers.begin(),
+                      commandLeftOvers.end());
+  }
+}
+
+void CmdLineOptions::parse(int argc, char **argv, PositionalSink sink) {
+  std::unique_lock<std::mutex> l(mutex_);
+  ParseScope const scope(stats_, allocationCounter_);
+  if (!sink) {
+    throw BadFunction();
+  }
+
+  StringList listOfOptionsWithNoValue;
+  StringList listOfInvalidOptions;
+  clear_values();
+  copyValues_ = true;
+  programName_ = OptionSchema::nice_program_name(argv[0]);
+  int command = argc;
+  // Response files are read line by line as the tokens are used, and
+  // unmapped right after, so nothing grows with the number of positionals.
+  auto for_each_token = [this, argc, argv, &command](auto const &f) {
+    bool valueNext(false);
+    for (int i(1); i < argc; ++i) {
+      if (!valueNext && is_subcommand(argv[i])) {
+        command = i;
+        return;
       }
+      schema_.expand_argument(argv[i], valueNext, f);
     }
-    return result;
   };
-  programName_ = get_nice_program_name();
+  schema_.parse_tokens(for_each_token, true, commandLine_, listOfOptionsWithNoValue,
+               sink, &stats_);
+  finish_parse(StringList(), listOfOptionsWithNoValue, listOfInvalidOptions);
+
+  if (command < argc) {
+    select_subcommand(argv[command]).parse(argc - command, argv + command,
+                                           sink);
+  }
+}
+
+void CmdLineOptions::parse(std::string_view command_line,
+                           StringList &left_overs) {
+  std::unique_lock<std::mutex> l(mutex_);
+  ParseScope const scope(stats_, allocationCounter_);
+  left_overs.clear();
 
   StringList listOfOptionsWithNoValue;
+  StringList listOfInvalidOptions;
+  clear_values();
+  copyValues_ = true;
+  auto const for_each_token = [this, command_line](auto const &f) {
+    bool programName = true;
+    bool valueNext(false);
+    shellTokenizer_.for_each_token(command_line, [&](std::string_view arg) {
+      if (programName) {
+        programName_ = OptionSchema::nice_program_name(arg);
+        programName = false;
+      } else {
+        schema_.expand_argument(arg, valueNext, f);
+      }
+    });
+  };
+  try {
+    schema_.parse_tokens(for_each_token, true, commandLine_, listOfOptionsWithNoValue,
+                 [&left_overs](std::string_view arg) {
+                   left_overs.emplace_back(arg);
+                 }, &stats_);
+  } catch (BadCommandLine const &) {
+    // Forget what was parsed before the error.
+    clear_values();
+    left_overs.clear();
+    throw;
+  }
+  finish_parse(left_overs, listOfOptionsWithNoValue, listOfInvalidOptions);
+}
+
+CmdLineOptions::BatchResultList CmdLineOptions::parse_batch(
+    std::vector<StringList> const &argvs, unsigned threads) {
+  // Read once for the whole batch; their problems go to every result.
+  StringList unreadableFiles;
+  StringList sharedInvalidOptions;
+  std::shared_ptr<ConfigValues const> config;
+  {
+    std::unique_lock<std::mutex> l(mutex_);
+    load_config(unreadableFiles);
+    config = config_;
+  }
+  add_bad_values(config.get(), sharedInvalidOptions);
+  std::shared_ptr<ConfigValues const> const env = schema_.load_environment();
+  add_bad_values(env.get(), sharedInvalidOptions);
+
+  BatchResultList results(argvs.size());
+  for (BatchResult &result : results) {
+    result.unreadable_files = unreadableFiles;
+    result.invalid_options = sharedInvalidOptions;
+  }
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = static_cast<unsigned>(
+      std::min<std::size_t>(threads, argvs.size()));
+
+  // Workers take the next vector as they finish one, so a few long ones
+  // don't leave the other threads idle.
+  std::atomic<std::size_t> next(0);
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto const work = [&]() {
+    ConfigValues commandLine;
+    try {
+      for (std::size_t i = next++; i < argvs.size(); i = next++) {
+        parse_batch_item(argvs[i], commandLine, env, config, results[i]);
+      }
+    } catch (...) {
+      std::unique_lock<std::mutex> errorLock(errorMutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      next = argvs.size();
+    }
+  };
+  std::vector<std::thread> workers;
+  for (unsigned t(1); t < threads; ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return results;
+}
+
+void CmdLineOptions::parse_batch_item(
+    StringList const &argv, ConfigValues &command_line,
+    std::shared_ptr<ConfigValues const> const &env,
+    std::shared_ptr<ConfigValues const> const &config,
+    BatchResult &result) const {
+  schema_.clear_command_line(command_line);
+  std::shared_ptr<Snapshot> snapshot = new_snapshot();
+  if (!argv.empty()) {
+    snapshot->programName_ = OptionSchema::nice_program_name(argv[0]);
+  }
+  auto const for_each_token = [this, &argv](auto const &f) {
+    bool valueNext(false);
+    for (std::size_t i(1); i < argv.size(); ++i) {
+      schema_.expand_argument(argv[i], valueNext, f);
+    }
+  };
+  schema_.parse_tokens(for_each_token, true, command_line,
+                       result.options_with_no_value,
+                       [&result](std::string_view arg) {
+                         result.left_overs.emplace_back(arg);
+                       }, nullptr);
+  schema_.merge_values(*snapshot, command_line, true, env.get(),
+                       config.get(), nullptr, result.missing_options,
+                       result.invalid_options, nullptr);
+  result.options = std::move(snapshot);
+}
+
+void CmdLineOptions::reset() {
+  std::unique_lock<std::mutex> l(mutex_);
+  clear_values();
+  StringList missingOptions;
+  StringList invalidOptions;
+  publish(build_snapshot(config_, missingOptions, invalidOptions));
+}
+
+void CmdLineOptions::clear_values() {
+  // Snapshots have their own copies.
+  schema_.clear_command_line(commandLine_);
+  responseFiles_.reset();
+  programName_.clear();
+  selected_ = NO_SUBCOMMAND;
+  invalidate_usage();
+}
+
+void CmdLineOptions::invalidate_usage() {
+  usageValid_ = false;
+}
+
+bool CmdLineOptions::is_subcommand(std::string_view arg) const {
+  return !subcommands_.empty() && subcommandIndex_.contains(arg)
+         && !schema_.find_option(arg).found();
+}
+
+CmdLineOptions &CmdLineOptions::select_subcommand(std::string_view name) {
+  selected_ = subcommandIndex_.find(name).position;
+  CmdLineOptions &options = build_subcommand(selected_);
+  options.usagePrefix_ = usagePrefix_ + programName_ + " ";
+  return options;
+}
 
+CmdLineOptions &CmdLineOptions::build_subcommand(std::size_t position) {
+  Subcommand &command = subcommands_[position];
+  if (!command.options) {
+    std::unique_ptr<CmdLineOptions> options(
+        new CmdLineOptions(command.description, "",
+                           schema_.memory_resource()));
+    command.factory(*options);
+    command.options = std::move(options);
+  }
+  return *command.options;
+}
+
+int CmdLineOptions::collect_tokens(int argc, char **argv) {
+  StatsTimer const timer(&stats_, &ParseStats::tokenize_ns);
+  programName_ = OptionSchema::nice_program_name(argv[0]);
+
+  tokens_.clear();
+  tokens_.reserve(static_cast<std::size_t>(argc));
+  // Whether tokens_[checked] is the value of an option. Only looked at when
+  // a response file or a subcommand name shows up, so other tokens are not
+  // looked up twice.
+  bool valueNext(false);
+  std::size_t checked(0);
+  auto const catch_up = [&]() {
+    for (; checked < tokens_.size(); ++checked) {
+      valueNext = schema_.next_is_value(tokens_[checked], valueNext);
+    }
+  };
   for (int i(1); i < argc; ++i) {
-    int const next = (i + 1) < argc ? i + 1 : -1;
-
-    std::string arg(argv[i]);
-    {
-      SwitchOptList::iterator it = find_switch(arg);
-      if (it != switchOptionList_.end()) {
-        it->set(!it->get_default());
-        continue;
+    std::string_view const arg(argv[i]);
+    if (is_subcommand(arg)) {
+      catch_up();
+      if (!valueNext) {
+        return i;
       }
     }
-    {
-      ArgOptList::iterator it = find_arg(arg);
-      if (it != argOptionList_.end()) {
-        if (next != -1) {
-          it->set(argv[next]);
-          ++i;
-          continue;
-        } else {
-          listOfOptionsWithNoValue.push_back(arg);
-          continue;
-        }
+    std::unique_ptr<ResponseFile> file;
+    if (schema_.is_response_file(arg)) {
+      catch_up();
+      if (!valueNext) {
+        file.reset(new ResponseFile(std::string(arg.substr(1))));
       }
     }
+    if (!file || !file->is_open()) {
+      tokens_.push_back(arg);
+      continue;
+    }
 
-    // not an option :/
-    left_overs.push_back(arg);
+    file->tokenize(tokens_);
+    if (!responseFiles_) {
+      responseFiles_ = std::make_shared<ResponseFileList>();
+    }
+    responseFiles_->push_back(std::move(file));
   }
+  return argc;
+}
 
+void CmdLineOptions::finish_parse(StringList const &left_overs,
+                                  StringList const &options_with_no_value,
+                                  StringList &invalid_options) {
   // check for the help switch.
-  if (get_switch(HELP_SWITCH_NAME)) {
-    print_usage(stdStream_);
+  if (commandLine_.switches[schema_.index_.find(HELP_SWITCH_NAME).position] == 1) {
+    print_usage_locked(stdStream_);
     exit(EXIT_SUCCESS);
   }
 
   StringList listOfMissingRequiredOptions;
-  StringList listOfInvalidOptions;
-  for (StringOption const &option : argOptionList_) {
-    if (!option.is_set() && option.is_required()) {
-      listOfMissingRequiredOptions.push_back(option.name());
-    } else {
-      // Validate the argument
-      ValidatorFunctionMap::const_iterator it = validatorFunctionMap_.find(
-          option.name());
-      if (it != validatorFunctionMap_.end()) {
-        ValidatorFunctionList const &list(it->second);
-        for (ValidatorFunction const &validator : list) {
-          if (!validator(option.name(), option.get())) {
-            listOfInvalidOptions.push_back(option.name());
-          }
-        }
-      }
-    }
+  StringList unreadableFiles;
+  std::shared_ptr<Snapshot> snapshot;
+  {
+    StatsTimer const timer(&stats_, &ParseStats::merge_ns);
+    load_config(unreadableFiles);
+    add_bad_values(config_.get(), invalid_options);
+    env_ = schema_.load_environment(std::move(env_));
+    add_bad_values(env_.get(), invalid_options);
+    snapshot = build_snapshot(config_, listOfMissingRequiredOptions,
+                              invalid_options);
   }
+  publish(snapshot);
 
+  StatsTimer const timer(&stats_, &ParseStats::handler_ns);
+  if (!unreadableFiles.empty()) {
+    fileErrorHandler_(unreadableFiles);
+  }
   parserResultHandler_(left_overs, listOfMissingRequiredOptions,
-                       listOfOptionsWithNoValue, listOfInvalidOptions);
+                       options_with_no_value, invalid_options);
 }
 
-void CmdLineOptions::add_required(std::string const &name,
-                                  std::string const &description) {
-  std::unique_lock<std::mutex> l(mutex_);
+void CmdLineOptions::load_config(StringList &unreadable_files) {
+  if (config_ || configPath_.empty()) {
+    return;
+  }
+  config_ = schema_.load_config_file(configPath_);
+  if (!config_) {
+    unreadable_files.push_back(configPath_);
+  }
+}
 
-  if (is_arg(name) || is_switch(name)) {
-    throw OptionDefined();
+void CmdLineOptions::add_bad_values(ConfigValues const *values,
+                                    StringList &invalid_options) {
+  if (values == nullptr) {
+    return;
   }
-  std::string niceName(name);
-  trim(niceName);
+  for (auto const &bad : values->badValues) {
+    invalid_options.emplace_back(bad.first);
+  }
+}
 
-  StringOption option(niceName, description, "");
-  option.set_required(true);
-  argOptionList_.push_back(option);
+std::string CmdLineOptions::invalid_value(std::string const &name) const {
+  // Values that could not be read are not in the snapshot.
+  for (ConfigValues const *values : {env_.get(), config_.get()}) {
+    if (values == nullptr) {
+      continue;
+    }
+    for (auto const &bad : values->badValues) {
+      if (bad.first == name) {
+        return std::string(bad.second);
+      }
+    }
+  }
+  if (schema_.is_arg(name)) {
+    return get_option(name);
+  }
+  return std::string();
 }
 
-void CmdLineOptions::add_optional(std::string const &name,
-                                  std::string const &description,
-                                  std::string const &default_value) {
-  std::unique_lock<std::mutex> l(mutex_);
-  if (is_arg(name) || is_switch(name)) {
-    throw OptionDefined();
+std::shared_ptr<CmdLineOptions::Snapshot> CmdLineOptions::build_snapshot(
+    std::shared_ptr<ConfigValues const> const &config,
+    StringList &missing_options, StringList &invalid_options) {
+  std::shared_ptr<Snapshot> result;
+  if (spareSnapshot_) {
+    result = std::move(spareSnapshot_);
+    result->clear();
+  } else {
+    result = new_snapshot();
   }
-  std::string niceName(name);
-  trim(niceName);
-  argOptionList_.push_back(StringOption(niceName, description, default_value));
+  result->programName_ = programName_;
+  result->responseFiles_ = responseFiles_;
+  schema_.merge_values(*result, commandLine_, copyValues_, env_.get(),
+                       config.get(), validatorPool_.get(), missing_options,
+                       invalid_options, &stats_);
+  return result;
 }
 
-void CmdLineOptions::add_switch(std::string const &name,
-                                std::string const &description,
-                                bool default_setting) {
-  std::unique_lock<std::mutex> l(mutex_);
-  if (is_arg(name) || is_switch(name)) {
-    throw OptionDefined();
+std::shared_ptr<CmdLineOptions::Snapshot> CmdLineOptions::new_snapshot() const {
+  return OptionSchema::allocate_shared<Snapshot>(schema_.memory_resource(),
+                                                 schema_,
+                                                 schema_.memory_resource());
+}
+
+void CmdLineOptions::publish(SnapshotPtr const &snapshot) {
+  SnapshotPtr previous = snapshot_.exchange(snapshot);
+  notify_changes(*previous, *snapshot);
+
+  // Readers can't get the previous snapshot anymore, so if we hold the only
+  // reference nobody else ever will.
+  if (OptionSchema::only_owner(previous)) {
+    spareSnapshot_ = std::const_pointer_cast<Snapshot>(std::move(previous));
   }
-  std::string niceName(name);
-  trim(niceName);
+}
+
+void CmdLineOptions::notify_changes(Snapshot const &previous,
+                                    Snapshot const &snapshot) const {
+  if (changeHandlers_.empty()) {
+    return;
+  }
+
+  StringList changed;
+  for (std::size_t i(0); i < schema_.arg_count(); ++i) {
+    bool const wasSet = previous.is_set_at(i);
+    bool const isSet = snapshot.is_set_at(i);
+    if (wasSet != isSet || (isSet && previous.value_at(i)
+                                     != snapshot.value_at(i))
+        || (schema_.list_format(i).isList
+            && !previous.same_items_at(i, snapshot))) {
+      changed.emplace_back(schema_.arg_option(i).name());
+    }
+  }
+  for (std::size_t i(0); i < schema_.switch_count(); ++i) {
+    if (previous.switch_at(i) != snapshot.switch_at(i)) {
+      changed.emplace_back(schema_.switch_option(i).name());
+    }
+  }
+  if (changed.empty()) {
+    return;
+  }
+  for (ChangeHandler const &handler : changeHandlers_) {
+    handler(changed);
+  }
+}
 
-  switchOptionList_.push_back(
-      BoolOption(niceName, description, default_setting));
+bool CmdLineOptions::save_schema(std::string const &path) const {
+  return schema_.save(path);
 }
 
-void CmdLineOptions::attach_validator(std::string const &arg_name,
-                                      CmdLineOptions::ValidatorFunction validator) {
+bool CmdLineOptions::load_schema(std::string const &path) {
   std::unique_lock<std::mutex> l(mutex_);
-  if (!is_arg(arg_name)) {
-    throw UndefinedOption();
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  if (!schema_.load(path)) {
+    return false;
   }
-  if (!validator) {
-    throw BadFunction();
+  if (!schema_.is_switch(HELP_SWITCH_NAME)) {
+    schema_.add_switch(HELP_SWITCH_NAME, "Show program help.", false);
   }
+  // Values are stored by option position, which the new options reuse.
+  // Emptied rather than cleared, which would size them for every option:
+  // the next parse() does.
+  commandLine_.strings.clear();
+  commandLine_.argValues.clear();
+  commandLine_.argIsSet.clear();
+  commandLine_.switches.clear();
+  commandLine_.listItems.clear();
+  responseFiles_.reset();
+  programName_.clear();
+  selected_ = NO_SUBCOMMAND;
+  invalidate_usage();
+  env_.reset();
+  config_.reset();
+  spareSnapshot_.reset();
+  snapshot_.exchange(new_snapshot());
+  return true;
+}
 
-  ValidatorFunctionMap::iterator it = validatorFunctionMap_.find(arg_name);
-  if (it != validatorFunctionMap_.end()) {
-    it->second.push_back(validator);
-  } else {
-    ValidatorFunctionList list{validator};
-    std::pair<std::string, ValidatorFunctionList> validatorList
-        = std::make_pair(arg_name, list);
-    validatorFunctionMap_.insert(validatorList);
-  }
+void CmdLineOptions::set_config_file(std::string const &path) {
+  std::unique_lock<std::mutex> l(mutex_);
+  configPath_ = path;
+  config_.reset();
 }
 
-std::string CmdLineOptions::get_option(std::string const &name) const {
-  ArgOptList::const_iterator it = find_arg(name);
-  if (it != argOptionList_.end()) {
-    return it->get();
+bool CmdLineOptions::reload_config_file(std::string const &path,
+                                        StringList &problems) {
+  std::unique_lock<std::mutex> l(mutex_);
+  problems.clear();
+
+  std::shared_ptr<ConfigValues const> config = schema_.load_config_file(path);
+  if (!config) {
+    problems.push_back(path);
+    return false;
+  }
+  add_bad_values(config.get(), problems);
+  if (!problems.empty()) {
+    return false;
+  }
+  StringList missingOptions;
+  std::shared_ptr<Snapshot> snapshot = build_snapshot(config,
+                                                      missingOptions,
+                                                      problems);
+  problems.insert(problems.end(), missingOptions.begin(),
+                  missingOptions.end());
+  if (!problems.empty()) {
+    spareSnapshot_ = std::move(snapshot);
+    return false;
   }
-  throw UndefinedOption();
+
+  config_ = config;
+  publish(snapshot);
+  return true;
 }
 
-bool CmdLineOptions::get_switch(std::string const &switch_name) const {
-  SwitchOptList::const_iterator found = find_switch(switch_name);
-  if (found != switchOptionList_.end()) {
-    return found->get();
-  }
-  return false;
-}
-
-template<typename T>
-void printOptionList(std::ostream &out, std::vector<T> const &option_list,
-                     bool const &is_switch = false) {
-  for (T const &option: option_list) {
-    std::stringstream desc;
-    desc << option.description();
-    if (!option.is_required()) {
-      desc << " (def = " << to_string(option.get_default());
-      if (option.is_set()) {
-        desc << ", curr = " << option.get();
-      }
-      desc << ")";
-    } else {
-      desc << "(required";
+bool CmdLineOptions::watch_config_file(std::string const &path,
+                                       StringList &problems) {
+  stop_watching_config_file();
+  bool const loaded = reload_config_file(path, problems);
 
-      if (option.is_set()) {
-        desc << ", curr = " << option.get();
-      }
-      desc << ")";
-    }
+  std::unique_ptr<FileWatcher> watcher(new FileWatcher(path, [this, path]() {
+    StringList ignored;
+    reload_config_file(path, ignored);
+  }));
+  std::unique_lock<std::mutex> l(mutex_);
+  configWatcher_ = std::move(watcher);
+  return loaded;
+}
 
-    std::string const name = is_switch ? option.name() : option.name() +
-                                                         " [...]";
-    out << " "
-    << std::setfill(' ')
-    << std::setw(2)
-    << std::setfill(' ')
-    << std::setw(20) << std::left
-    << name
-    << std::setfill(' ')
-    << std::setw(40) << std::left
-    << desc.str();
-    out << "\n";
+void CmdLineOptions::stop_watching_config_file() {
+  std::unique_ptr<FileWatcher> watcher;
+  {
+    std::unique_lock<std::mutex> l(mutex_);
+    watcher = std::move(configWatcher_);
   }
+  // Joins the watching thread, which may be waiting for mutex_.
+  watcher.reset();
 }
 
-void CmdLineOptions::print_usage(std::ostream &out) const {
-  out << "Usage: " << programName_ << " [options]" << "\n";
-  if (!programDescription_.empty()) {
-    out << "Description: \n"
-    << " " << programDescription_ <<
-    "\n\n";
+void CmdLineOptions::add_change_handler(ChangeHandler handler) {
+  std::unique_lock<std::mutex> l(mutex_);
+  if (!handler) {
+    throw BadFunction();
   }
+  changeHandlers_.push_back(handler);
+}
 
-  out << "Available options:\n";
-  printOptionList(std::cout, switchOptionList_, true);
+CmdLineOptions::SnapshotPtr CmdLineOptions::snapshot() const {
+  return snapshot_.load();
+}
 
-  printOptionList(std::cout, argOptionList_);
+std::string CmdLineOptions::get_option(std::string const &name) const {
+  return SnapshotReader(snapshot_)->get_option(name);
+}
 
-  out << "\n";
+std::string_view CmdLineOptions::get_option_view(std::string_view name) const {
+  return SnapshotReader(snapshot_)->get_option_view(name);
 }
 
-bool CmdLineOptions::is_switch(std::string const &name) const {
-  SwitchOptList::const_iterator it = find_switch(name);
-  return it != switchOptionList_.end();
+std::vector<std::string> CmdLineOptions::get_list(
+    std::string const &name) const {
+  return SnapshotReader(snapshot_)->get_list(name);
 }
 
-bool CmdLineOptions::is_arg(std::string const &name) const {
-  ArgOptList::const_iterator it = find_arg(name);
-  return it != argOptionList_.end();
+bool CmdLineOptions::get_switch(std::string const &switch_name) const {
+  return SnapshotReader(snapshot_)->get_switch(switch_name);
 }
 
-CmdLineOptions::ArgOptList::const_iterator CmdLineOptions::find_arg(
-    std::string const &name) const {
-  return std::find_if(argOptionList_.begin(), argOptionList_.end(),
-                      [name](StringOption const &option) {
-                        return name == option.name();
-                      });
+void CmdLineOptions::set_usage_width(std::size_t columns) {
+  std::unique_lock<std::mutex> l(mutex_);
+  usageWidth_ = columns;
+  invalidate_usage();
 }
 
-CmdLineOptions::ArgOptList::iterator CmdLineOptions::find_arg(
-    std::string const &name) {
-  return std::find_if(argOptionList_.begin(),
-                      argOptionList_.end(),
-                      [name](StringOption const &option) {
-                        return name == option.name();
-                      });
+void CmdLineOptions::print_usage(std::ostream &out) const {
+  std::unique_lock<std::mutex> l(mutex_);
+  print_usage_locked(out);
 }
 
-CmdLineOptions::SwitchOptList::const_iterator CmdLineOptions::find_switch(
-    std::string const &name) const {
-  return std::find_if(switchOptionList_.begin(), switchOptionList_.end(),
-                      [name](BoolOption const &option) {
-                        return name == option.name();
-                      });
+void CmdLineOptions::print_usage_locked(std::ostream &out) const {
+  if (!usageValid_ || usageVersion_ != schema_.version_) {
+    usage_.clear();
+    render_usage(usage_);
+    usageValid_ = true;
+    usageVersion_ = schema_.version_;
+  }
+  out.write(usage_.data(), static_cast<std::streamsize>(usage_.size()));
+}
+
+ParseStats CmdLineOptions::stats() {
+  std::unique_lock<std::mutex> l(mutex_);
+  ParseStats stats(stats_);
+  stats.schema_bytes = schema_.retained_bytes();
+  stats.mapped_bytes = schema_.mapped_bytes();
+  stats.value_bytes = OptionSchema::retained_bytes(commandLine_)
+                      + tokens_.capacity() * sizeof(std::string_view);
+  for (ConfigValues const *values : {env_.get(), config_.get()}) {
+    if (values != nullptr) {
+      stats.value_bytes += OptionSchema::retained_bytes(*values);
+    }
+  }
+  stats.value_bytes += SnapshotReader(snapshot_)->retained_bytes();
+  if (spareSnapshot_) {
+    stats.value_bytes += spareSnapshot_->retained_bytes();
+  }
+  return stats;
+}
+
+void CmdLineOptions::print_stats(std::ostream &out) {
+  stats().print(out);
 }
 
-CmdLineOptions::SwitchOptList::iterator CmdLineOptions::find_switch(
-    std::string const &name) {
-  return std::find_if(switchOptionList_.begin(), switchOptionList_.end(),
-                      [name](BoolOption const &option) {
-                        return name == option.name();
-                      });
+void CmdLineOptions::reset_stats() {
+  std::unique_lock<std::mutex> l(mutex_);
+  stats_ = ParseStats();
+}
+
+void CmdLineOptions::set_allocation_counter(AllocationCounter counter) {
+  std::unique_lock<std::mutex> l(mutex_);
+  allocationCounter_ = std::move(counter);
+}
+
+void CmdLineOptions::render_usage(std::string &out) const {
+  UsageFormatter usage(usageWidth_);
+  usage.set_program(usagePrefix_ + programName_,
+                    subcommands_.empty() ? "" : " <command> [command options]",
+                    programDescription_);
+
+  ConfigValues const &commandLine = commandLine_;
+  for (std::size_t i(0); i < schema_.switch_count(); ++i) {
+    OptionSchema::BoolOption const option = schema_.switch_option(i);
+    bool const isSet = i < commandLine.switches.size()
+                       && commandLine.switches[i] != -1;
+    usage.add_option(option.name(), true, option.description(),
+                     option.is_required(), to_string(option.get_default()),
+                     isSet,
+                     isSet && commandLine.switches[i] == 1 ? "1" : "0");
+  }
+  for (std::size_t i(0); i < schema_.arg_count(); ++i) {
+    OptionSchema::StringOption const option = schema_.arg_option(i);
+    bool const isSet = i < commandLine.argIsSet.size()
+                       && commandLine.argIsSet[i];
+    usage.add_option(option.name(), false, option.description(),
+                     option.is_required(), option.get_default(), isSet,
+                     isSet ? commandLine.argValues[i] : std::string_view());
+  }
+
+  for (Subcommand const &command : subcommands_) {
+    usage.add_command(command.name, command.description);
+  }
+  usage.render(out);
 }
 
 CmdLineOptions::ErrorPrinter::ErrorPrinter(std::ostream &out)
@@ -307,6 +920,14 @@ void CmdLineOptions::set_parser_result_handler(
   throw BadFunction();
 }
 
+void CmdLineOptions::set_file_error_handler(FileErrorHandler handler) {
+  if (handler) {
+    fileErrorHandler_ = handler;
+    return;
+  }
+  throw BadFunction();
+}
+
 std::string CmdLineOptions::program_name() const {
   return programName_;
 }
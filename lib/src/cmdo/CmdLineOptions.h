@@ -1,38 +1,40 @@
 #ifndef CMDO_CMDLINEOPTIONS_H
 #define CMDO_CMDLINEOPTIONS_H
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <functional>
-#include <map>
 #include <vector>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <type_traits>
+#include "cmdo/FileWatcher.h"
+#include "cmdo/OptionSchema.h"
+#include "cmdo/ParseResult.h"
+#include "cmdo/ParseStats.h"
+#include "cmdo/PublishedPtr.h"
+#include "cmdo/ShellTokenizer.h"
 #include "cmdo/StringUtil.h"
+#include "cmdo/UsageFormatter.h"
+#include "cmdo/ValidatorPool.h"
 
 namespace cmdo {
 
-struct BadFunction : public std::exception {
-
-};
-
-struct OptionNotSet : public std::exception {
-
-};
-
-struct UndefinedOption : public std::exception {
-
-};
-
-struct OptionDefined : public std::exception {
-
-};
-
-struct BadOption : public std::exception {
-
-};
-
 /**
  * @brief Allows parsing of command line options, and access to any argument
  * values.
+ *
+ * The options are defined in an OptionSchema, and values are published as
+ * ParseResult snapshots; this class adds the mutex, the handlers, the
+ * environment and config files on top of the two.
+ *
+ * Values can be read from any thread while others parse or reload them.
+ * Defining options (add_*(), load_schema()) is not synchronized with those
+ * reads, which look the options up: define every option before values are
+ * read from other threads.
  */
 class CmdLineOptions {
 public:
@@ -41,9 +43,14 @@ public:
    * Returns recevies the argument value as std::string, returns true if the
    * value passes the validation test, false if it doesn't.
    */
-  typedef std::function<bool(std::string const &, std::string const &)>
-      ValidatorFunction;
-  typedef std::vector<std::string> StringList;
+  typedef OptionSchema::ValidatorFunction ValidatorFunction;
+  typedef OptionSchema::StringList StringList;
+  typedef std::vector<std::string_view> ViewList;
+  /**
+   * @brief Receives the positional arguments of parse(), one at a time. The
+   * view is only valid during the call.
+   */
+  typedef std::function<void(std::string_view)> PositionalSink;
   /**
    * @brief Function signature for user-defined handlers when errors are
    * found when parsing the command line arguments.
@@ -56,6 +63,60 @@ public:
   typedef std::function<void(StringList const &, StringList const &,
                              StringList const &, StringList const &)>
       ParserResultHandler;
+  /**
+   * @brief Function signature for user-defined handlers of the files parse()
+   * can't read: the config file set with set_config_file(). Receives their
+   * paths. Called before the ParserResultHandler, and only if a file can't
+   * be read.
+   */
+  typedef std::function<void(StringList const &)> FileErrorHandler;
+  /**
+   * @brief Function signature for user-defined handlers called when the
+   * values of options change, after parse() or after a config file is
+   * reloaded. Receives the names of the options whose value changed.
+   */
+  typedef std::function<void(StringList const &)> ChangeHandler;
+  /**
+   * @brief Defines the options of a subcommand, on the CmdLineOptions it
+   * receives. Called the first time the subcommand is used.
+   * @see add_subcommand
+   */
+  typedef std::function<void(CmdLineOptions &)> SubcommandFactory;
+  /**
+   * @brief Returns the number of allocations made so far, for instance by
+   * a counting allocator of the program.
+   * @see set_allocation_counter
+   */
+  typedef std::function<std::uint64_t()> AllocationCounter;
+
+  /**
+   * @brief Values of all options at one point in time. Published snapshots
+   * never change, so they can be read from any thread without locking. A
+   * snapshot can only be used while the CmdLineOptions that created it
+   * exists.
+   */
+  typedef ParseResult Snapshot;
+  /**
+   * @brief Immutable values of all options at one point in time.
+   * @see snapshot
+   */
+  typedef std::shared_ptr<Snapshot const> SnapshotPtr;
+
+  /**
+   * @brief What parse_batch() found in one argument vector: the values, and
+   * the lists given to the ParserResultHandler by parse().
+   */
+  struct BatchResult {
+    SnapshotPtr options;
+    // Given to the FileErrorHandler by parse().
+    StringList unreadable_files;
+    StringList left_overs;
+    StringList missing_options;
+    StringList options_with_no_value;
+    StringList invalid_options;
+  };
+
+  typedef std::vector<BatchResult> BatchResultList;
 
   /**
    * @brief Initialize with program description. This description is shown
@@ -67,6 +128,23 @@ public:
   CmdLineOptions(std::string const &program_description,
                  std::string const &additional_args);
 
+  /**
+   * @brief Allocates the options, the values set by parse() and the
+   * snapshots from resource, for instance a std::pmr::monotonic_buffer_resource
+   * that frees them all at once. parse() reuses the memory of the previous
+   * values, those read from the environment included, so parsing again
+   * allocates nothing once the memory is there.
+   * Validators and handlers use the default allocator.
+   * @param[in] resource Must outlive this object and its snapshots, and be
+   * thread safe if other threads release snapshots, or if parse_batch() runs
+   * on more than one thread (see std::pmr::synchronized_pool_resource).
+   */
+  CmdLineOptions(std::string const &program_description,
+                 std::string const &additional_args,
+                 std::pmr::memory_resource *resource);
+
+  ~CmdLineOptions();
+
   /**
    * @brief Returns the name of the program. The name of the program is
    * collected after calling parse(), until then this returns an empty string.
@@ -86,9 +164,103 @@ public:
    * @param[out] left_overs Things in the command line that were not defined
    * as options in CmdLineOptions. Strings will be added here in the same order
    * they appear in the command line.
+   *
+   * An argument "@path" that is not an option, or the value of one, is
+   * replaced by the lines of the file at path (see ResponseFile), so that
+   * command lines too long for the system can be given. Like with GCC, an
+   * argument naming a file that can't be read is kept as is, so it ends up
+   * in left_overs.
+   *
+   * Options bound to environment variables (see add_required()) are read in
+   * one scan of the environment. Their values take precedence over config
+   * files and defaults, but not over the command line, and are checked by
+   * validators like any other value. A switch variable that is not
+   * true/yes/false/no is reported as an invalid option.
    */
   void parse(int argc, char **argv, StringList& left_overs);
 
+  /**
+   * @brief Like parse(), but nothing is copied: option values and left_overs
+   * are views into argv, which must outlive every read of the values (the
+   * argv given to main() always does).
+   *
+   * left_overs are not copied into the list of unknown options given to the
+   * ParserResultHandler, which receives an empty list instead. Values read
+   * from @files are views into the mapped files, which are kept until the
+   * next parse(), and as long as the snapshots that use them.
+   * @param[in] argc Number of command line argments
+   * @param[in] argv Command line arguments
+   * @param[out] left_overs Things in the command line that were not defined
+   * as options, in the same order they appear in the command line.
+   */
+  void parse(int argc, char **argv, ViewList& left_overs);
+
+  /**
+   * @brief Like parse(), but left_overs are given to sink as soon as they
+   * are found, so work on them can start while parsing goes on and nothing
+   * is kept in memory. @file response files are read line by line and
+   * unmapped once read. Option values are copied, and are available once
+   * parse() returns; the ParserResultHandler is called as usual, with an
+   * empty list of unknown options.
+   *
+   * sink must not call parse() or reload_config_file(). An output iterator
+   * can be wrapped as [&it](std::string_view arg) { *it++ = arg; }.
+   * @throws BadFunction
+   *   If sink is not a valid function.
+   * @param[in] argc Number of command line argments
+   * @param[in] argv Command line arguments
+   * @param[in] sink Called with every left over, in the same order they
+   * appear in the command line.
+   */
+  void parse(int argc, char **argv, PositionalSink sink);
+
+  /**
+   * @brief Like parse(), but the arguments are read from a single string,
+   * such as a line typed in a console or read from a job file. The string
+   * is split like a POSIX shell would (see ShellTokenizer), and its first
+   * argument is taken as the program name. Arguments are given to the
+   * parser as they are found, without building an argv. Option values and
+   * left_overs are copied.
+   * @throws BadCommandLine
+   *   If a quote is not closed or command_line ends with a backslash. No
+   *   value is changed.
+   * @param[in] command_line The program name followed by its arguments.
+   * @param[out] left_overs Things in the command line that were not defined
+   * as options, in the same order they appear in the command line.
+   */
+  void parse(std::string_view command_line, StringList &left_overs);
+
+  /**
+   * @brief Parses many argument vectors, each one with the program name
+   * first like argv, on a pool of threads. Every vector is parsed like
+   * parse() would (@files are expanded, and the environment and config file
+   * apply to all of them), but the results are returned instead of being
+   * published: the values of this object, the ParserResultHandler and the
+   * change handlers are left alone, and -h doesn't print the usage.
+   *
+   * Validators are called concurrently from the threads of the pool, so
+   * they must be safe to call from several threads at once. The config file
+   * is read under the lock of this object, which is then released: other
+   * threads can parse() while the batch runs, but not define options.
+   * @param[in] argvs The argument vectors.
+   * @param[in] threads Number of threads to use, including the calling one.
+   * 0 uses one per core.
+   * @returns One result per argument vector, in the same order.
+   */
+  BatchResultList parse_batch(std::vector<StringList> const &argvs,
+                              unsigned threads = 0);
+
+  /**
+   * @brief Forgets the values set by the last parse(): every option goes
+   * back to its default (or to its value in the environment or the config
+   * file). The options, validators and handlers stay defined.
+   *
+   * parse() starts from the same clean state, so it can be called again for
+   * every new argv. Memory used by a parse is kept and reused by the next
+   * one.
+   */
+  void reset();
+
   /**
    * @brief Defines a required argument. If the argument is not present in
    * the command line, the name will be added to the list of missing required
@@ -97,10 +269,13 @@ public:
    * @param[in] name Name of the argument. You should add any option prefixes
    * here. For instance: -my_option, -my-option, etc. No spaces.
    * @param[in] description Description of the option.
+   * @param[in] env_variable Optional. Name of an environment variable that
+   * sets the argument when it is not in the command line.
    * @throws OptionDefined
-   *   If the option is already been defined.
+   *   If the option, or the environment variable, is already been defined.
    */
-  void add_required(std::string const &name, std::string const &description);
+  void add_required(std::string const &name, std::string const &description,
+                    std::string const &env_variable = std::string());
 
   /**
    * @brief Defines an optional argument. If the argument is not present in
@@ -110,11 +285,71 @@ public:
    * @param[in] description Description of the option.
    * @param[in] default_value Default value for the argument in case that its
    * not present in the command line.
+   * @param[in] env_variable Optional. Name of an environment variable that
+   * sets the argument when it is not in the command line.
+   * @throws OptionDefined
+   *   If the option, or the environment variable, is already been defined.
+   */
+  void add_optional(std::string const &name, std::string const &description,
+                    std::string const &default_value,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Defines a required argument of type T. The value is converted
+   * once in parse(); a value that cannot be converted is reported as an
+   * invalid option to the ParserResultHandler. get_option_as<T>() then
+   * returns the converted value without parsing it again.
    * @throws OptionDefined
    *   If the option is already been defined.
    */
+  template<typename T>
+  void add_required(std::string const &name, std::string const &description,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Defines an optional argument of type T. See add_required<T>().
+   * @throws OptionDefined
+   *   If the option is already been defined.
+   */
+  template<typename T, typename = typename std::enable_if<
+      !std::is_convertible<T, std::string>::value>::type>
   void add_optional(std::string const &name, std::string const &description,
-                    std::string const &default_value);
+                    T const &default_value,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Defines an argument that collects every value it is given,
+   * instead of keeping the last one: "-I a -I b" gives the list a, b. With a
+   * delimiter, each value is also split into items: "-shards 1,2,3" gives
+   * 1, 2, 3. Empty items are skipped, and the list is empty by default.
+   *
+   * Items are views collected in one pass over the command line, and are
+   * validated one by one. get_option() returns the last value given.
+   * @param[in] delimiter Separates the items of one value. '\0' to only
+   * collect repeated values.
+   * @param[in] env_variable Optional. Name of an environment variable whose
+   * value, split with delimiter, is the list when the option is not in the
+   * command line. In a config file, every line of the option adds its
+   * items, as on the command line.
+   * @throws OptionDefined
+   *   If the option, or the environment variable, is already been defined.
+   */
+  void add_list(std::string const &name, std::string const &description,
+                char delimiter = '\0',
+                std::string const &env_variable = std::string());
+
+  /**
+   * @brief Defines a list of items of type T. Items are converted in bulk in
+   * parse(), into one std::vector<T>; a list with an item that cannot be
+   * converted is reported as an invalid option. get_list_as<T>() then
+   * returns the converted items.
+   * @throws OptionDefined
+   *   If the option is already been defined.
+   */
+  template<typename T>
+  void add_list(std::string const &name, std::string const &description,
+                char delimiter = '\0',
+                std::string const &env_variable = std::string());
 
   /**
    * @brief Defines a switch (can only be true/false). If the switch is found in
@@ -123,11 +358,14 @@ public:
    * here. For instance: -my_option, -my-option, etc. No spaces.
    * @param[in] description Description of the option.
    * @param[in] default_setting Default state of the switch.
+   * @param[in] env_variable Optional. Name of an environment variable that
+   * sets the switch (true/yes/false/no) when it is not in the command line.
    * @throws OptionDefined
-   *   If the option is already been defined.
+   *   If the option, or the environment variable, is already been defined.
    */
   void add_switch(std::string const &name, std::string const &description,
-                  bool default_setting);
+                  bool default_setting,
+                  std::string const &env_variable = std::string());
 
   /**
    * @brief Adds a validator for an argument. Validators are called after
@@ -135,10 +373,62 @@ public:
    * @param[in] opt_name Name of the argument.
    * @param[in] validator The validator. Must be a valid function (validator
    * .bool() == true).
+   * @param[in] cacheable If true, the result of validator for a value is
+   * kept in the validator cache (see set_validator_cache()), and used
+   * instead of calling validator again for the same value. Only for
+   * validators whose result depends on the value alone, or that are
+   * invalidated when it may change.
    * @see ValidatorFunction
    */
   void attach_validator(std::string const &opt_name,
-                        ValidatorFunction validator);
+                        ValidatorFunction validator, bool cacheable = false);
+
+  /**
+   * @brief Sizes the cache of results of cacheable validators. It holds up
+   * to 1024 results for ever by default.
+   * @param[in] capacity Most results held; once full, the least recently
+   * used one is dropped. 0 disables the cache.
+   * @param[in] ttl Time a result is used before the validator is called
+   * again. Zero for ever.
+   */
+  void set_validator_cache(std::size_t capacity,
+                           std::chrono::milliseconds ttl
+                           = std::chrono::milliseconds::zero());
+
+  /**
+   * @brief Forgets the results of cacheable validators, for instance after
+   * files were created or removed. Can be called while parsing.
+   */
+  void invalidate_validator_cache() const;
+
+  /**
+   * @brief Forgets the results of the cacheable validators of opt_name.
+   */
+  void invalidate_validator_cache(std::string const &opt_name) const;
+
+  /**
+   * @brief Hits and misses of the validator cache, to size it.
+   */
+  ValidatorCache::Stats validator_cache_stats() const;
+
+  /**
+   * @brief Runs the validators of parse() and reload_config_file() on up to
+   * threads threads at once, instead of one after another, so that slow
+   * checks (files, hosts) overlap. Validators must then be thread safe.
+   *
+   * A validator still running after timeout fails: its option is reported
+   * as invalid, and parse() does not wait for it to return. The threads are
+   * kept across parses, and at most threads more are left to validators
+   * that timed out (see ValidatorPool). Invalid options are reported in the
+   * same order either way. parse_batch() keeps calling
+   * validators in its own threads, without timeout.
+   * @param[in] threads 0 calls validators one after another in the thread
+   * that parses, which is the default.
+   * @param[in] timeout Time given to each validator. Zero waits for ever.
+   */
+  void set_validator_threads(unsigned threads,
+                             std::chrono::milliseconds timeout
+                             = std::chrono::milliseconds::zero());
 
   /**
    * @brief Set a custom handler for results of parsing the command line
@@ -149,6 +439,40 @@ public:
    */
   void set_parser_result_handler(ParserResultHandler handler);
 
+  /**
+   * @brief Set a custom handler for the files parse() can't read. The
+   * default one prints their paths and exits.
+   * @param[in] handler The handler. Must be a valid function.
+   * @throws BadFunction
+   * @see FileErrorHandler
+   */
+  void set_file_error_handler(FileErrorHandler handler);
+
+  /**
+   * @brief Lets parse() take an unambiguous prefix of an option name for
+   * the option, like GNU getopt_long: "-thr" for "-threads", unless another
+   * option starts with "-thr". Exact names always win. Disabled by default,
+   * when it costs nothing.
+   */
+  void set_abbreviations(bool enabled);
+
+  /**
+   * @brief Makes the default ParserResultHandler report the unknown input
+   * that starts with '-' and is close to an option name, as a typo ("did
+   * you mean -threads?"), and exit. Other input is left to the program, as
+   * positional arguments. Disabled by default.
+   * @see suggest_option
+   */
+  void set_suggestions(bool enabled);
+
+  /**
+   * @brief The option whose name is closest to name: at most one edit away
+   * for names of up to 4 characters, two edits for longer ones.
+   * @returns The option name, or an empty string if none is close enough or
+   * name is an option.
+   */
+  std::string suggest_option(std::string_view name) const;
+
   /**
    * @brief Get the value of an argument option.
    * @throws UndefinedOption
@@ -158,14 +482,46 @@ public:
    */
   std::string get_option(std::string const &name) const;
 
+  /**
+   * @brief Like get_option(), but returns a view of the value instead of a
+   * copy. The view is valid until the next call to parse(), reset() or
+   * reload_config_file() (hold a snapshot() to keep values longer), and, for
+   * values set by the zero-copy parse(), as long as argv.
+   * @throws UndefinedOption
+   *   If argument was not defined with any of the add_*_arg functions.
+   * @throws OptionNotSet
+   *   If argument was not set, and has no default value (required arguments).
+   */
+  std::string_view get_option_view(std::string_view name) const;
+
   /**
    * @brief Like get_option() but casts the argument value to whatever you want.
+   * For options added with add_required<T> or add_optional<T>, this returns
+   * the value converted in parse().
    * @throws BadCast
    *   If the value cannot be casted to what you want.
    */
   template<typename T>
   T get_option_as(std::string const &opt_name) const;
 
+  /**
+   * @brief Get the items of a list option, in the order they were given.
+   * @throws UndefinedOption
+   *   If name was not defined with add_list.
+   */
+  std::vector<std::string> get_list(std::string const &name) const;
+
+  /**
+   * @brief Like get_list(), but converts every item to T. For options added
+   * with add_list<T>, this returns the items converted in parse().
+   * @throws UndefinedOption
+   *   If name was not defined with add_list.
+   * @throws BadCast
+   *   If an item cannot be converted to T.
+   */
+  template<typename T>
+  std::vector<T> get_list_as(std::string const &name) const;
+
   /**
    * @brief Get the state of a switch.
    * @throws UndefinedOption
@@ -173,79 +529,321 @@ public:
    */
   bool get_switch(std::string const &switch_name) const;
 
+  /**
+   * @brief Returns the values of all options, as set by the last call to
+   * parse() or reload_config_file(). Never blocks: values are published as
+   * immutable snapshots, and a snapshot stays valid (views included) for as
+   * long as it is held, even if the options are reloaded meanwhile.
+   *
+   * get_option(), get_option_view(), get_option_as() and get_switch() read
+   * from the current snapshot without locking or copying the SnapshotPtr.
+   * None of them may run while options are being defined.
+   */
+  SnapshotPtr snapshot() const;
+
+  /**
+   * @brief The options defined so far. Once every option is defined, other
+   * threads can parse against the schema into their own ParseResult.
+   */
+  OptionSchema const &schema() const;
+
+  /**
+   * @brief Writes the options defined so far, with their lookup tables, to
+   * a file that load_schema() maps back in constant time, whatever the
+   * number of options. The file is written aside and renamed over path, so
+   * that programs using the previous one keep it as it was.
+   *
+   * Validators are not saved, and options defined with a type are saved
+   * without it: get_option_as() then converts their values on every call.
+   * @param[in] path The schema file.
+   * @returns false if the file can't be written.
+   */
+  bool save_schema(std::string const &path) const;
+
+  /**
+   * @brief Replaces the options defined so far, and their validators, by
+   * the ones saved in a file by save_schema(). The file is memory-mapped and
+   * its strings and lookup tables are used in place, so no option is copied
+   * or allocated one by one. Values found by a previous parse() are
+   * forgotten. Options can still be added and validators attached after.
+   * @param[in] path The schema file, saved by the same version of the
+   * library on the same kind of machine.
+   * @returns false, and nothing is changed, if the file can't be read or is
+   * not such a schema file.
+   */
+  bool load_schema(std::string const &path);
+
+  /**
+   * @brief Sets a config file to read option values from. Values given in
+   * the command line take precedence over the ones in the file, which take
+   * precedence over the defaults.
+   *
+   * The file is read by the next parse(), which checks required options and
+   * runs validators on the merged values. It is memory-mapped and scanned
+   * once; only the values of defined options are copied out of it.
+   *
+   * Each line of the file holds one option: its name, followed by its value
+   * for arguments, separated by spaces or '='. Switches can be given alone,
+   * or with a value (true/yes/false/no). Lines starting with '#' are
+   * comments, and options that are not defined are ignored, so that several
+   * programs can share a file. If the file can't be read, its path is given
+   * to the FileErrorHandler; options with bad values are reported as
+   * invalid options.
+   * @param[in] path The config file.
+   */
+  void set_config_file(std::string const &path);
+
+  /**
+   * @brief Reads option values from a config file, like set_config_file(),
+   * and publishes them in a new snapshot right away.
+   *
+   * Validators are run on the new values. The current snapshot is only
+   * replaced if the file can be read, every value is valid and no required
+   * option is missing.
+   * @param[in] path The config file.
+   * @param[out] problems Names of the options that made the reload fail (or
+   * the path, if the file can't be read).
+   * @returns true if the values were reloaded.
+   */
+  bool reload_config_file(std::string const &path, StringList &problems);
+
+  /**
+   * @brief Loads a config file with reload_config_file(), then reloads it
+   * from a background thread every time it changes (uses inotify on Linux).
+   * Replaces any config file watched before.
+   * @param[out] problems Same as in reload_config_file(), for the first load.
+   * @returns true if the first load succeeded. The file is watched either
+   * way.
+   */
+  bool watch_config_file(std::string const &path, StringList &problems);
+
+  /**
+   * @brief Stops watching the config file, if any.
+   */
+  void stop_watching_config_file();
+
+  /**
+   * @brief Adds a handler called every time a new snapshot changes the value
+   * of one or more options. Handlers run on the thread that published the
+   * snapshot, and must not call parse() or reload_config_file().
+   * @param[in] handler The handler. Must be a valid function.
+   * @throws BadFunction
+   */
+  void add_change_handler(ChangeHandler handler);
+
+  /**
+   * @brief Defines a subcommand, like "commit" in "git commit -m x".
+   *
+   * The first argument given to parse() that is a subcommand name, and not
+   * an option or the value of one, selects the subcommand. Options before it
+   * may come from response files (see parse()), but the subcommand name
+   * must be an argument of its own: in a response file, it is just a
+   * positional argument. The options before it are parsed by this
+   * CmdLineOptions; the subcommand name and
+   * what follows are parsed by the CmdLineOptions of the subcommand, as if
+   * it were a program of its own, with its own -h and ParserResultHandler.
+   * Its left overs are added after the ones of this CmdLineOptions.
+   *
+   * factory is only called the first time the subcommand is used, so the
+   * options of subcommands that are not used are never defined. Only the
+   * argc/argv parse() functions look for subcommands.
+   * @param[in] name Name of the subcommand. No spaces.
+   * @param[in] description Shown by print_usage(), and by the help of the
+   * subcommand.
+   * @param[in] factory Defines the options of the subcommand.
+   * @throws OptionDefined
+   *   If a subcommand with this name is already defined.
+   * @throws BadFunction
+   *   If factory is not a valid function.
+   */
+  void add_subcommand(std::string const &name, std::string const &description,
+                      SubcommandFactory factory);
+
+  /**
+   * @brief Name of the subcommand selected by the last parse(), or an empty
+   * string if there was none.
+   */
+  std::string subcommand_name() const;
+
+  /**
+   * @brief Options of the subcommand selected by the last parse().
+   * @throws UndefinedOption
+   *   If no subcommand was selected.
+   */
+  CmdLineOptions &subcommand();
+
+  /**
+   * @brief Options of the subcommand called name, defined by its factory if
+   * they were not yet, for instance to print its help.
+   * @throws UndefinedOption
+   *   If there is no such subcommand.
+   */
+  CmdLineOptions &subcommand(std::string const &name);
+
+  /**
+   * @brief Sets the width print_usage() wraps descriptions at.
+   * @param[in] columns 0 to use the width of the terminal.
+   */
+  void set_usage_width(std::size_t columns);
+
   /**
    * @brief Prints simple help on using this program. This contains the
    * description of the program, and the list of all options and their
-   * descriptions.
+   * descriptions, and of the subcommands if any.
+   *
+   * The help is rendered once and kept until an option or subcommand is
+   * added or the values change, so printing it again is a single write.
+   *
+   * Not to be called from a ParserResultHandler or a ChangeHandler.
    * @param[out] out the stream on which to print the help.
    */
   void print_usage(std::ostream &out) const;
 
+  /**
+   * @brief Time spent defining options and in each phase of parse(),
+   * tokens and lookups, and the memory held by the options and the values.
+   * Times and counts are only collected by a library built with CMDO_STATS
+   * (see STATS_ENABLED); otherwise the code that would collect them is
+   * compiled out, and only the memory is filled in. parse_batch() and
+   * subcommands are not counted here: subcommands have their own stats.
+   *
+   * Not to be called from a ParserResultHandler or a ChangeHandler.
+   */
+  ParseStats stats();
+
+  /**
+   * @brief Writes stats() to out, one "name: value" per line.
+   */
+  void print_stats(std::ostream &out);
+
+  /**
+   * @brief Sets the times and counts of stats() back to zero.
+   */
+  void reset_stats();
+
+  /**
+   * @brief Counts the allocations made by every parse() into stats(), by
+   * calling counter before and after it. Only used with CMDO_STATS.
+   * @param[in] counter A function returning the number of allocations made
+   * so far, or an empty function to stop counting.
+   */
+  void set_allocation_counter(AllocationCounter counter);
+
 private:
+  typedef OptionSchema::ConfigValues ConfigValues;
+  typedef OptionSchema::ResponseFileList ResponseFileList;
 
-  template<typename T>
-  class Option {
-  public:
-    Option(std::string const &name, std::string const &description,
-           T const &default_value);
+  /**
+   * @brief Forgets the values set by parse(), keeping the memory used.
+   */
+  void clear_values();
 
-    std::string name() const;
+  /**
+   * @brief Makes the next print_usage() render the help again.
+   */
+  void invalidate_usage();
 
-    std::string description() const;
+  /**
+   * @brief print_usage(), with mutex_ held.
+   */
+  void print_usage_locked(std::ostream &out) const;
 
-    /**
-     * @brief Get the value of this option.
-     * @throws OptionNotSet
-     *   If a value was not set with set().
-     */
-    T const &get() const;
+  /**
+   * @brief Renders the help printed by print_usage() into out.
+   */
+  void render_usage(std::string &out) const;
 
-    void set(T value);
+  /**
+   * @brief Fills tokens_ with argv, expanding @file arguments into the lines
+   * of the file, which are kept in responseFiles_. Like
+   * OptionSchema::expand_argument(), files that can't be read and values of
+   * options are kept as is. Stops at the argument that selects a
+   * subcommand, which is not the value of an option once the files before
+   * it are expanded.
+   * @returns The position of that argument in argv, or argc if there is
+   * none.
+   */
+  int collect_tokens(int argc, char **argv);
 
-    /**
-     * @brief Returns the default value specified in the constructor.
-     */
-    T const &get_default() const;
+  /**
+   * @brief Whether arg is the name of a subcommand, and not of an option.
+   */
+  bool is_subcommand(std::string_view arg) const;
 
-    /**
-     * @brief Returns true if the value for this option is set with set().
-     */
-    bool is_set() const;
+  /**
+   * @brief Makes the subcommand called name the selected one, and returns
+   * its options.
+   */
+  CmdLineOptions &select_subcommand(std::string_view name);
 
-    /**
-     * @brief Returns true if this option is required.
-     */
-    bool is_required() const;
+  /**
+   * @brief Options of the subcommand at position, calling its factory the
+   * first time.
+   */
+  CmdLineOptions &build_subcommand(std::size_t position);
 
-    void set_required(bool const &required);
+  /**
+   * @brief Parses one argument vector of parse_batch() into result, using
+   * command_line as scratch space, and the values of env and config.
+   */
+  void parse_batch_item(StringList const &argv, ConfigValues &command_line,
+                        std::shared_ptr<ConfigValues const> const &env,
+                        std::shared_ptr<ConfigValues const> const &config,
+                        BatchResult &result) const;
 
-  private:
-    std::string name_;
-    std::string description_;
-    bool isSet_;
-    bool isRequired_;
-    T value_;
-    T defaultValue_;
-  };
+  /**
+   * @brief Publishes the new values and runs the ParserResultHandler.
+   */
+  void finish_parse(StringList const &left_overs,
+                    StringList const &options_with_no_value,
+                    StringList &invalid_options);
 
-  typedef Option<std::string> StringOption;
-  typedef std::vector<StringOption> ArgOptList;
-  typedef Option<bool> BoolOption;
-  typedef std::vector<BoolOption> SwitchOptList;
-  typedef std::vector<ValidatorFunction> ValidatorFunctionList;
-  typedef std::map<std::string, ValidatorFunctionList> ValidatorFunctionMap;
+  /**
+   * @brief Reads the config file set by set_config_file() into config_, if
+   * not done yet. Adds its path to unreadable_files if it can't be read.
+   */
+  void load_config(StringList &unreadable_files);
 
-  bool is_switch(std::string const &name) const;
+  /**
+   * @brief Adds the names of the options with bad values in values, if not
+   * null, to invalid_options.
+   */
+  static void add_bad_values(ConfigValues const *values,
+                             StringList &invalid_options);
 
-  bool is_arg(std::string const &name) const;
+  /**
+   * @brief The text given to name, an invalid option of the last parse(),
+   * as printed by the default ParserResultHandler.
+   */
+  std::string invalid_value(std::string const &name) const;
 
-  ArgOptList::const_iterator find_arg(std::string const &name) const;
+  /**
+   * @brief Merges the values set by parse(), the ones in env_, the ones in
+   * config and the defaults into a new snapshot (see merge_values()).
+   */
+  std::shared_ptr<Snapshot> build_snapshot(
+      std::shared_ptr<ConfigValues const> const &config,
+      StringList &missing_options, StringList &invalid_options);
 
-  ArgOptList::iterator find_arg(std::string const &name);
+  /**
+   * @brief A new empty snapshot, allocated from the memory resource of the
+   * schema.
+   */
+  std::shared_ptr<Snapshot> new_snapshot() const;
 
-  SwitchOptList::const_iterator find_switch(std::string const &name) const;
+  /**
+   * @brief Makes snapshot the current one, then calls the change handlers
+   * if any value changed. The previous snapshot is kept for reuse by the
+   * next build_snapshot() if nobody else holds it.
+   */
+  void publish(SnapshotPtr const &snapshot);
 
-  SwitchOptList::iterator find_switch(std::string const &name);
+  /**
+   * @brief Calls the change handlers with the names of the options whose
+   * value differs between previous and snapshot.
+   */
+  void notify_changes(Snapshot const &previous,
+                      Snapshot const &snapshot) const;
 
   class ErrorPrinter {
   public:
@@ -260,81 +858,115 @@ private:
     std::ostream &out_;
   };
 
+  struct Subcommand {
+    std::string name;
+    std::string description;
+    SubcommandFactory factory;
+    // Null until the subcommand is first used.
+    std::unique_ptr<CmdLineOptions> options;
+  };
+
   // The -h switch is added by default.
   static std::string const HELP_SWITCH_NAME;
 
-  std::mutex mutex_;
-  ArgOptList argOptionList_;
-  SwitchOptList switchOptionList_;
+  static std::size_t const NO_SUBCOMMAND = SIZE_MAX;
+
+  typedef PublishedPtr<Snapshot>::Reader SnapshotReader;
+
+  // Mutable for subcommand_name() and print_usage(), which are const.
+  mutable std::mutex mutex_;
+  OptionSchema schema_;
+  // Values set by the last parse().
+  ConfigValues commandLine_;
+  // False if the last parse() was the zero-copy one.
+  bool copyValues_;
+  // argv of the last parse(), with @files expanded.
+  ViewList tokens_;
+  // Splits the command lines given to parse().
+  ShellTokenizer shellTokenizer_;
+  // @files of the last zero-copy parse(), shared with the snapshots that
+  // have views into them.
+  std::shared_ptr<ResponseFileList> responseFiles_;
   std::string programName_;
   std::string programDescription_;
-  ValidatorFunctionMap validatorFunctionMap_;
   std::ostream &errorStream_;
   std::ostream &stdStream_;
   ParserResultHandler parserResultHandler_;
+  FileErrorHandler fileErrorHandler_;
+  // Set by set_suggestions(), read by the default ParserResultHandler.
+  bool suggestions_;
+  std::vector<Subcommand> subcommands_;
+  // Names of subcommands_.
+  OptionIndex subcommandIndex_;
+  // Subcommand selected by the last parse().
+  std::size_t selected_;
+  // Names of the program and parent commands, for the usage of a
+  // subcommand.
+  std::string usagePrefix_;
+  // Set by set_usage_width(), 0 for the width of the terminal.
+  std::size_t usageWidth_;
+  // The help kept by print_usage(), under mutex_.
+  mutable std::string usage_;
+  // False when usage_ must be rendered again.
+  mutable bool usageValid_;
+  // OptionSchema::version_ when usage_ was rendered.
+  mutable std::size_t usageVersion_;
+  std::vector<ChangeHandler> changeHandlers_;
+  // Set by set_validator_threads(), null to validate in the parsing thread.
+  std::unique_ptr<ValidatorPool const> validatorPool_;
+  // Bound variables, as read by the last parse().
+  std::shared_ptr<ConfigValues const> env_;
+  // Set by set_config_file(), read by the next parse().
+  std::string configPath_;
+  // Last config file loaded.
+  std::shared_ptr<ConfigValues const> config_;
+  std::unique_ptr<FileWatcher> configWatcher_;
+  // Read by any thread without locking, replaced with mutex_ held.
+  PublishedPtr<Snapshot> snapshot_;
+  // A snapshot no longer used, recycled by the next build_snapshot().
+  std::shared_ptr<Snapshot> spareSnapshot_;
+  // Times and counts of stats(), only collected with CMDO_STATS.
+  ParseStats stats_;
+  // Set by set_allocation_counter().
+  AllocationCounter allocationCounter_;
 };
 
 template<typename T>
-T CmdLineOptions::get_option_as(std::string const &opt_name) const {
-  std::string const &v = get_option(opt_name);
-  return from_string<T>(v);
-}
-
-template<typename T>
-CmdLineOptions::Option<T>::Option(std::string const &name,
+void CmdLineOptions::add_required(std::string const &name,
                                   std::string const &description,
-                                  T const &default_value)
-    : name_(name), description_(description),
-      isSet_(false), isRequired_(false), value_(default_value),
-      defaultValue_(default_value) {
-  if (name_.empty()) {
-    throw BadOption();
-  }
+                                  std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_required<T>(name, description, env_variable);
 }
 
-template<typename T>
-std::string CmdLineOptions::Option<T>::name() const {
-  return name_;
-}
-
-template<typename T>
-std::string CmdLineOptions::Option<T>::description() const {
-  return description_;
-}
-
-template<typename T>
-bool CmdLineOptions::Option<T>::is_set() const {
-  return isSet_;
-}
-
-template<typename T>
-bool CmdLineOptions::Option<T>::is_required() const {
-  return isRequired_;
-}
-
-template<typename T>
-T const &CmdLineOptions::Option<T>::get() const {
-  if (is_required() && !is_set()) {
-    throw OptionNotSet();
-  }
-
-  return value_;
+template<typename T, typename>
+void CmdLineOptions::add_optional(std::string const &name,
+                                  std::string const &description,
+                                  T const &default_value,
+                                  std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_optional<T>(name, description, default_value, env_variable);
 }
 
 template<typename T>
-void CmdLineOptions::Option<T>::set(T value) {
-  value_ = value;
-  isSet_ = true;
+void CmdLineOptions::add_list(std::string const &name,
+                              std::string const &description, char delimiter,
+                              std::string const &env_variable) {
+  std::unique_lock<std::mutex> l(mutex_);
+  StatsTimer const timer(&stats_, &ParseStats::registration_ns);
+  schema_.add_list<T>(name, description, delimiter, env_variable);
 }
 
 template<typename T>
-void CmdLineOptions::Option<T>::set_required(bool const &required) {
-  isRequired_ = required;
+T CmdLineOptions::get_option_as(std::string const &opt_name) const {
+  return SnapshotReader(snapshot_)->get_option_as<T>(opt_name);
 }
 
 template<typename T>
-T const &CmdLineOptions::Option<T>::get_default() const {
-  return defaultValue_;
+std::vector<T> CmdLineOptions::get_list_as(std::string const &name) const {
+  return SnapshotReader(snapshot_)->get_list_as<T>(name);
 }
 
 template<typename T>
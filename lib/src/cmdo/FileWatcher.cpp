@@ -0,0 +1,153 @@
+#include "cmdo/FileWatcher.h"
+#include "cmdo/OptionSchema.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <system_error>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace cmdo {
+
+FileWatcher::FileWatcher(std::string const &path, ChangeFunction on_change)
+    : path_(path), onChange_(on_change) {
+  if (!onChange_) {
+    throw BadFunction();
+  }
+  // Close on exec, so that processes the program starts don't get them.
+#ifdef __linux__
+  if (::pipe2(stopPipe_, O_CLOEXEC) != 0) {
+    throw std::system_error(errno, std::generic_category());
+  }
+#else
+  if (::pipe(stopPipe_) != 0) {
+    throw std::system_error(errno, std::generic_category());
+  }
+  ::fcntl(stopPipe_[0], F_SETFD, FD_CLOEXEC);
+  ::fcntl(stopPipe_[1], F_SETFD, FD_CLOEXEC);
+#endif
+  inotifyFd_ = open_inotify();
+  thread_ = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+  char const stop('s');
+  while (::write(stopPipe_[1], &stop, 1) < 0 && errno == EINTR) {
+  }
+  thread_.join();
+  ::close(stopPipe_[0]);
+  ::close(stopPipe_[1]);
+  if (inotifyFd_ >= 0) {
+    ::close(inotifyFd_);
+  }
+}
+
+std::string const &FileWatcher::path() const {
+  return path_;
+}
+
+void FileWatcher::run() {
+  if (inotifyFd_ >= 0) {
+    run_inotify();
+  } else {
+    run_polling();
+  }
+}
+
+#ifdef __linux__
+
+int FileWatcher::open_inotify() const {
+  int const fd = ::inotify_init1(IN_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+
+  std::string dir(".");
+  size_t const pos = path_.find_last_of("/");
+  if (pos != path_.npos) {
+    dir = pos == 0 ? "/" : path_.substr(0, pos);
+  }
+  if (::inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void FileWatcher::run_inotify() {
+  int const fd = inotifyFd_;
+  std::string const name = path_.substr(path_.find_last_of("/") + 1);
+
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    pollfd fds[2] = {{fd, POLLIN, 0}, {stopPipe_[0], POLLIN, 0}};
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[1].revents != 0) {
+      break;
+    }
+
+    ssize_t const length = ::read(fd, buffer, sizeof(buffer));
+    if (length <= 0) {
+      continue;
+    }
+    bool changed(false);
+    for (char *p = buffer; p < buffer + length;) {
+      inotify_event const *event = reinterpret_cast<inotify_event *>(p);
+      if (event->len > 0 && name == event->name) {
+        changed = true;
+      }
+      p += sizeof(inotify_event) + event->len;
+    }
+    if (changed) {
+      onChange_();
+    }
+  }
+}
+
+#else
+
+int FileWatcher::open_inotify() const {
+  return -1;
+}
+
+void FileWatcher::run_inotify() {
+}
+
+#endif
+
+void FileWatcher::run_polling() {
+  auto stamp = [this](struct stat &st) -> bool {
+    return ::stat(path_.c_str(), &st) == 0;
+  };
+
+  struct stat last = {};
+  bool exists = stamp(last);
+  while (true) {
+    pollfd fd = {stopPipe_[0], POLLIN, 0};
+    int const r = ::poll(&fd, 1, 1000);
+    if (r > 0) {
+      break;
+    }
+
+    struct stat current = {};
+    bool const nowExists = stamp(current);
+    if (nowExists && (!exists || current.st_mtime != last.st_mtime
+                      || current.st_size != last.st_size
+                      || current.st_ino != last.st_ino)) {
+      onChange_();
+    }
+    exists = nowExists;
+    last = current;
+  }
+}
+
+}
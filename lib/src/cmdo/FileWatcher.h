@@ -0,0 +1,60 @@
+#ifndef CMDO_FILEWATCHER_H
+#define CMDO_FILEWATCHER_H
+
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace cmdo {
+
+/**
+ * @brief Calls a function from a background thread every time a file is
+ * written or replaced.
+ *
+ * Uses inotify on Linux (watching the directory, so that files replaced by
+ * a rename are seen too), and checks the modification time of the file once
+ * per second everywhere else.
+ */
+class FileWatcher {
+public:
+  typedef std::function<void()> ChangeFunction;
+
+  /**
+   * @throws BadFunction
+   *   If on_change is not a valid function.
+   */
+  FileWatcher(std::string const &path, ChangeFunction on_change);
+
+  FileWatcher(FileWatcher const &) = delete;
+
+  FileWatcher &operator=(FileWatcher const &) = delete;
+
+  /**
+   * @brief Stops watching. Waits for a running on_change to return.
+   */
+  ~FileWatcher();
+
+  std::string const &path() const;
+
+private:
+  void run();
+
+  int open_inotify() const;
+
+  void run_inotify();
+
+  void run_polling();
+
+  std::string path_;
+  ChangeFunction onChange_;
+  // Written to by the destructor to wake up the watching thread.
+  int stopPipe_[2];
+  // Set up before the thread starts, so no change is missed. -1 if inotify
+  // is not available.
+  int inotifyFd_;
+  std::thread thread_;
+};
+
+}
+
+#endif //CMDO_FILEWATCHER_H
@@ -0,0 +1,50 @@
+#include "cmdo/MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cmdo {
+
+MappedFile::MappedFile(std::string const &path)
+    : data_(nullptr), size_(0), open_(false) {
+  int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+      open_ = true;
+    } else {
+      void *const data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        // Read once, front to back.
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<char const *>(data);
+        open_ = true;
+      } else {
+        size_ = 0;
+      }
+    }
+  }
+  // The mapping stays valid after the file is closed.
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+}
+
+bool MappedFile::is_open() const {
+  return open_;
+}
+
+std::string_view MappedFile::contents() const {
+  return std::string_view(data_, size_);
+}
+
+}
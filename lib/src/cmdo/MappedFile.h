@@ -0,0 +1,43 @@
+#ifndef CMDO_MAPPEDFILE_H
+#define CMDO_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace cmdo {
+
+/**
+ * @brief A regular file mapped read-only into memory, for as long as the
+ * MappedFile lives.
+ *
+ * The contents stay the same if the file is replaced on disk (renamed
+ * over), but not if it is rewritten in place: copy what must outlive a
+ * short scan of a file that may be edited.
+ */
+class MappedFile {
+public:
+  /**
+   * @brief Maps the file at path. Check is_open() to know if it worked.
+   */
+  explicit MappedFile(std::string const &path);
+
+  MappedFile(MappedFile const &) = delete;
+
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  ~MappedFile();
+
+  bool is_open() const;
+
+  std::string_view contents() const;
+
+private:
+  char const *data_;
+  std::size_t size_;
+  bool open_;
+};
+
+}
+
+#endif //CMDO_MAPPEDFILE_H
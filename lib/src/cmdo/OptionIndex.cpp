@@ -0,0 +1,203 @@
+#include "cmdo/OptionIndex.h"
+#include <cstring>
+
+namespace cmdo {
+
+namespace {
+
+std::size_t const INITIAL_CAPACITY = 16;
+
+}
+
+OptionIndex::OptionIndex(std::pmr::memory_resource *resource)
+    : slots_(INITIAL_CAPACITY, resource), names_(resource), size_(0), attached_(nullptr),
+      attachedCapacity_(0), attachedNames_(), switchCount_(0), argCount_(0) {
+  for (Slot &slot : slots_) {
+    slot.kind = Kind::None;
+  }
+}
+
+std::uint64_t OptionIndex::hash(char const *data, std::size_t length) {
+  // FNV-1a
+  std::uint64_t h = 14695981039346656037ULL;
+  for (std::size_t i(0); i < length; ++i) {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+std::size_t OptionIndex::probe(std::uint64_t h, char const *name,
+                               std::size_t length) const {
+  Slot const *const slots = table();
+  std::string_view const interned = names();
+  std::size_t const mask = capacity() - 1;
+  std::size_t i = static_cast<std::size_t>(h) & mask;
+  // An attached table may be full.
+  for (std::size_t n(0); n <= mask; ++n) {
+    Slot const &slot = slots[i];
+    if (slot.kind == Kind::None) {
+      return i;
+    }
+    if (slot.hash == h && slot.nameLength == length
+        && slot.nameOffset <= interned.size()
+        && length <= interned.size() - slot.nameOffset
+        && std::memcmp(interned.data() + slot.nameOffset, name,
+                       length) == 0) {
+      return i;
+    }
+    i = (i + 1) & mask;
+  }
+  return capacity();
+}
+
+bool OptionIndex::insert(std::string_view name, Kind kind,
+                         std::size_t position) {
+  if (attached_ != nullptr) {
+    detach();
+  }
+  // Keep the load factor under 1/2 so probe sequences stay short.
+  if ((size_ + 1) * 2 > slots_.size()) {
+    grow();
+  }
+
+  std::uint64_t const h = hash(name.data(), name.size());
+  Slot &slot = slots_[probe(h, name.data(), name.size())];
+  if (slot.kind != Kind::None) {
+    return false;
+  }
+
+  slot.hash = h;
+  slot.nameOffset = static_cast<std::uint32_t>(names_.size());
+  slot.nameLength = static_cast<std::uint32_t>(name.size());
+  slot.position = static_cast<std::uint32_t>(position);
+  slot.kind = kind;
+  names_.append(name);
+  ++size_;
+  return true;
+}
+
+OptionIndex::Entry OptionIndex::find(char const *name,
+                                     std::size_t length) const {
+  std::size_t const i = probe(hash(name, length), name, length);
+  if (i == capacity()) {
+    return Entry{Kind::None, 0};
+  }
+  Slot const &slot = table()[i];
+  if (slot.kind == Kind::None || !is_valid(slot)) {
+    return Entry{Kind::None, 0};
+  }
+  return Entry{slot.kind, slot.position};
+}
+
+void OptionIndex::clear() {
+  if (attached_ != nullptr) {
+    attached_ = nullptr;
+    attachedCapacity_ = 0;
+    attachedNames_ = std::string_view();
+    if (slots_.empty()) {
+      slots_.resize(INITIAL_CAPACITY);
+    }
+  }
+  for (Slot &slot : slots_) {
+    slot.kind = Kind::None;
+  }
+  names_.clear();
+  size_ = 0;
+}
+
+std::string_view OptionIndex::table_bytes() const {
+  return std::string_view(reinterpret_cast<char const *>(table()),
+                          capacity() * sizeof(Slot));
+}
+
+std::string_view OptionIndex::name_bytes() const {
+  return attached_ != nullptr ? attachedNames_ : std::string_view(names_);
+}
+
+std::size_t OptionIndex::retained_bytes() const {
+  return slots_.capacity() * sizeof(Slot) + names_.capacity();
+}
+
+bool OptionIndex::attach(std::string_view table, std::string_view names,
+                         std::size_t size, std::size_t switch_count,
+                         std::size_t arg_count) {
+  if (reinterpret_cast<std::uintptr_t>(table.data()) % alignof(Slot) != 0
+      || table.size() % sizeof(Slot) != 0) {
+    return false;
+  }
+  std::size_t const capacity = table.size() / sizeof(Slot);
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0 || size >= capacity) {
+    return false;
+  }
+
+  slots_.clear();
+  slots_.shrink_to_fit();
+  names_.clear();
+  size_ = size;
+  attached_ = reinterpret_cast<Slot const *>(table.data());
+  attachedCapacity_ = capacity;
+  attachedNames_ = names;
+  switchCount_ = switch_count;
+  argCount_ = arg_count;
+  return true;
+}
+
+bool OptionIndex::is_valid(Slot const &slot) const {
+  if (attached_ == nullptr) {
+    return true;
+  }
+  std::size_t const limit = slot.kind == Kind::Switch ? switchCount_
+                            : slot.kind == Kind::Arg ? argCount_ : 0;
+  return slot.position < limit;
+}
+
+void OptionIndex::detach() {
+  // Cleared in place, a slot left out would cut the probe chains through
+  // it: the slots kept are placed again, as grow() does.
+  std::pmr::vector<Slot> slots(attachedCapacity_, slots_.get_allocator());
+  for (Slot &slot : slots) {
+    slot.kind = Kind::None;
+  }
+  std::size_t size(0);
+  for (std::size_t i(0); i < attachedCapacity_; ++i) {
+    Slot const &slot = attached_[i];
+    if (slot.kind == Kind::None || !is_valid(slot)
+        || slot.nameOffset > attachedNames_.size()
+        || slot.nameLength > attachedNames_.size() - slot.nameOffset) {
+      continue;
+    }
+    place(slots, slot);
+    ++size;
+  }
+  slots_.swap(slots);
+  names_.assign(attachedNames_.data(), attachedNames_.size());
+  size_ = size;
+  attached_ = nullptr;
+  attachedCapacity_ = 0;
+  attachedNames_ = std::string_view();
+}
+
+void OptionIndex::grow() {
+  std::pmr::vector<Slot> old(slots_.size() * 2, slots_.get_allocator());
+  old.swap(slots_);
+  for (Slot &slot : slots_) {
+    slot.kind = Kind::None;
+  }
+  for (Slot const &slot : old) {
+    if (slot.kind != Kind::None) {
+      place(slots_, slot);
+    }
+  }
+}
+
+void OptionIndex::place(std::pmr::vector<Slot> &slots, Slot const &slot) {
+  std::size_t const mask = slots.size() - 1;
+  std::size_t i = static_cast<std::size_t>(slot.hash) & mask;
+  while (slots[i].kind != Kind::None) {
+    i = (i + 1) & mask;
+  }
+  slots[i] = slot;
+}
+
+}
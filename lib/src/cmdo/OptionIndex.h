@@ -0,0 +1,158 @@
+#ifndef CMDO_OPTIONINDEX_H
+#define CMDO_OPTIONINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cmdo {
+
+/**
+ * @brief Maps option names to their position in the option lists of
+ * CmdLineOptions.
+ *
+ * Open-addressing hash table (linear probing, power of two capacity). Names
+ * are interned into a single buffer owned by the index, so a lookup never
+ * allocates and never builds a std::string. The table and the names can be
+ * saved as bytes, and later used in place by another index. Both are
+ * allocated from a memory resource, which must outlive the index.
+ */
+class OptionIndex {
+public:
+  enum class Kind : unsigned char {
+    None,
+    Switch,
+    Arg
+  };
+
+  struct Entry {
+    Kind kind;
+    std::size_t position;
+
+    bool found() const {
+      return kind != Kind::None;
+    }
+  };
+
+  explicit OptionIndex(std::pmr::memory_resource *resource
+                       = std::pmr::get_default_resource());
+
+  /**
+   * @brief Adds a name to the index.
+   * @returns false if the name is already in the index (nothing is changed).
+   */
+  bool insert(std::string_view name, Kind kind, std::size_t position);
+
+  /**
+   * @brief Looks up a name. Returns an entry with Kind::None if the name is
+   * not in the index.
+   */
+  Entry find(char const *name, std::size_t length) const;
+
+  Entry find(std::string_view name) const {
+    return find(name.data(), name.size());
+  }
+
+  bool contains(std::string_view name) const {
+    return find(name).found();
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  void clear();
+
+  /**
+   * @brief The hash table, as bytes that attach() can use in place.
+   */
+  std::string_view table_bytes() const;
+
+  /**
+   * @brief The interned names the table refers to.
+   */
+  std::string_view name_bytes() const;
+
+  /**
+   * @brief Bytes allocated by the index. An attached table is not counted.
+   */
+  std::size_t retained_bytes() const;
+
+  /**
+   * @brief Uses table and names, as returned by table_bytes() and
+   * name_bytes() of an index of size names, in place of this index's own.
+   * Nothing is copied or scanned, so they must outlive this index, or its
+   * next insert() or clear(), which copy them back first.
+   *
+   * They may come from a damaged file: names out of names, and positions
+   * not under switch_count or arg_count for their kind, are never found.
+   * @returns false, and nothing is changed, if table is misaligned or is not
+   * sized like a table.
+   */
+  bool attach(std::string_view table, std::string_view names,
+              std::size_t size, std::size_t switch_count,
+              std::size_t arg_count);
+
+  static std::uint64_t hash(char const *data, std::size_t length);
+
+private:
+  // Saved as is by table_bytes(): only fixed size members.
+  struct Slot {
+    std::uint64_t hash;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t position;
+    Kind kind;
+  };
+
+  void grow();
+
+  /**
+   * @brief Puts slot in the first free slot of its probe sequence in slots,
+   * which must have one.
+   */
+  static void place(std::pmr::vector<Slot> &slots, Slot const &slot);
+
+  /**
+   * @brief Copies the attached table and names into slots_ and names_,
+   * without the slots find() would not return.
+   */
+  void detach();
+
+  /**
+   * @brief False for the slots of an attached table that are out of bounds.
+   */
+  bool is_valid(Slot const &slot) const;
+
+  Slot const *table() const {
+    return attached_ != nullptr ? attached_ : slots_.data();
+  }
+
+  std::size_t capacity() const {
+    return attached_ != nullptr ? attachedCapacity_ : slots_.size();
+  }
+
+  std::string_view names() const {
+    return attached_ != nullptr ? attachedNames_ : std::string_view(names_);
+  }
+
+  std::size_t probe(std::uint64_t hash, char const *name,
+                    std::size_t length) const;
+
+  std::pmr::vector<Slot> slots_;
+  std::pmr::string names_;
+  std::size_t size_;
+  // Table and names used in place, null unless attached.
+  Slot const *attached_;
+  std::size_t attachedCapacity_;
+  std::string_view attachedNames_;
+  std::size_t switchCount_;
+  std::size_t argCount_;
+};
+
+}
+
+#endif //CMDO_OPTIONINDEX_H
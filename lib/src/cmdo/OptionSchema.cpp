@@ -0,0 +1,959 @@
+#include "cmdo/OptionSchema.h"
+#include "cmdo/MappedFile.h"
+#include "cmdo/ParseResult.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+extern char **environ;
+
+namespace cmdo {
+
+namespace {
+
+// A schema file is a SchemaHeader followed by sections aligned to 8 bytes,
+// each written and read as is. Offsets are from the start of the file, so
+// it can be mapped anywhere.
+char const SCHEMA_MAGIC[8] = {'c', 'm', 'd', 'o', 's', 'c', 'h', 'm'};
+std::uint32_t const SCHEMA_VERSION = 1;
+// Reads back differently on a machine of the other byte order.
+std::uint32_t const SCHEMA_BYTE_ORDER = 0x01020304;
+
+struct Section {
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+// A string of the strings section.
+struct StringRef {
+  std::uint32_t offset;
+  std::uint32_t length;
+};
+
+struct SchemaHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint64_t fileSize;
+  std::uint32_t argCount;
+  std::uint32_t switchCount;
+  std::uint64_t indexSize;
+  std::uint64_t envIndexSize;
+  Section args;
+  Section switches;
+  Section index;
+  Section indexNames;
+  Section envIndex;
+  Section envNames;
+  Section strings;
+  StringRef envPrefix;
+};
+
+struct ArgRecord {
+  StringRef name;
+  StringRef description;
+  StringRef defaultValue;
+  std::uint8_t required;
+  std::uint8_t isList;
+  char delimiter;
+};
+
+struct SwitchRecord {
+  StringRef name;
+  StringRef description;
+  std::uint8_t defaultSetting;
+};
+
+// Zeroed padding included, so that the same schema always makes the same
+// file.
+template<typename T>
+T zeroed() {
+  T value;
+  std::memset(&value, 0, sizeof(T));
+  return value;
+}
+
+template<typename T>
+void append_record(std::string &records, T const &record) {
+  records.append(reinterpret_cast<char const *>(&record), sizeof(T));
+}
+
+template<typename T>
+T read_record(std::string_view records, std::size_t i) {
+  T record;
+  std::memcpy(&record, records.data() + i * sizeof(T), sizeof(T));
+  return record;
+}
+
+StringRef add_string(std::string &strings, std::string_view str) {
+  StringRef const ref{static_cast<std::uint32_t>(strings.size()),
+                      static_cast<std::uint32_t>(str.size())};
+  strings.append(str);
+  return ref;
+}
+
+Section append_section(std::string &file, std::string_view bytes) {
+  file.resize((file.size() + 7) / 8 * 8, '\0');
+  Section const section{file.size(), bytes.size()};
+  file.append(bytes);
+  return section;
+}
+
+bool read_section(std::string_view file, Section section,
+                  std::string_view &bytes) {
+  if (section.offset % 8 != 0 || section.offset > file.size()
+      || section.size > file.size() - section.offset) {
+    return false;
+  }
+  bytes = file.substr(section.offset, section.size);
+  return true;
+}
+
+bool read_string(std::string_view strings, StringRef ref,
+                 std::string_view &str) {
+  if (ref.offset > strings.size()
+      || ref.length > strings.size() - ref.offset) {
+    return false;
+  }
+  str = strings.substr(ref.offset, ref.length);
+  return true;
+}
+
+}
+
+OptionSchema::OptionSchema(std::pmr::memory_resource *resource)
+    : resource_(resource), argOptionList_(resource), typedValues_(resource),
+      listFormats_(resource), switchOptionList_(resource), index_(resource),
+      schemaStrings_(4096, resource), schemaFile_(),
+      mapped_{false, 0, 0, std::string_view(), std::string_view(),
+              std::string_view()},
+      validatorFunctionMap_(),
+      validatorCache_(std::make_shared<ValidatorCache>(
+          1024, std::chrono::milliseconds::zero())),
+      envIndex_(resource), envPrefix_(resource),
+      version_(0) {
+}
+
+void OptionSchema::add_required(std::string const &name,
+                                std::string const &description,
+                                std::string const &env_variable) {
+  add_arg(name, description, "", true, nullptr, env_variable);
+}
+
+void OptionSchema::add_optional(std::string const &name,
+                                std::string const &description,
+                                std::string const &default_value,
+                                std::string const &env_variable) {
+  add_arg(name, description, default_value, false, nullptr, env_variable);
+}
+
+void OptionSchema::add_arg(std::string const &name,
+                           std::string const &description,
+                           std::string const &default_value, bool required,
+                           TypedValuePtr typed_value,
+                           std::string const &env_variable) {
+  copy_mapped_options();
+  std::size_t const position = argOptionList_.size();
+  check_env_variable(env_variable);
+  StringOption option(index_name(name, OptionIndex::Kind::Arg, position),
+                      schemaStrings_.store(description),
+                      schemaStrings_.store(default_value));
+  index_env_variable(env_variable, OptionIndex::Kind::Arg, position);
+  option.set_required(required);
+  argOptionList_.push_back(std::move(option));
+  typedValues_.push_back(std::move(typed_value));
+  listFormats_.push_back(ListFormat{false, '\0'});
+  ++version_;
+}
+
+void OptionSchema::add_list(std::string const &name,
+                            std::string const &description, char delimiter,
+                            std::string const &env_variable) {
+  add_arg(name, description, "", false, nullptr, env_variable);
+  listFormats_.back() = ListFormat{true, delimiter};
+}
+
+void OptionSchema::add_switch(std::string const &name,
+                              std::string const &description,
+                              bool default_setting,
+                              std::string const &env_variable) {
+  copy_mapped_options();
+  std::size_t const position = switchOptionList_.size();
+  check_env_variable(env_variable);
+  switchOptionList_.push_back(
+      BoolOption(index_name(name, OptionIndex::Kind::Switch, position),
+                 schemaStrings_.store(description), default_setting));
+  index_env_variable(env_variable, OptionIndex::Kind::Switch, position);
+  ++version_;
+}
+
+void OptionSchema::check_env_variable(
+    std::string const &env_variable) const {
+  if (env_variable.find('=') != env_variable.npos) {
+    throw BadOption();
+  }
+  if (envIndex_.contains(env_variable)) {
+    throw OptionDefined();
+  }
+}
+
+void OptionSchema::index_env_variable(std::string const &env_variable,
+                                      OptionIndex::Kind kind,
+                                      std::size_t position) {
+  if (env_variable.empty()) {
+    return;
+  }
+  envIndex_.insert(env_variable, kind, position);
+
+  if (envIndex_.size() == 1) {
+    envPrefix_ = env_variable;
+  } else {
+    std::size_t common(0);
+    while (common < envPrefix_.size() && common < env_variable.size()
+           && envPrefix_[common] == env_variable[common]) {
+      ++common;
+    }
+    envPrefix_.resize(common);
+  }
+}
+
+std::shared_ptr<OptionSchema::ConfigValues const>
+OptionSchema::load_environment(
+    std::shared_ptr<ConfigValues const> previous) const {
+  if (envIndex_.size() == 0) {
+    return nullptr;
+  }
+  std::shared_ptr<ConfigValues> env;
+  if (only_owner(previous)) {
+    env = std::const_pointer_cast<ConfigValues>(std::move(previous));
+    env->strings.clear();
+    env->badValues.clear();
+  } else {
+    env = allocate_shared<ConfigValues>(resource_, resource_);
+  }
+  env->argValues.assign(arg_count(), std::string_view());
+  env->argIsSet.assign(arg_count(), false);
+  env->switches.assign(switch_count(), -1);
+
+  for (char **it = environ; *it != nullptr; ++it) {
+    char const *const variable = *it;
+    if (std::strncmp(variable, envPrefix_.data(), envPrefix_.size()) != 0) {
+      continue;
+    }
+    char const *const equals = std::strchr(variable + envPrefix_.size(), '=');
+    if (equals == nullptr) {
+      continue;
+    }
+    OptionIndex::Entry const entry = envIndex_.find(
+        variable, static_cast<std::size_t>(equals - variable));
+    std::string_view const value(equals + 1);
+    if (entry.kind == OptionIndex::Kind::Arg) {
+      env->argValues[entry.position] = env->strings.store(value);
+      env->argIsSet[entry.position] = true;
+    } else if (entry.kind == OptionIndex::Kind::Switch) {
+      try {
+        env->switches[entry.position] = from_string<bool>(value);
+      } catch (BadCast const &) {
+        env->badValues.emplace_back(switch_option(entry.position).name(),
+                                    env->strings.store(value));
+      }
+    }
+  }
+  return env;
+}
+
+std::shared_ptr<OptionSchema::ConfigValues const>
+OptionSchema::load_config_file(std::string const &path) const {
+  MappedFile const file(path);
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  std::shared_ptr<ConfigValues> config = allocate_shared<ConfigValues>(
+      resource_, resource_);
+  config->argValues.resize(arg_count());
+  config->argIsSet.resize(arg_count());
+  config->switches.assign(switch_count(), -1);
+  config->listItems.resize(arg_count());
+
+  auto is_space = [](char c) {
+    return c == ' ' || c == '\t';
+  };
+
+  // Line ends, "\r\n" ones included, are read like in response files.
+  for_each_line(file.contents(), [&](std::string_view line) {
+    while (!line.empty() && is_space(line.front())) {
+      line.remove_prefix(1);
+    }
+    while (!line.empty() && is_space(line.back())) {
+      line.remove_suffix(1);
+    }
+    if (line.empty() || line.front() == '#') {
+      return;
+    }
+
+    std::size_t nameEnd(0);
+    while (nameEnd < line.size() && !is_space(line[nameEnd])
+           && line[nameEnd] != '=') {
+      ++nameEnd;
+    }
+    std::string_view const name = line.substr(0, nameEnd);
+    std::string_view value = line.substr(nameEnd);
+    while (!value.empty() && is_space(value.front())) {
+      value.remove_prefix(1);
+    }
+    if (!value.empty() && value.front() == '=') {
+      value.remove_prefix(1);
+      while (!value.empty() && is_space(value.front())) {
+        value.remove_prefix(1);
+      }
+    }
+
+    // Same lookup as parse(), so unknown names cost nothing more.
+    OptionIndex::Entry const entry = index_.find(name);
+    if (entry.kind == OptionIndex::Kind::None) {
+      return;
+    }
+    if (entry.kind == OptionIndex::Kind::Arg && !value.empty()) {
+      std::string_view const stored = config->strings.store(value);
+      config->argValues[entry.position] = stored;
+      config->argIsSet[entry.position] = true;
+      // Like on the command line, every line of a list option adds items.
+      ListFormat const list = list_format(entry.position);
+      if (list.isList) {
+        ItemList &items = config->listItems[entry.position];
+        for_each_item(stored, list.delimiter, [&items](std::string_view item) {
+          items.push_back(item);
+        });
+      }
+    } else if (entry.kind == OptionIndex::Kind::Switch) {
+      BoolOption const option = switch_option(entry.position);
+      try {
+        config->switches[entry.position] = value.empty()
+                                           ? !option.get_default()
+                                           : from_string<bool>(value);
+      } catch (BadCast const &) {
+        // The file may be unmapped: keep copies.
+        config->badValues.emplace_back(option.name(),
+                                       config->strings.store(value));
+      }
+    } else {
+      config->badValues.emplace_back(arg_option(entry.position).name(),
+                                     std::string_view());
+    }
+  });
+  return config;
+}
+
+std::string_view OptionSchema::index_name(std::string const &name,
+                                          OptionIndex::Kind kind,
+                                          std::size_t position) {
+  std::string_view const niceName = trim_view(name);
+  if (niceName.empty()) {
+    throw BadOption();
+  }
+  if (!index_.insert(niceName, kind, position)) {
+    throw OptionDefined();
+  }
+  if (trie_ != nullptr) {
+    trie_->insert(niceName, kind, position);
+  }
+  return schemaStrings_.store(niceName);
+}
+
+void OptionSchema::set_abbreviations(bool enabled) {
+  if (!enabled) {
+    trie_.reset();
+    return;
+  }
+  if (trie_ != nullptr) {
+    return;
+  }
+  trie_.reset(new OptionTrie(resource_));
+  for (std::size_t i(0); i < arg_count(); ++i) {
+    trie_->insert(arg_option(i).name(), OptionIndex::Kind::Arg, i);
+  }
+  for (std::size_t i(0); i < switch_count(); ++i) {
+    trie_->insert(switch_option(i).name(), OptionIndex::Kind::Switch, i);
+  }
+}
+
+std::string OptionSchema::suggest_option(std::string_view name) const {
+  if (index_.contains(name)) {
+    return std::string();
+  }
+  // Short names only get a typo, longer ones two.
+  std::size_t const bound = name.size() <= 4 ? 1 : 2;
+  std::vector<std::size_t> row;
+  std::string_view best;
+  std::size_t bestDistance = bound + 1;
+  auto const consider = [&](std::string_view candidate) {
+    std::size_t const distance = edit_distance(name, candidate,
+                                               bestDistance - 1, row);
+    if (distance < bestDistance) {
+      best = candidate;
+      bestDistance = distance;
+    }
+  };
+  // Nothing is closer than one typo away.
+  for (std::size_t i(0); i < arg_count() && bestDistance > 1; ++i) {
+    consider(arg_option(i).name());
+  }
+  for (std::size_t i(0); i < switch_count() && bestDistance > 1; ++i) {
+    consider(switch_option(i).name());
+  }
+  return std::string(best);
+}
+
+void OptionSchema::attach_validator(std::string const &arg_name,
+                                    ValidatorFunction validator,
+                                    bool cacheable) {
+  if (!is_arg(arg_name)) {
+    throw UndefinedOption();
+  }
+  if (!validator) {
+    throw BadFunction();
+  }
+
+  ValidatorFunctionMap::iterator it = validatorFunctionMap_.find(arg_name);
+  if (cacheable) {
+    // Results are keyed by the position of the validator in its list.
+    std::size_t const id = it != validatorFunctionMap_.end()
+                           ? it->second.size() : 0;
+    std::shared_ptr<ValidatorCache> const cache = validatorCache_;
+    validator = [cache, id, validator](std::string const &name,
+                                       std::string const &value) {
+      bool passed(false);
+      if (cache->find(id, name, value, passed)) {
+        return passed;
+      }
+      passed = validator(name, value);
+      cache->insert(id, name, value, passed);
+      return passed;
+    };
+  }
+  if (it != validatorFunctionMap_.end()) {
+    it->second.push_back(validator);
+  } else {
+    ValidatorFunctionList list{validator};
+    std::pair<std::string, ValidatorFunctionList> validatorList
+        = std::make_pair(arg_name, list);
+    validatorFunctionMap_.insert(validatorList);
+  }
+}
+
+void OptionSchema::set_validator_cache(std::size_t capacity,
+                                       std::chrono::milliseconds ttl) {
+  validatorCache_->configure(capacity, ttl);
+}
+
+void OptionSchema::invalidate_validator_cache() const {
+  validatorCache_->clear();
+}
+
+void OptionSchema::invalidate_validator_cache(
+    std::string const &opt_name) const {
+  validatorCache_->clear(opt_name);
+}
+
+ValidatorCache::Stats OptionSchema::validator_cache_stats() const {
+  return validatorCache_->stats();
+}
+
+bool OptionSchema::is_switch(std::string_view name) const {
+  return index_.find(name).kind == OptionIndex::Kind::Switch;
+}
+
+OptionIndex::Entry OptionSchema::find_option(std::string_view name) const {
+  OptionIndex::Entry const entry = index_.find(name);
+  if (entry.found() || trie_ == nullptr || name.size() < 2) {
+    return entry;
+  }
+  return trie_->find_prefix(name);
+}
+
+bool OptionSchema::is_arg(std::string_view name) const {
+  return index_.find(name).kind == OptionIndex::Kind::Arg;
+}
+
+bool OptionSchema::is_list(std::string_view name) const {
+  OptionIndex::Entry const entry = index_.find(name);
+  return entry.kind == OptionIndex::Kind::Arg
+         && list_format(entry.position).isList;
+}
+
+std::string_view OptionSchema::nice_program_name(std::string_view argv0) {
+  // Remove everything but the command's name.
+  size_t const pos = argv0.find_last_of("/");
+  if (pos != argv0.npos) {
+    if (pos + 1 < argv0.size()) {
+      return argv0.substr(pos);
+    }
+  }
+  return argv0;
+}
+
+bool OptionSchema::is_response_file(std::string_view arg) const {
+  return arg.size() >= 2 && arg[0] == '@' && !index_.contains(arg);
+}
+
+void OptionSchema::clear_command_line(ConfigValues &command_line) const {
+  command_line.strings.clear();
+  command_line.argValues.assign(arg_count(), std::string_view());
+  command_line.argIsSet.assign(arg_count(), false);
+  command_line.switches.assign(switch_count(), -1);
+  command_line.listItems.resize(arg_count());
+  for (ItemList &items : command_line.listItems) {
+    items.clear();
+  }
+}
+
+void OptionSchema::parse(int argc, char **argv, ParseResult &result,
+                         StringList &left_overs, Problems &problems) const {
+  left_overs.clear();
+  problems = Problems();
+  result.clear();
+  result.schema_ = this;
+  if (argc > 0) {
+    result.programName_ = nice_program_name(argv[0]);
+  }
+
+  ConfigValues commandLine(result.memory_resource());
+  clear_command_line(commandLine);
+  auto const for_each_token = [this, argc, argv](auto const &f) {
+    bool valueNext(false);
+    for (int i(1); i < argc; ++i) {
+      expand_argument(argv[i], valueNext, f);
+    }
+  };
+  parse_tokens(for_each_token, true, commandLine,
+               problems.options_with_no_value,
+               [&left_overs](std::string_view arg) {
+                 left_overs.emplace_back(arg);
+               }, nullptr);
+  merge_values(result, commandLine, true, nullptr, nullptr, nullptr,
+               problems.missing_options, problems.invalid_options, nullptr);
+}
+
+bool OptionSchema::save(std::string const &path) const {
+  std::string strings;
+  std::string args;
+  args.reserve(arg_count() * sizeof(ArgRecord));
+  for (std::size_t i(0); i < arg_count(); ++i) {
+    StringOption const option = arg_option(i);
+    ListFormat const list = list_format(i);
+    ArgRecord record = zeroed<ArgRecord>();
+    record.name = add_string(strings, option.name());
+    record.description = add_string(strings, option.description());
+    record.defaultValue = add_string(strings, option.get_default());
+    record.required = option.is_required();
+    record.isList = list.isList;
+    record.delimiter = list.delimiter;
+    append_record(args, record);
+  }
+  std::string switches;
+  switches.reserve(switch_count() * sizeof(SwitchRecord));
+  for (std::size_t i(0); i < switch_count(); ++i) {
+    BoolOption const option = switch_option(i);
+    SwitchRecord record = zeroed<SwitchRecord>();
+    record.name = add_string(strings, option.name());
+    record.description = add_string(strings, option.description());
+    record.defaultSetting = option.get_default();
+    append_record(switches, record);
+  }
+
+  SchemaHeader header = zeroed<SchemaHeader>();
+  header.envPrefix = add_string(strings, envPrefix_);
+  if (strings.size() > std::numeric_limits<std::uint32_t>::max()) {
+    return false;
+  }
+  std::memcpy(header.magic, SCHEMA_MAGIC, sizeof(SCHEMA_MAGIC));
+  header.version = SCHEMA_VERSION;
+  header.byteOrder = SCHEMA_BYTE_ORDER;
+  header.argCount = static_cast<std::uint32_t>(arg_count());
+  header.switchCount = static_cast<std::uint32_t>(switch_count());
+
+  std::string file(sizeof(SchemaHeader), '\0');
+  header.args = append_section(file, args);
+  header.switches = append_section(file, switches);
+  header.indexSize = index_.size();
+  header.envIndexSize = envIndex_.size();
+  header.index = append_section(file, index_.table_bytes());
+  header.indexNames = append_section(file, index_.name_bytes());
+  header.envIndex = append_section(file, envIndex_.table_bytes());
+  header.envNames = append_section(file, envIndex_.name_bytes());
+  header.strings = append_section(file, strings);
+  header.fileSize = file.size();
+  std::memcpy(&file[0], &header, sizeof(SchemaHeader));
+
+  // Written aside and renamed over path, so that programs which have the
+  // previous file mapped keep it as it was.
+  std::string const temporary = path + ".tmp";
+  std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+  out.write(file.data(), static_cast<std::streamsize>(file.size()));
+  out.close();
+  if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool OptionSchema::load(std::string const &path) {
+  std::unique_ptr<MappedFile const> file(new MappedFile(path));
+  std::string_view const bytes = file->contents();
+  if (!file->is_open() || bytes.size() < sizeof(SchemaHeader)) {
+    return false;
+  }
+  SchemaHeader const header = read_record<SchemaHeader>(bytes, 0);
+  if (std::memcmp(header.magic, SCHEMA_MAGIC, sizeof(SCHEMA_MAGIC)) != 0
+      || header.version != SCHEMA_VERSION
+      || header.byteOrder != SCHEMA_BYTE_ORDER
+      || header.fileSize != bytes.size()) {
+    return false;
+  }
+  std::string_view argRecords, switchRecords, indexTable, indexNames,
+      envTable, envNames, strings, envPrefix;
+  if (!read_section(bytes, header.args, argRecords)
+      || !read_section(bytes, header.switches, switchRecords)
+      || !read_section(bytes, header.index, indexTable)
+      || !read_section(bytes, header.indexNames, indexNames)
+      || !read_section(bytes, header.envIndex, envTable)
+      || !read_section(bytes, header.envNames, envNames)
+      || !read_section(bytes, header.strings, strings)
+      || !read_string(strings, header.envPrefix, envPrefix)
+      || argRecords.size() != header.argCount * sizeof(ArgRecord)
+      || switchRecords.size() != header.switchCount * sizeof(SwitchRecord)) {
+    return false;
+  }
+
+  // Nothing is read one option at a time: options are read from the file
+  // when they are used, and the tables are used in place.
+  OptionIndex index(resource_);
+  OptionIndex envIndex(resource_);
+  if (!index.attach(indexTable, indexNames, header.indexSize,
+                    header.switchCount, header.argCount)
+      || !envIndex.attach(envTable, envNames, header.envIndexSize,
+                          header.switchCount, header.argCount)) {
+    return false;
+  }
+
+  argOptionList_.clear();
+  typedValues_.clear();
+  listFormats_.clear();
+  switchOptionList_.clear();
+  mapped_ = MappedOptions{true, header.argCount, header.switchCount,
+                          argRecords, switchRecords, strings};
+  index_ = std::move(index);
+  envIndex_ = std::move(envIndex);
+  envPrefix_.assign(envPrefix.data(), envPrefix.size());
+  schemaStrings_.clear();
+  schemaFile_ = std::move(file);
+  validatorFunctionMap_.clear();
+  validatorCache_->clear();
+  if (trie_ != nullptr) {
+    trie_.reset();
+    set_abbreviations(true);
+  }
+  ++version_;
+  return true;
+}
+
+OptionSchema::TypedValuePtr const &OptionSchema::typed_value(
+    std::size_t position) const {
+  static TypedValuePtr const none;
+  return position < typedValues_.size() ? typedValues_[position] : none;
+}
+
+// Strings out of the file are read as empty, so that a damaged file can't
+// make anything read outside of it.
+OptionSchema::StringOption OptionSchema::mapped_arg_option(
+    std::size_t position) const {
+  ArgRecord const record = read_record<ArgRecord>(mapped_.argRecords,
+                                                  position);
+  std::string_view name, description, defaultValue;
+  read_string(mapped_.strings, record.name, name);
+  read_string(mapped_.strings, record.description, description);
+  read_string(mapped_.strings, record.defaultValue, defaultValue);
+  StringOption option(name, description, defaultValue);
+  option.set_required(record.required != 0);
+  return option;
+}
+
+OptionSchema::BoolOption OptionSchema::mapped_switch_option(
+    std::size_t position) const {
+  SwitchRecord const record = read_record<SwitchRecord>(
+      mapped_.switchRecords, position);
+  std::string_view name, description;
+  read_string(mapped_.strings, record.name, name);
+  read_string(mapped_.strings, record.description, description);
+  return BoolOption(name, description, record.defaultSetting != 0);
+}
+
+OptionSchema::ListFormat OptionSchema::mapped_list_format(
+    std::size_t position) const {
+  ArgRecord const record = read_record<ArgRecord>(mapped_.argRecords,
+                                                  position);
+  return ListFormat{record.isList != 0, record.delimiter};
+}
+
+std::pmr::memory_resource *OptionSchema::memory_resource() const {
+  return resource_;
+}
+
+std::size_t OptionSchema::retained_bytes() const {
+  std::size_t bytes = argOptionList_.capacity() * sizeof(StringOption)
+                      + typedValues_.capacity() * sizeof(TypedValuePtr)
+                      + listFormats_.capacity() * sizeof(ListFormat)
+                      + switchOptionList_.capacity() * sizeof(BoolOption)
+                      + index_.retained_bytes() + envIndex_.retained_bytes()
+                      + schemaStrings_.capacity() + envPrefix_.capacity();
+  if (trie_ != nullptr) {
+    bytes += trie_->retained_bytes();
+  }
+  // Map nodes are counted by their contents.
+  for (ValidatorFunctionMap::value_type const &entry : validatorFunctionMap_) {
+    bytes += sizeof(entry) + entry.first.capacity()
+             + entry.second.capacity() * sizeof(ValidatorFunction);
+  }
+  return bytes;
+}
+
+std::size_t OptionSchema::mapped_bytes() const {
+  return schemaFile_ != nullptr ? schemaFile_->contents().size() : 0;
+}
+
+std::size_t OptionSchema::retained_bytes(ConfigValues const &values) {
+  std::size_t bytes = values.strings.capacity()
+                      + values.argValues.capacity() * sizeof(std::string_view)
+                      + values.argIsSet.capacity() + values.switches.capacity()
+                      + values.listItems.capacity() * sizeof(ItemList)
+                      + values.badValues.capacity()
+                        * sizeof(std::pair<std::string_view, std::string_view>);
+  for (ItemList const &items : values.listItems) {
+    bytes += items.capacity() * sizeof(std::string_view);
+  }
+  return bytes;
+}
+
+void OptionSchema::copy_mapped_options() {
+  if (!mapped_.active) {
+    return;
+  }
+  argOptionList_.reserve(mapped_.argCount + 1);
+  listFormats_.reserve(mapped_.argCount + 1);
+  for (std::size_t i(0); i < mapped_.argCount; ++i) {
+    argOptionList_.push_back(mapped_arg_option(i));
+    listFormats_.push_back(mapped_list_format(i));
+  }
+  typedValues_.resize(mapped_.argCount);
+  switchOptionList_.reserve(mapped_.switchCount + 1);
+  for (std::size_t i(0); i < mapped_.switchCount; ++i) {
+    switchOptionList_.push_back(mapped_switch_option(i));
+  }
+  mapped_.active = false;
+}
+
+void OptionSchema::merge_values(ParseResult &result,
+                                ConfigValues const &command_line,
+                                bool copy_values, ConfigValues const *env,
+                                ConfigValues const *config,
+                                ValidatorPool const *validators,
+                                StringList &missing_options,
+                                StringList &invalid_options,
+                                ParseStats *stats) const {
+  auto arg_in = [](ConfigValues const *values, std::size_t i) {
+    return values && i < values->argIsSet.size() && values->argIsSet[i];
+  };
+  std::size_t const argCount = arg_count();
+  ValidationList &validations = result.scratch_.validations;
+  ItemList &splitItems = result.scratch_.splitItems;
+  validations.clear();
+  result.values_.resize(argCount);
+  if (result.typedValues_.size() < argCount) {
+    result.typedValues_.resize(argCount);
+  }
+  result.typedCount_ = argCount;
+  result.itemRanges_.resize(argCount);
+  for (std::size_t i(0); i < argCount; ++i) {
+    StringOption const option = arg_option(i);
+    bool isSet(true);
+    bool copy(true);
+    std::string_view value;
+    if (arg_in(&command_line, i)) {
+      value = command_line.argValues[i];
+      copy = copy_values;
+    } else if (arg_in(env, i)) {
+      value = env->argValues[i];
+    } else if (arg_in(config, i)) {
+      value = config->argValues[i];
+    } else {
+      value = option.get_default();
+      isSet = false;
+      copy = false;
+    }
+    result.set_value(i, value, isSet, copy);
+
+    // Every value given on the command line or in the config file, or the
+    // items of the one value of the environment or the default.
+    ListFormat const list = list_format(i);
+    ItemList const *items(nullptr);
+    if (list.isList) {
+      if (arg_in(&command_line, i)) {
+        items = &command_line.listItems[i];
+      } else if (!arg_in(env, i) && arg_in(config, i)
+                 && i < config->listItems.size()) {
+        items = &config->listItems[i];
+      } else {
+        splitItems.clear();
+        for_each_item(value, list.delimiter,
+                      [&splitItems](std::string_view item) {
+                        splitItems.push_back(item);
+                      });
+        items = &splitItems;
+      }
+      result.set_items(i, *items, copy);
+    }
+
+    TypedValuePtr const &typed = typed_value(i);
+    TypedValuePtr &converted = result.typedValues_[i];
+    if (typed == nullptr) {
+      converted = nullptr;
+    } else {
+      // Convert once, so that get_option_as() doesn't have to.
+      if (!isSet) {
+        converted = typed;
+      } else {
+        // A value of the previous parse that only this result holds is
+        // converted again in place; the default is held by the schema too.
+        std::shared_ptr<TypedValue> target;
+        if (only_owner(converted) && converted->type() == typed->type()) {
+          target = std::const_pointer_cast<TypedValue>(std::move(converted));
+        } else {
+          target = typed->make(result.memory_resource());
+        }
+        bool const converts = items != nullptr ? target->assign_items(*items)
+                                               : target->assign(value);
+        converted = converts ? std::move(target) : nullptr;
+      }
+      if (converted == nullptr) {
+        validations.push_back(Validation{i, value, nullptr});
+        continue;
+      }
+    }
+
+    if (!isSet && option.is_required()) {
+      missing_options.emplace_back(option.name());
+    } else if (!validatorFunctionMap_.empty()) {
+      ValidatorFunctionMap::const_iterator it = validatorFunctionMap_.find(
+          option.name());
+      if (it == validatorFunctionMap_.end()) {
+        continue;
+      }
+      if (items == nullptr) {
+        validations.push_back(Validation{i, value, &*it});
+        continue;
+      }
+      // Lists are validated item by item.
+      for (std::string_view item : *items) {
+        validations.push_back(Validation{i, item, &*it});
+      }
+    }
+  }
+  run_validators(validations, validators, result.scratch_.text,
+                 invalid_options, stats);
+
+  std::size_t const switchCount = switch_count();
+  result.switches_.resize(switchCount);
+  auto switch_in = [](ConfigValues const *values, std::size_t i) {
+    return values && i < values->switches.size() && values->switches[i] != -1;
+  };
+  for (std::size_t i(0); i < switchCount; ++i) {
+    if (switch_in(&command_line, i)) {
+      result.switches_[i] = command_line.switches[i];
+    } else if (switch_in(env, i)) {
+      result.switches_[i] = env->switches[i];
+    } else if (switch_in(config, i)) {
+      result.switches_[i] = config->switches[i];
+    } else {
+      result.switches_[i] = switch_option(i).get_default();
+    }
+  }
+}
+
+void OptionSchema::run_validators(ValidationList const &validations,
+                                  ValidatorPool const *validators,
+                                  std::string &text,
+                                  StringList &invalid_options,
+                                  ParseStats *stats) const {
+  StatsTimer const timer(stats, &ParseStats::validator_ns);
+  if (validators == nullptr) {
+    for (Validation const &validation : validations) {
+      if (validation.validators == nullptr) {
+        invalid_options.emplace_back(arg_option(validation.position).name());
+        continue;
+      }
+      std::string const &name = validation.validators->first;
+      text.assign(validation.value);
+      ValidatorFunctionList const &list = validation.validators->second;
+      for (std::size_t v(0); v < list.size(); ++v) {
+        std::uint64_t ns(0);
+        bool valid;
+        {
+          StatsTimer const validatorTimer(stats != nullptr ? &ns : nullptr);
+          valid = list[v](name, text);
+        }
+        if constexpr (STATS_ENABLED) {
+          if (stats != nullptr) {
+            stats->add_validator_call(name, v, ns);
+          }
+        }
+        if (!valid) {
+          invalid_options.push_back(name);
+        }
+      }
+    }
+    return;
+  }
+
+  // Every check owns its copies: an expired one may outlive the parse.
+  ValidatorPool::CheckList checks;
+  for (Validation const &validation : validations) {
+    if (validation.validators == nullptr) {
+      continue;
+    }
+    std::string const &name = validation.validators->first;
+    std::string const value(validation.value);
+    for (ValidatorFunction const &validator : validation.validators->second) {
+      checks.emplace_back([validator, name, value]() {
+        return validator(name, value);
+      });
+    }
+  }
+  std::vector<char> passed;
+  std::vector<std::uint64_t> nanoseconds;
+  bool const timed = STATS_ENABLED && stats != nullptr;
+  validators->run(std::move(checks), passed, timed ? &nanoseconds : nullptr);
+
+  // Same order as one after another.
+  std::size_t check(0);
+  for (Validation const &validation : validations) {
+    std::string_view const name = arg_option(validation.position).name();
+    if (validation.validators == nullptr) {
+      invalid_options.emplace_back(name);
+      continue;
+    }
+    for (std::size_t v(0); v < validation.validators->second.size(); ++v) {
+      if (timed) {
+        stats->add_validator_call(validation.validators->first, v,
+                                  nanoseconds[check]);
+      }
+      if (!passed[check++]) {
+        invalid_options.emplace_back(name);
+      }
+    }
+  }
+}
+
+}
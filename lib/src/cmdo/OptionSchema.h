@@ -0,0 +1,859 @@
+#ifndef CMDO_OPTIONSCHEMA_H
+#define CMDO_OPTIONSCHEMA_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <map>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include "cmdo/MappedFile.h"
+#include "cmdo/OptionIndex.h"
+#include "cmdo/OptionTrie.h"
+#include "cmdo/ParseStats.h"
+#include "cmdo/ResponseFile.h"
+#include "cmdo/StringArena.h"
+#include "cmdo/StringUtil.h"
+#include "cmdo/ValidatorCache.h"
+#include "cmdo/ValidatorPool.h"
+
+namespace cmdo {
+
+struct BadFunction : public std::exception {
+
+};
+
+struct OptionNotSet : public std::exception {
+
+};
+
+struct UndefinedOption : public std::exception {
+
+};
+
+struct OptionDefined : public std::exception {
+
+};
+
+struct BadOption : public std::exception {
+
+};
+
+class ParseResult;
+
+/**
+ * @brief The options of a program: names, descriptions, defaults, types,
+ * validators and environment variables, but no values.
+ *
+ * A schema is built once. Then any number of threads can parse() against it
+ * at the same time, each one into its own ParseResult. CmdLineOptions owns a
+ * schema, and adds the environment, config files and published snapshots.
+ *
+ * Options, their strings and their lookup tables are allocated from a
+ * memory resource, for instance a std::pmr::monotonic_buffer_resource that
+ * frees the whole schema at once. Validators are std::function objects,
+ * which allocate on their own.
+ */
+class OptionSchema {
+public:
+  /**
+   * @see CmdLineOptions::ValidatorFunction
+   */
+  typedef std::function<bool(std::string const &, std::string const &)>
+      ValidatorFunction;
+  typedef std::vector<std::string> StringList;
+
+  /**
+   * @brief Problems found by parse(): the lists given to the
+   * ParserResultHandler of CmdLineOptions, but the left overs.
+   */
+  struct Problems {
+    StringList missing_options;
+    StringList options_with_no_value;
+    StringList invalid_options;
+  };
+
+  /**
+   * @param[in] resource Allocates the options. It must outlive the schema,
+   * and be thread safe if options are added by several threads.
+   */
+  explicit OptionSchema(std::pmr::memory_resource *resource
+                        = std::pmr::get_default_resource());
+
+  OptionSchema(OptionSchema const &) = delete;
+
+  OptionSchema &operator=(OptionSchema const &) = delete;
+
+  /**
+   * @brief Same as CmdLineOptions::add_required.
+   */
+  void add_required(std::string const &name, std::string const &description,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::add_optional.
+   */
+  void add_optional(std::string const &name, std::string const &description,
+                    std::string const &default_value,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::add_required<T>.
+   */
+  template<typename T>
+  void add_required(std::string const &name, std::string const &description,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::add_optional<T>.
+   */
+  template<typename T, typename = typename std::enable_if<
+      !std::is_convertible<T, std::string>::value>::type>
+  void add_optional(std::string const &name, std::string const &description,
+                    T const &default_value,
+                    std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::add_list.
+   */
+  void add_list(std::string const &name, std::string const &description,
+                char delimiter = '\0',
+                std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::add_list<T>.
+   */
+  template<typename T>
+  void add_list(std::string const &name, std::string const &description,
+                char delimiter = '\0',
+                std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::add_switch.
+   */
+  void add_switch(std::string const &name, std::string const &description,
+                  bool default_setting,
+                  std::string const &env_variable = std::string());
+
+  /**
+   * @brief Same as CmdLineOptions::attach_validator.
+   */
+  void attach_validator(std::string const &opt_name,
+                        ValidatorFunction validator, bool cacheable = false);
+
+  /**
+   * @brief Same as CmdLineOptions::set_validator_cache.
+   */
+  void set_validator_cache(std::size_t capacity,
+                           std::chrono::milliseconds ttl
+                           = std::chrono::milliseconds::zero());
+
+  /**
+   * @brief Same as CmdLineOptions::invalidate_validator_cache.
+   */
+  void invalidate_validator_cache() const;
+
+  /**
+   * @brief Same as CmdLineOptions::invalidate_validator_cache.
+   */
+  void invalidate_validator_cache(std::string const &opt_name) const;
+
+  /**
+   * @brief Same as CmdLineOptions::validator_cache_stats.
+   */
+  ValidatorCache::Stats validator_cache_stats() const;
+
+  /**
+   * @brief Same as CmdLineOptions::set_abbreviations.
+   */
+  void set_abbreviations(bool enabled);
+
+  /**
+   * @brief Same as CmdLineOptions::suggest_option.
+   */
+  std::string suggest_option(std::string_view name) const;
+
+  /**
+   * @brief Looks up the option called name or, if abbreviations are
+   * enabled, the only one name is a prefix of.
+   */
+  OptionIndex::Entry find_option(std::string_view name) const;
+
+  bool is_arg(std::string_view name) const;
+
+  bool is_switch(std::string_view name) const;
+
+  bool is_list(std::string_view name) const;
+
+  /**
+   * @brief Parses argv into result, which then refers to this schema.
+   * @files are expanded, but only the command line and the defaults are
+   * used: environment variables and config files are read by
+   * CmdLineOptions.
+   *
+   * The schema is not changed, so any number of threads can parse at once
+   * while no option is being added. Validators are then called concurrently.
+   * @param[in] argc Number of command line argments
+   * @param[in] argv Command line arguments
+   * @param[out] result The values. Its memory is reused.
+   * @param[out] left_overs Things in the command line that were not defined
+   * as options, in the same order they appear in the command line.
+   * @param[out] problems Missing, valueless and invalid options.
+   */
+  void parse(int argc, char **argv, ParseResult &result,
+             StringList &left_overs, Problems &problems) const;
+
+  /**
+   * @brief Same as CmdLineOptions::save_schema.
+   */
+  bool save(std::string const &path) const;
+
+  /**
+   * @brief Same as CmdLineOptions::load_schema.
+   */
+  bool load(std::string const &path);
+
+  /**
+   * @brief The memory resource the options are allocated from.
+   */
+  std::pmr::memory_resource *memory_resource() const;
+
+  /**
+   * @brief Bytes allocated for the options: names, descriptions, defaults,
+   * indexes and validators. A loaded schema file is not counted.
+   */
+  std::size_t retained_bytes() const;
+
+  /**
+   * @brief Size of the schema file loaded by load(), 0 if none is used.
+   */
+  std::size_t mapped_bytes() const;
+
+private:
+  friend class CmdLineOptions;
+  friend class ParseResult;
+
+  /**
+   * @brief Name and description are views, into schemaStrings_ or into a
+   * loaded schema file.
+   */
+  template<typename T>
+  class Option {
+  public:
+    Option(std::string_view name, std::string_view description,
+           T const &default_value);
+
+    std::string_view name() const;
+
+    std::string_view description() const;
+
+    /**
+     * @brief Returns the default value specified in the constructor.
+     */
+    T const &get_default() const;
+
+    /**
+     * @brief Returns true if this option is required.
+     */
+    bool is_required() const;
+
+    void set_required(bool const &required);
+
+  private:
+    std::string_view name_;
+    std::string_view description_;
+    bool isRequired_;
+    T defaultValue_;
+  };
+
+  /**
+   * @brief Items of a list option.
+   */
+  typedef std::pmr::vector<std::string_view> ItemList;
+
+  /**
+   * @brief A new T made with args, allocated from resource.
+   */
+  template<typename T, typename... Args>
+  static std::shared_ptr<T> allocate_shared(
+      std::pmr::memory_resource *resource, Args &&... args) {
+    return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource),
+                                   std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Whether ptr holds the only reference to its object, which can then
+   * be written to. use_count() is a relaxed load: the fence orders it after
+   * the release of the other references (an acq_rel decrement in libstdc++
+   * and libc++), so that what their owners did with the object happens
+   * before the caller's writes.
+   */
+  template<typename T>
+  static bool only_owner(std::shared_ptr<T> const &ptr) {
+    if (ptr.use_count() != 1) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+  }
+
+  /**
+   * @brief Converted value of an argument option defined with a type. The
+   * one stored with the option holds the default value.
+   */
+  class TypedValue {
+  public:
+    virtual ~TypedValue() = default;
+
+    /**
+     * @brief Returns a new value of the same type, allocated from resource,
+     * to assign() to.
+     */
+    virtual std::shared_ptr<TypedValue> make(
+        std::pmr::memory_resource *resource) const = 0;
+
+    /**
+     * @brief Converts text into this value. Returns false if it can't be
+     * converted, and the value is then unspecified.
+     */
+    virtual bool assign(std::string_view text) = 0;
+
+    /**
+     * @brief Converts every item of a list option into this value, like
+     * assign(). Only lists have items.
+     */
+    virtual bool assign_items(ItemList const &) {
+      return false;
+    }
+
+    virtual std::type_info const &type() const = 0;
+  };
+
+  template<typename T>
+  class TypedValueOf : public TypedValue {
+  public:
+    explicit TypedValueOf(T const &value)
+        : value_(value) {
+    }
+
+    std::shared_ptr<TypedValue> make(
+        std::pmr::memory_resource *resource) const override {
+      return allocate_shared<TypedValueOf<T>>(resource, T());
+    }
+
+    bool assign(std::string_view text) override {
+      try {
+        value_ = from_string<T>(text);
+        return true;
+      } catch (BadCast const &) {
+        return false;
+      }
+    }
+
+    std::type_info const &type() const override {
+      return typeid(T);
+    }
+
+    T const &get() const {
+      return value_;
+    }
+
+  private:
+    T value_;
+  };
+
+  /**
+   * @brief Converted items of a list option defined with a type, held in
+   * one vector. The one stored with the option is empty.
+   */
+  template<typename T>
+  class TypedListOf : public TypedValue {
+  public:
+    TypedListOf()
+        : values_() {
+    }
+
+    std::shared_ptr<TypedValue> make(
+        std::pmr::memory_resource *resource) const override {
+      return allocate_shared<TypedListOf<T>>(resource);
+    }
+
+    /**
+     * @brief A list of the one item text.
+     */
+    bool assign(std::string_view text) override {
+      values_.clear();
+      try {
+        values_.push_back(from_string<T>(text));
+      } catch (BadCast const &) {
+        return false;
+      }
+      return true;
+    }
+
+    bool assign_items(ItemList const &items) override {
+      // Keeps the capacity of the previous items.
+      values_.clear();
+      try {
+        for (std::string_view item : items) {
+          values_.push_back(from_string<T>(item));
+        }
+      } catch (BadCast const &) {
+        return false;
+      }
+      return true;
+    }
+
+    std::type_info const &type() const override {
+      return typeid(std::vector<T>);
+    }
+
+    std::vector<T> const &get() const {
+      return values_;
+    }
+
+  private:
+    std::vector<T> values_;
+  };
+
+  typedef std::shared_ptr<TypedValue const> TypedValuePtr;
+  typedef std::vector<std::unique_ptr<ResponseFile>> ResponseFileList;
+
+  /**
+   * @brief Option values read from the command line, a config file or the
+   * environment, by option position.
+   */
+  struct ConfigValues {
+    explicit ConfigValues(std::pmr::memory_resource *resource
+                          = std::pmr::get_default_resource())
+        : strings(4096, resource), argValues(resource), argIsSet(resource),
+          switches(resource), listItems(resource), badValues(resource) {
+    }
+
+    // Values of defined options, copied out of argv, out of the mapped file
+    // (which may be rewritten in place at any time) or out of environ.
+    StringArena strings;
+    std::pmr::vector<std::string_view> argValues;
+    std::pmr::vector<char> argIsSet;
+    // -1 if not given, else the state of the switch.
+    std::pmr::vector<signed char> switches;
+    // Every item given to each list option, empty for the other options.
+    std::pmr::vector<ItemList> listItems;
+    // Options given a value that is not one: switches given something else
+    // than true/yes/false/no, and arguments given nothing. The name of the
+    // option, and the text it was given.
+    std::pmr::vector<std::pair<std::string_view, std::string_view>> badValues;
+  };
+
+  /**
+   * @brief Whether an argument option is a list, and what separates the
+   * items of one value. '\0' for lists that are only repeated.
+   */
+  struct ListFormat {
+    bool isList;
+    char delimiter;
+  };
+
+  typedef Option<std::string_view> StringOption;
+  typedef std::pmr::vector<StringOption> ArgOptList;
+  typedef Option<bool> BoolOption;
+  typedef std::pmr::vector<BoolOption> SwitchOptList;
+  typedef std::vector<ValidatorFunction> ValidatorFunctionList;
+  typedef std::map<std::string, ValidatorFunctionList, std::less<>>
+      ValidatorFunctionMap;
+
+  /**
+   * @brief Where the options of a schema file loaded by load() are, while
+   * they are read from the file in place.
+   */
+  struct MappedOptions {
+    bool active;
+    std::size_t argCount;
+    std::size_t switchCount;
+    std::string_view argRecords;
+    std::string_view switchRecords;
+    std::string_view strings;
+  };
+
+  std::size_t arg_count() const {
+    return mapped_.active ? mapped_.argCount : argOptionList_.size();
+  }
+
+  std::size_t switch_count() const {
+    return mapped_.active ? mapped_.switchCount : switchOptionList_.size();
+  }
+
+  StringOption arg_option(std::size_t position) const {
+    return mapped_.active ? mapped_arg_option(position)
+                          : argOptionList_[position];
+  }
+
+  BoolOption switch_option(std::size_t position) const {
+    return mapped_.active ? mapped_switch_option(position)
+                          : switchOptionList_[position];
+  }
+
+  ListFormat list_format(std::size_t position) const {
+    return mapped_.active ? mapped_list_format(position)
+                          : listFormats_[position];
+  }
+
+  /**
+   * @brief The default value of the argument option at position, if it has
+   * a type, else null.
+   */
+  TypedValuePtr const &typed_value(std::size_t position) const;
+
+  StringOption mapped_arg_option(std::size_t position) const;
+
+  BoolOption mapped_switch_option(std::size_t position) const;
+
+  ListFormat mapped_list_format(std::size_t position) const;
+
+  /**
+   * @brief Copies the options read in place from a schema file into the
+   * option lists, before one is added. Their strings stay in the file.
+   */
+  void copy_mapped_options();
+
+  /**
+   * @brief Trims the name, registers it in the index and returns it as
+   * stored in schemaStrings_.
+   * @throws OptionDefined
+   *   If the name is already used by another option.
+   */
+  std::string_view index_name(std::string const &name,
+                              OptionIndex::Kind kind, std::size_t position);
+
+  /**
+   * @brief Defines an argument option. typed_value is null for options
+   * without a type.
+   */
+  void add_arg(std::string const &name, std::string const &description,
+               std::string const &default_value, bool required,
+               TypedValuePtr typed_value, std::string const &env_variable);
+
+  /**
+   * @brief Checks that env_variable can be bound, before anything is
+   * registered for the option.
+   * @throws BadOption
+   *   If env_variable has a '='.
+   * @throws OptionDefined
+   *   If env_variable is already bound.
+   */
+  void check_env_variable(std::string const &env_variable) const;
+
+  /**
+   * @brief Binds an environment variable to an option, if env_variable is
+   * not empty.
+   */
+  void index_env_variable(std::string const &env_variable,
+                          OptionIndex::Kind kind, std::size_t position);
+
+  /**
+   * @brief Reads the bound environment variables, in one pass over environ.
+   * Returns null if no variable is bound. Bad switch values are listed in
+   * badValues. previous, the result of the last call, is filled again
+   * instead of allocating a new one if nobody else holds it.
+   */
+  std::shared_ptr<ConfigValues const> load_environment(
+      std::shared_ptr<ConfigValues const> previous = nullptr) const;
+
+  /**
+   * @brief Reads a config file. Options with bad values are left unset, and
+   * listed in badValues.
+   * @returns null if the file can't be read.
+   */
+  std::shared_ptr<ConfigValues const> load_config_file(
+      std::string const &path) const;
+
+  static std::string_view nice_program_name(std::string_view argv0);
+
+  /**
+   * @brief True if arg names a response file: "@path", and not an option.
+   */
+  bool is_response_file(std::string_view arg) const;
+
+  /**
+   * @brief Sizes command_line for the defined options, with no value set.
+   */
+  void clear_command_line(ConfigValues &command_line) const;
+
+  /**
+   * @brief Calls f with arg or, if arg is a response file, with every line
+   * of the file, which is unmapped once read. Like GCC, a file that can't be
+   * read is passed on as is, and the value of an option is never read as a
+   * file.
+   * @param[in,out] value_next Whether arg is the value of an option. Set to
+   * what f returns for the last token, which is whether the token after it
+   * is a value, like the function parse_tokens() passes to for_each_token.
+   * False before the first argument.
+   */
+  template<typename Function>
+  void expand_argument(std::string_view arg, bool &value_next,
+                       Function const &f) const;
+
+  /**
+   * @brief True if the token after token is the value of an argument option,
+   * as parse_tokens() reads them. is_value tells if token itself is one.
+   */
+  bool next_is_value(std::string_view token, bool is_value) const {
+    return !is_value && find_option(token).kind == OptionIndex::Kind::Arg;
+  }
+
+  /**
+   * @brief The loop shared by every parse() version. for_each_token(f) must
+   * call f with every token in order; f returns true if the next token is
+   * the value of an option. Values are set in command_line, and
+   * copied into its strings if copy_values is true, else they are views
+   * into the tokens. Tokens that are not options are passed to left_over.
+   * The loop is timed and counted in stats, if it is not null.
+   */
+  template<typename TokenSource, typename LeftOverFunction>
+  void parse_tokens(TokenSource const &for_each_token, bool copy_values,
+                    ConfigValues &command_line,
+                    StringList &options_with_no_value,
+                    LeftOverFunction const &left_over,
+                    ParseStats *stats) const;
+
+  /**
+   * @brief Fills result with the values of command_line, env, config and
+   * the defaults, in that order of precedence; env and config may be null.
+   * Typed values are converted and validators are run, on validators if it
+   * is not null. Values of command_line are copied into result if
+   * copy_values is true, else result keeps views into the tokens. The
+   * memory of the previous values of result is reused, and the rest comes
+   * from its memory resource. Validators are timed in stats, if it is not
+   * null.
+   */
+  void merge_values(ParseResult &result, ConfigValues const &command_line,
+                    bool copy_values, ConfigValues const *env,
+                    ConfigValues const *config,
+                    ValidatorPool const *validators,
+                    StringList &missing_options,
+                    StringList &invalid_options, ParseStats *stats) const;
+
+  /**
+   * @brief An argument option to validate: with its name and validators, or
+   * null if its value could not be converted to its type.
+   */
+  struct Validation {
+    std::size_t position;
+    std::string_view value;
+    ValidatorFunctionMap::value_type const *validators;
+  };
+
+  typedef std::pmr::vector<Validation> ValidationList;
+
+  /**
+   * @brief Buffers of merge_values(), kept by a ParseResult so that parsing
+   * into it again allocates nothing. Copies of the result get their own.
+   */
+  struct MergeScratch {
+    explicit MergeScratch(std::pmr::memory_resource *resource
+                          = std::pmr::get_default_resource())
+        : validations(resource), splitItems(resource), text() {
+    }
+
+    MergeScratch(MergeScratch const &)
+        : MergeScratch() {
+    }
+
+    MergeScratch &operator=(MergeScratch const &) {
+      return *this;
+    }
+
+    ValidationList validations;
+    // Items of a list given as one value, split again.
+    ItemList splitItems;
+    // The value given to validators, which take a std::string.
+    std::string text;
+  };
+
+  /**
+   * @brief Runs the validators of validations, one after another or on
+   * validators if it is not null, and adds the options that failed to
+   * invalid_options, in the order of validations either way. Values are
+   * copied into text for validators run one after another. They are timed
+   * in stats, if it is not null: one by one only if run one after another.
+   */
+  void run_validators(ValidationList const &validations,
+                      ValidatorPool const *validators, std::string &text,
+                      StringList &invalid_options, ParseStats *stats) const;
+
+  /**
+   * @brief Bytes allocated for values.
+   */
+  static std::size_t retained_bytes(ConfigValues const &values);
+
+  // Allocates everything below but the validators and the schema file.
+  std::pmr::memory_resource *resource_;
+  ArgOptList argOptionList_;
+  // One per argument option, null if the option has no type.
+  std::pmr::vector<TypedValuePtr> typedValues_;
+  // One per argument option.
+  std::pmr::vector<ListFormat> listFormats_;
+  SwitchOptList switchOptionList_;
+  // Shared by parse() and every lookup by name.
+  OptionIndex index_;
+  // Names by prefix, only while abbreviations are enabled.
+  std::unique_ptr<OptionTrie> trie_;
+  // Names, descriptions and default values of the options added.
+  StringArena schemaStrings_;
+  // The schema file loaded by load(), whose strings the options point into.
+  std::unique_ptr<MappedFile const> schemaFile_;
+  // Options read from schemaFile_ in place instead of the lists above,
+  // until an option is added.
+  MappedOptions mapped_;
+  ValidatorFunctionMap validatorFunctionMap_;
+  // Shared with the cacheable validators, which use it.
+  std::shared_ptr<ValidatorCache> validatorCache_;
+  // Environment variable names, bound to the options.
+  OptionIndex envIndex_;
+  // Common prefix of every bound variable, to skip most of environ quickly.
+  std::pmr::string envPrefix_;
+  // Incremented by every option added, to know when a usage is outdated.
+  std::size_t version_;
+};
+
+template<typename T>
+void OptionSchema::add_required(std::string const &name,
+                                std::string const &description,
+                                std::string const &env_variable) {
+  add_arg(name, description, "", true,
+          allocate_shared<TypedValueOf<T>>(resource_, T()), env_variable);
+}
+
+template<typename T, typename>
+void OptionSchema::add_optional(std::string const &name,
+                                std::string const &description,
+                                T const &default_value,
+                                std::string const &env_variable) {
+  add_arg(name, description, to_string(default_value), false,
+          allocate_shared<TypedValueOf<T>>(resource_, default_value),
+          env_variable);
+}
+
+template<typename T>
+void OptionSchema::add_list(std::string const &name,
+                            std::string const &description, char delimiter,
+                            std::string const &env_variable) {
+  add_arg(name, description, "", false,
+          allocate_shared<TypedListOf<T>>(resource_), env_variable);
+  listFormats_.back() = ListFormat{true, delimiter};
+}
+
+template<typename Function>
+void OptionSchema::expand_argument(std::string_view arg, bool &value_next,
+                                   Function const &f) const {
+  if (!value_next && is_response_file(arg)) {
+    ResponseFile const file{std::string(arg.substr(1))};
+    if (file.is_open()) {
+      file.for_each_token([&value_next, &f](std::string_view token) {
+        value_next = f(token);
+      });
+      return;
+    }
+  }
+  value_next = f(arg);
+}
+
+template<typename TokenSource, typename LeftOverFunction>
+void OptionSchema::parse_tokens(TokenSource const &for_each_token,
+                                bool copy_values,
+                                ConfigValues &command_line,
+                                StringList &options_with_no_value,
+                                LeftOverFunction const &left_over,
+                                ParseStats *stats) const {
+  StatsTimer const timer(stats, &ParseStats::loop_ns);
+  // The argument option waiting for its value, which is the next token
+  // whatever it is.
+  bool waiting(false);
+  std::size_t waitingPosition(0);
+  std::string_view waitingName;
+  for_each_token([&](std::string_view arg) -> bool {
+    count_stat(stats, &ParseStats::tokens);
+    if (waiting) {
+      std::string_view const value = copy_values
+                                     ? command_line.strings.store(arg) : arg;
+      command_line.argValues[waitingPosition] = value;
+      command_line.argIsSet[waitingPosition] = true;
+      ListFormat const list = list_format(waitingPosition);
+      if (list.isList) {
+        ItemList &items = command_line.listItems[waitingPosition];
+        for_each_item(value, list.delimiter, [&items](std::string_view item) {
+          items.push_back(item);
+        });
+      }
+      waiting = false;
+      return false;
+    }
+
+    count_stat(stats, &ParseStats::lookups);
+    OptionIndex::Entry const entry = find_option(arg);
+    if (entry.kind == OptionIndex::Kind::Switch) {
+      command_line.switches[entry.position] =
+          !switch_option(entry.position).get_default();
+      return false;
+    }
+    if (entry.kind == OptionIndex::Kind::Arg) {
+      waiting = true;
+      waitingPosition = entry.position;
+      waitingName = arg_option(entry.position).name();
+      return true;
+    }
+
+    // not an option :/
+    left_over(arg);
+    return false;
+  });
+  if (waiting) {
+    options_with_no_value.emplace_back(waitingName);
+  }
+}
+
+template<typename T>
+OptionSchema::Option<T>::Option(std::string_view name,
+                                std::string_view description,
+                                T const &default_value)
+    : name_(name), description_(description), isRequired_(false),
+      defaultValue_(default_value) {
+  if (name_.empty()) {
+    throw BadOption();
+  }
+}
+
+template<typename T>
+std::string_view OptionSchema::Option<T>::name() const {
+  return name_;
+}
+
+template<typename T>
+std::string_view OptionSchema::Option<T>::description() const {
+  return description_;
+}
+
+template<typename T>
+bool OptionSchema::Option<T>::is_required() const {
+  return isRequired_;
+}
+
+template<typename T>
+void OptionSchema::Option<T>::set_required(bool const &required) {
+  isRequired_ = required;
+}
+
+template<typename T>
+T const &OptionSchema::Option<T>::get_default() const {
+  return defaultValue_;
+}
+
+}
+
+#endif //CMDO_OPTIONSCHEMA_H
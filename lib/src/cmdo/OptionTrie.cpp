@@ -0,0 +1,62 @@
+#include "cmdo/OptionTrie.h"
+
+namespace cmdo {
+
+OptionTrie::OptionTrie(std::pmr::memory_resource *resource)
+    : nodes_(resource) {
+  clear();
+}
+
+void OptionTrie::insert(std::string_view name, OptionIndex::Kind kind,
+                        std::size_t position) {
+  OptionIndex::Entry const entry{kind, position};
+  std::uint32_t node(0);
+  ++nodes_[node].count;
+  nodes_[node].only = entry;
+  for (char const c : name) {
+    std::uint32_t next = child(node, c);
+    if (next == NO_NODE) {
+      next = static_cast<std::uint32_t>(nodes_.size());
+      nodes_.push_back(Node{NO_NODE, nodes_[node].firstChild, 0, c,
+                            OptionIndex::Entry{OptionIndex::Kind::None, 0}});
+      nodes_[node].firstChild = next;
+    }
+    node = next;
+    ++nodes_[node].count;
+    nodes_[node].only = entry;
+  }
+}
+
+OptionIndex::Entry OptionTrie::find_prefix(std::string_view prefix) const {
+  std::uint32_t node(0);
+  for (char const c : prefix) {
+    node = child(node, c);
+    if (node == NO_NODE) {
+      return OptionIndex::Entry{OptionIndex::Kind::None, 0};
+    }
+  }
+  if (nodes_[node].count != 1) {
+    return OptionIndex::Entry{OptionIndex::Kind::None, 0};
+  }
+  return nodes_[node].only;
+}
+
+void OptionTrie::clear() {
+  nodes_.clear();
+  nodes_.push_back(Node{NO_NODE, NO_NODE, 0, '\0',
+                        OptionIndex::Entry{OptionIndex::Kind::None, 0}});
+}
+
+std::size_t OptionTrie::retained_bytes() const {
+  return nodes_.capacity() * sizeof(Node);
+}
+
+std::uint32_t OptionTrie::child(std::uint32_t node, char c) const {
+  std::uint32_t next = nodes_[node].firstChild;
+  while (next != NO_NODE && nodes_[next].c != c) {
+    next = nodes_[next].nextSibling;
+  }
+  return next;
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef CMDO_OPTIONTRIE_H
+#define CMDO_OPTIONTRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "cmdo/OptionIndex.h"
+
+namespace cmdo {
+
+/**
+ * @brief Finds the option a unique prefix of its name stands for, like GNU
+ * getopt_long does: "-thr" is "-threads" if no other option starts with
+ * "-thr".
+ *
+ * Nodes are kept in one vector, each with the number of names below it, so
+ * a lookup walks the prefix once and never depends on the number of
+ * options.
+ */
+class OptionTrie {
+public:
+  explicit OptionTrie(std::pmr::memory_resource *resource
+                      = std::pmr::get_default_resource());
+
+  void insert(std::string_view name, OptionIndex::Kind kind,
+              std::size_t position);
+
+  /**
+   * @brief Looks up the only name that starts with prefix. Returns an entry
+   * with Kind::None if no name or several names start with prefix.
+   */
+  OptionIndex::Entry find_prefix(std::string_view prefix) const;
+
+  void clear();
+
+  /**
+   * @brief Bytes allocated for the nodes.
+   */
+  std::size_t retained_bytes() const;
+
+private:
+  static std::uint32_t const NO_NODE = UINT32_MAX;
+
+  struct Node {
+    std::uint32_t firstChild;
+    std::uint32_t nextSibling;
+    // Names that go through this node.
+    std::uint32_t count;
+    char c;
+    // The name below this node, when count is 1.
+    OptionIndex::Entry only;
+  };
+
+  std::uint32_t child(std::uint32_t node, char c) const;
+
+  std::pmr::vector<Node> nodes_;
+};
+
+}
+
+#endif //CMDO_OPTIONTRIE_H
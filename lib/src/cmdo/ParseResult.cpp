@@ -0,0 +1,171 @@
+#include "cmdo/ParseResult.h"
+
+namespace cmdo {
+
+ParseResult::ParseResult(OptionSchema const &schema,
+                         std::pmr::memory_resource *resource)
+    : schema_(&schema), programName_(resource), values_(resource),
+      typedValues_(resource), typedCount_(0), switches_(resource),
+      items_(resource), itemRanges_(resource), strings_(resource),
+      responseFiles_(), scratch_(resource) {
+}
+
+OptionSchema const &ParseResult::schema() const {
+  return *schema_;
+}
+
+std::pmr::memory_resource *ParseResult::memory_resource() const {
+  return values_.get_allocator().resource();
+}
+
+std::string ParseResult::program_name() const {
+  return std::string(programName_);
+}
+
+std::string ParseResult::get_option(std::string const &name) const {
+  return std::string(get_option_view(name));
+}
+
+std::string_view ParseResult::get_option_view(std::string_view name) const {
+  OptionIndex::Entry const entry = schema_->index_.find(name);
+  if (entry.kind == OptionIndex::Kind::Arg) {
+    return value_at(entry.position);
+  }
+  throw UndefinedOption();
+}
+
+bool ParseResult::get_switch(std::string const &switch_name) const {
+  OptionIndex::Entry const entry = schema_->index_.find(switch_name);
+  if (entry.kind == OptionIndex::Kind::Switch) {
+    return switch_at(entry.position);
+  }
+  return false;
+}
+
+std::vector<std::string> ParseResult::get_list(std::string const &name) const {
+  ItemRange const range = find_list(name).second;
+  std::vector<std::string> values;
+  values.reserve(range.count);
+  for (std::uint32_t i(0); i < range.count; ++i) {
+    values.emplace_back(item_at(range.begin + i));
+  }
+  return values;
+}
+
+void ParseResult::clear() {
+  programName_.clear();
+  values_.clear();
+  // The values are kept for merge_values() to convert into.
+  typedCount_ = 0;
+  switches_.clear();
+  items_.clear();
+  itemRanges_.clear();
+  strings_.clear();
+  responseFiles_.reset();
+}
+
+std::size_t ParseResult::retained_bytes() const {
+  return programName_.capacity() + values_.capacity() * sizeof(Value)
+         + typedValues_.capacity() * sizeof(OptionSchema::TypedValuePtr)
+         + switches_.capacity() + items_.capacity() * sizeof(Value)
+         + itemRanges_.capacity() * sizeof(ItemRange) + strings_.capacity();
+}
+
+ParseResult::Value ParseResult::store(std::string_view value, bool is_set,
+                                      bool copy) {
+  Value v;
+  v.length = static_cast<std::uint32_t>(value.size());
+  v.isSet = is_set;
+  if (copy) {
+    // An offset, so that copies of this result point into their own buffer.
+    v.data = nullptr;
+    v.offset = static_cast<std::uint32_t>(strings_.size());
+    strings_.append(value);
+  } else {
+    v.data = value.data();
+    v.offset = 0;
+  }
+  return v;
+}
+
+void ParseResult::set_value(std::size_t position, std::string_view value,
+                            bool is_set, bool copy) {
+  values_[position] = store(value, is_set, copy);
+}
+
+void ParseResult::set_items(std::size_t position,
+                            OptionSchema::ItemList const &items, bool copy) {
+  itemRanges_[position] = ItemRange{static_cast<std::uint32_t>(items_.size()),
+                                    static_cast<std::uint32_t>(items.size())};
+  for (std::string_view item : items) {
+    items_.push_back(store(item, true, copy));
+  }
+}
+
+std::pair<std::size_t, ParseResult::ItemRange> ParseResult::find_list(
+    std::string const &name) const {
+  OptionIndex::Entry const entry = schema_->index_.find(name);
+  if (entry.kind != OptionIndex::Kind::Arg
+      || !schema_->list_format(entry.position).isList) {
+    throw UndefinedOption();
+  }
+  if (entry.position < itemRanges_.size()) {
+    return std::make_pair(entry.position, itemRanges_[entry.position]);
+  }
+  return std::make_pair(entry.position, ItemRange{0, 0});
+}
+
+std::string_view ParseResult::item_at(std::size_t index) const {
+  Value const &item = items_[index];
+  char const *const data = item.data != nullptr
+                           ? item.data : strings_.data() + item.offset;
+  return std::string_view(data, item.length);
+}
+
+std::string_view ParseResult::value_at(std::size_t position) const {
+  if (position < values_.size()) {
+    Value const &value = values_[position];
+    if (!value.isSet && schema_->arg_option(position).is_required()) {
+      throw OptionNotSet();
+    }
+    char const *const data = value.data != nullptr
+                             ? value.data : strings_.data() + value.offset;
+    return std::string_view(data, value.length);
+  }
+  OptionSchema::StringOption const option = schema_->arg_option(position);
+  if (option.is_required()) {
+    throw OptionNotSet();
+  }
+  return option.get_default();
+}
+
+bool ParseResult::same_items_at(std::size_t position,
+                                ParseResult const &other) const {
+  ItemRange const none{0, 0};
+  ItemRange const mine = position < itemRanges_.size()
+                         ? itemRanges_[position] : none;
+  ItemRange const theirs = position < other.itemRanges_.size()
+                           ? other.itemRanges_[position] : none;
+  if (mine.count != theirs.count) {
+    return false;
+  }
+  for (std::uint32_t i(0); i < mine.count; ++i) {
+    if (item_at(mine.begin + i) != other.item_at(theirs.begin + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParseResult::is_set_at(std::size_t position) const {
+  return position < values_.size() && values_[position].isSet;
+}
+
+bool ParseResult::switch_at(std::size_t position) const {
+  if (position < switches_.size()) {
+    return switches_[position];
+  }
+  return schema_->switch_option(position).get_default();
+}
+
+}
@@ -0,0 +1,217 @@
+#ifndef CMDO_PARSERESULT_H
+#define CMDO_PARSERESULT_H
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "cmdo/OptionSchema.h"
+
+namespace cmdo {
+
+/**
+ * @brief Values of every option of an OptionSchema, as found by one parse.
+ *
+ * Only the values are stored, in a table indexed like the options of the
+ * schema, with every copied string in one buffer. Copying a result is a flat
+ * copy of that table and buffer, so a result can be cloned for another
+ * thread cheaply. A result can only be used while its schema exists.
+ *
+ * Its tables, strings and converted values are allocated from a memory
+ * resource: with a std::pmr::monotonic_buffer_resource, a result is
+ * allocated in a few blocks and freed at once. Copies use the default
+ * resource.
+ */
+class ParseResult {
+public:
+  /**
+   * @brief An empty result: every option has its default value.
+   * @param[in] resource Allocates the values. It must outlive the result.
+   */
+  explicit ParseResult(OptionSchema const &schema,
+                       std::pmr::memory_resource *resource
+                       = std::pmr::get_default_resource());
+
+  OptionSchema const &schema() const;
+
+  /**
+   * @brief The memory resource the values are allocated from.
+   */
+  std::pmr::memory_resource *memory_resource() const;
+
+  std::string program_name() const;
+
+  /**
+   * @see CmdLineOptions::get_option
+   */
+  std::string get_option(std::string const &name) const;
+
+  /**
+   * @brief Like get_option(), but returns a view valid for as long as this
+   * result is not changed or destroyed.
+   */
+  std::string_view get_option_view(std::string_view name) const;
+
+  /**
+   * @see CmdLineOptions::get_option_as
+   */
+  template<typename T>
+  T get_option_as(std::string const &opt_name) const;
+
+  /**
+   * @see CmdLineOptions::get_switch
+   */
+  bool get_switch(std::string const &switch_name) const;
+
+  /**
+   * @see CmdLineOptions::get_list
+   */
+  std::vector<std::string> get_list(std::string const &name) const;
+
+  /**
+   * @see CmdLineOptions::get_list_as
+   */
+  template<typename T>
+  std::vector<T> get_list_as(std::string const &name) const;
+
+  /**
+   * @brief Forgets every value. Keeps the memory, for the next parse.
+   */
+  void clear();
+
+  /**
+   * @brief Bytes allocated for the values, kept by clear().
+   */
+  std::size_t retained_bytes() const;
+
+private:
+  friend class CmdLineOptions;
+  friend class OptionSchema;
+
+  /**
+   * @brief Where the value of an argument option is: in strings_ at offset,
+   * or at data for views into argv, @files and the defaults of the schema.
+   */
+  struct Value {
+    char const *data;
+    std::uint32_t offset;
+    std::uint32_t length;
+    bool isSet;
+  };
+
+  /**
+   * @brief Where the items of a list option are in items_.
+   */
+  struct ItemRange {
+    std::uint32_t begin;
+    std::uint32_t count;
+  };
+
+  /**
+   * @brief Returns a Value for value, copying it into strings_ if copy is
+   * true.
+   */
+  Value store(std::string_view value, bool is_set, bool copy);
+
+  /**
+   * @brief Sets the value of the argument option at position, copying it
+   * into strings_ if copy is true.
+   */
+  void set_value(std::size_t position, std::string_view value, bool is_set,
+                 bool copy);
+
+  /**
+   * @brief Sets the items of the list option at position, copying them into
+   * strings_ if copy is true.
+   */
+  void set_items(std::size_t position, OptionSchema::ItemList const &items,
+                 bool copy);
+
+  /**
+   * @brief Position and items of the list option called name. Lists added
+   * after this result was filled are empty.
+   * @throws UndefinedOption
+   *   If there is no list option called name.
+   */
+  std::pair<std::size_t, ItemRange> find_list(std::string const &name) const;
+
+  std::string_view item_at(std::size_t index) const;
+
+  /**
+   * @brief True if the list option at position has the same items in
+   * other.
+   */
+  bool same_items_at(std::size_t position, ParseResult const &other) const;
+
+  /**
+   * @brief Value of the argument option at position, or its default if the
+   * option was added after this result was filled.
+   * @throws OptionNotSet
+   */
+  std::string_view value_at(std::size_t position) const;
+
+  bool is_set_at(std::size_t position) const;
+
+  bool switch_at(std::size_t position) const;
+
+  OptionSchema const *schema_;
+  std::pmr::string programName_;
+  std::pmr::vector<Value> values_;
+  std::pmr::vector<OptionSchema::TypedValuePtr> typedValues_;
+  // Values of typedValues_ set by the last parse; the others are stale.
+  std::size_t typedCount_;
+  std::pmr::vector<char> switches_;
+  // Items of every list option, one after the other.
+  std::pmr::vector<Value> items_;
+  // One per argument option, empty for the others.
+  std::pmr::vector<ItemRange> itemRanges_;
+  // Copied values.
+  std::pmr::string strings_;
+  // Keeps the @files of the zero-copy parse that values point into.
+  std::shared_ptr<OptionSchema::ResponseFileList const> responseFiles_;
+  OptionSchema::MergeScratch scratch_;
+};
+
+template<typename T>
+T ParseResult::get_option_as(std::string const &opt_name) const {
+  OptionIndex::Entry const entry = schema_->index_.find(opt_name);
+  if (entry.kind != OptionIndex::Kind::Arg) {
+    throw UndefinedOption();
+  }
+  std::string_view const text = value_at(entry.position);
+  OptionSchema::TypedValue const *typed =
+      entry.position < typedCount_
+      ? typedValues_[entry.position].get()
+      : schema_->typed_value(entry.position).get();
+  if (typed != nullptr && typed->type() == typeid(T)) {
+    return static_cast<OptionSchema::TypedValueOf<T> const *>(typed)->get();
+  }
+  return from_string<T>(text);
+}
+
+template<typename T>
+std::vector<T> ParseResult::get_list_as(std::string const &name) const {
+  std::pair<std::size_t, ItemRange> const list = find_list(name);
+  std::size_t const position = list.first;
+  OptionSchema::TypedValue const *typed =
+      position < typedCount_
+      ? typedValues_[position].get()
+      : schema_->typed_value(position).get();
+  if (typed != nullptr && typed->type() == typeid(std::vector<T>)) {
+    return static_cast<OptionSchema::TypedListOf<T> const *>(typed)->get();
+  }
+  std::vector<T> values;
+  values.reserve(list.second.count);
+  for (std::uint32_t i(0); i < list.second.count; ++i) {
+    values.push_back(from_string<T>(item_at(list.second.begin + i)));
+  }
+  return values;
+}
+
+}
+
+#endif //CMDO_PARSERESULT_H
@@ -0,0 +1,46 @@
+#include "cmdo/ParseStats.h"
+
+namespace cmdo {
+
+ParseStats::ParseStats()
+    : enabled(STATS_ENABLED), registration_ns(0), parse_ns(0), tokenize_ns(0),
+      loop_ns(0), merge_ns(0), validator_ns(0), handler_ns(0), parses(0),
+      tokens(0), lookups(0), allocations(0), schema_bytes(0), value_bytes(0),
+      mapped_bytes(0), validators() {
+}
+
+void ParseStats::print(std::ostream &out) const {
+  out << "enabled: " << (enabled ? "true" : "false") << '\n'
+      << "registration_ns: " << registration_ns << '\n'
+      << "parse_ns: " << parse_ns << '\n'
+      << "tokenize_ns: " << tokenize_ns << '\n'
+      << "loop_ns: " << loop_ns << '\n'
+      << "merge_ns: " << merge_ns << '\n'
+      << "validator_ns: " << validator_ns << '\n'
+      << "handler_ns: " << handler_ns << '\n'
+      << "parses: " << parses << '\n'
+      << "tokens: " << tokens << '\n'
+      << "lookups: " << lookups << '\n'
+      << "allocations: " << allocations << '\n'
+      << "schema_bytes: " << schema_bytes << '\n'
+      << "value_bytes: " << value_bytes << '\n'
+      << "mapped_bytes: " << mapped_bytes << '\n';
+  for (ValidatorStats const &validator : validators) {
+    out << "validator " << validator.option << '#' << validator.validator
+        << ": " << validator.calls << " calls, " << validator.ns << " ns\n";
+  }
+}
+
+void ParseStats::add_validator_call(std::string const &option,
+                                    std::size_t validator, std::uint64_t ns) {
+  for (ValidatorStats &stats : validators) {
+    if (stats.validator == validator && stats.option == option) {
+      ++stats.calls;
+      stats.ns += ns;
+      return;
+    }
+  }
+  validators.push_back(ValidatorStats{option, validator, 1, ns});
+}
+
+}
@@ -0,0 +1,158 @@
+#ifndef CMDO_PARSESTATS_H
+#define CMDO_PARSESTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cmdo {
+
+/**
+ * @brief True if the library is built with CMDO_STATS (cmake -DCMDO_STATS=ON).
+ * Without it, nothing is timed or counted: the code that would is compiled
+ * out.
+ */
+#ifdef CMDO_STATS
+constexpr bool STATS_ENABLED = true;
+#else
+constexpr bool STATS_ENABLED = false;
+#endif
+
+/**
+ * @brief Where the time of CmdLineOptions went, and the memory it holds.
+ *
+ * Times are in nanoseconds and add up from the construction of the
+ * CmdLineOptions, or the last reset_stats(). Times and counts are only
+ * collected if STATS_ENABLED, and are zero otherwise; bytes are always
+ * filled in.
+ */
+struct ParseStats {
+  /**
+   * @brief Calls to one validator. A call run on the validator threads
+   * (see CmdLineOptions::set_validator_threads) that timed out counts for
+   * the timeout.
+   */
+  struct ValidatorStats {
+    std::string option;
+    // Position of the validator among the ones attached to option.
+    std::size_t validator;
+    std::uint64_t calls;
+    std::uint64_t ns;
+  };
+
+  typedef std::vector<ValidatorStats> ValidatorStatsList;
+
+  bool enabled;
+  // Defining options: add_*, attach_validator(), load_schema().
+  std::uint64_t registration_ns;
+  // Whole parse() calls, of which the phases below.
+  std::uint64_t parse_ns;
+  // Splitting argv and @files into tokens, when it is done before the loop.
+  std::uint64_t tokenize_ns;
+  // Matching tokens with options.
+  std::uint64_t loop_ns;
+  // Reading the environment and config file, merging values, converting
+  // them, and running validators.
+  std::uint64_t merge_ns;
+  std::uint64_t validator_ns;
+  std::uint64_t handler_ns;
+  std::uint64_t parses;
+  std::uint64_t tokens;
+  // Lookups of tokens in the option index.
+  std::uint64_t lookups;
+  // Allocations made by parse(), if an allocation counter is set.
+  std::uint64_t allocations;
+  // Heap memory held by the options, and by the values.
+  std::size_t schema_bytes;
+  std::size_t value_bytes;
+  // Size of the schema file loaded by load_schema(), which is mapped.
+  std::size_t mapped_bytes;
+  ValidatorStatsList validators;
+
+  ParseStats();
+
+  /**
+   * @brief Writes the stats as "name: value" lines.
+   */
+  void print(std::ostream &out) const;
+
+  /**
+   * @brief Counts a call of the validator at position validator of option,
+   * which took ns.
+   */
+  void add_validator_call(std::string const &option, std::size_t validator,
+                          std::uint64_t ns);
+};
+
+/**
+ * @brief Adds n to the counter of stats, unless stats is null.
+ */
+inline void count_stat(ParseStats *stats, std::uint64_t ParseStats::*counter,
+                       std::uint64_t n = 1) {
+  if constexpr (STATS_ENABLED) {
+    if (stats != nullptr) {
+      stats->*counter += n;
+    }
+  }
+}
+
+/**
+ * @brief Adds the time from its construction to its destruction to
+ * *nanoseconds, unless nanoseconds is null.
+ */
+template<bool Enabled>
+class BasicStatsTimer {
+public:
+  explicit BasicStatsTimer(std::uint64_t *nanoseconds)
+      : nanoseconds_(nanoseconds), start_(std::chrono::steady_clock::now()) {
+  }
+
+  /**
+   * @brief Times into the counter of stats, unless stats is null.
+   */
+  BasicStatsTimer(ParseStats *stats, std::uint64_t ParseStats::*counter)
+      : BasicStatsTimer(stats != nullptr ? &(stats->*counter) : nullptr) {
+  }
+
+  BasicStatsTimer(BasicStatsTimer const &) = delete;
+
+  BasicStatsTimer &operator=(BasicStatsTimer const &) = delete;
+
+  ~BasicStatsTimer() {
+    if (nanoseconds_ != nullptr) {
+      *nanoseconds_ += static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start_).count());
+    }
+  }
+
+private:
+  std::uint64_t *nanoseconds_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Without stats, a timer is empty and does nothing.
+ */
+template<>
+class BasicStatsTimer<false> {
+public:
+  explicit BasicStatsTimer(std::uint64_t *) {
+  }
+
+  BasicStatsTimer(ParseStats *, std::uint64_t ParseStats::*) {
+  }
+
+  BasicStatsTimer(BasicStatsTimer const &) = delete;
+
+  BasicStatsTimer &operator=(BasicStatsTimer const &) = delete;
+};
+
+typedef BasicStatsTimer<STATS_ENABLED> StatsTimer;
+
+}
+
+#endif //CMDO_PARSESTATS_H
@@ -0,0 +1,166 @@
+#ifndef CMDO_PUBLISHEDPTR_H
+#define CMDO_PUBLISHEDPTR_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace cmdo {
+
+/**
+ * @brief Holds the current value of a T, which any thread reads without
+ * locking while one thread at a time replaces it.
+ *
+ * The value lives in one of two slots. A reader registers in the counter of
+ * the current slot, checks that the slot is still the current one, and
+ * reads it. A writer fills the other slot, makes it the current one, and
+ * waits for the readers of the previous one to leave. So readers never
+ * wait, and a replaced value is no longer read by anyone once exchange()
+ * returns it.
+ *
+ * The counters are spread over cache lines, one per group of threads, so
+ * that readers on different cores don't write to the same line.
+ */
+template<typename T>
+class PublishedPtr {
+public:
+  typedef std::shared_ptr<T const> Ptr;
+
+  /**
+   * @brief Reads the current value. The value doesn't change, and is not
+   * released, while the reader exists. A reader must not outlive its
+   * PublishedPtr, and a thread holding one must not call exchange().
+   */
+  class Reader {
+  public:
+    explicit Reader(PublishedPtr const &published);
+
+    Reader(Reader const &) = delete;
+
+    Reader &operator=(Reader const &) = delete;
+
+    ~Reader();
+
+    Ptr const &get() const {
+      return published_.slots_[slot_];
+    }
+
+    T const *operator->() const {
+      return get().get();
+    }
+
+  private:
+    PublishedPtr const &published_;
+    std::atomic<std::uint32_t> *count_;
+    unsigned slot_;
+  };
+
+  explicit PublishedPtr(Ptr value);
+
+  PublishedPtr(PublishedPtr const &) = delete;
+
+  PublishedPtr &operator=(PublishedPtr const &) = delete;
+
+  /**
+   * @brief A copy of the current value.
+   */
+  Ptr load() const {
+    return Reader(*this).get();
+  }
+
+  /**
+   * @brief Makes value the current one. Calls must not overlap.
+   * @returns The previous value, which no Reader reads anymore.
+   */
+  Ptr exchange(Ptr value);
+
+private:
+  static std::size_t const STRIPES = 16;
+
+  struct alignas(64) Stripe {
+    // Readers of each slot.
+    std::array<std::atomic<std::uint32_t>, 2> counts;
+  };
+
+  /**
+   * @brief The stripe of the calling thread.
+   */
+  Stripe &stripe() const;
+
+  /**
+   * @brief Waits until no reader is registered in slot.
+   */
+  void wait_for_readers(unsigned slot) const;
+
+  std::array<Ptr, 2> slots_;
+  std::atomic<unsigned> current_;
+  mutable std::array<Stripe, STRIPES> stripes_;
+};
+
+template<typename T>
+PublishedPtr<T>::Reader::Reader(PublishedPtr const &published)
+    : published_(published), count_(nullptr), slot_(0) {
+  Stripe &stripe = published.stripe();
+  for (;;) {
+    slot_ = published.current_.load(std::memory_order_seq_cst);
+    count_ = &stripe.counts[slot_];
+    count_->fetch_add(1, std::memory_order_seq_cst);
+    // Once registered, the slot is only released if exchange() made the
+    // other one current first: then try again with the other one.
+    if (published.current_.load(std::memory_order_seq_cst) == slot_) {
+      return;
+    }
+    count_->fetch_sub(1, std::memory_order_release);
+  }
+}
+
+template<typename T>
+PublishedPtr<T>::Reader::~Reader() {
+  count_->fetch_sub(1, std::memory_order_release);
+}
+
+template<typename T>
+PublishedPtr<T>::PublishedPtr(Ptr value)
+    : slots_(), current_(0), stripes_() {
+  slots_[0] = std::move(value);
+  for (Stripe &stripe : stripes_) {
+    stripe.counts[0].store(0, std::memory_order_relaxed);
+    stripe.counts[1].store(0, std::memory_order_relaxed);
+  }
+}
+
+template<typename T>
+typename PublishedPtr<T>::Ptr PublishedPtr<T>::exchange(Ptr value) {
+  unsigned const previous = current_.load(std::memory_order_relaxed);
+  unsigned const next = 1 - previous;
+  // Readers of next left before the last exchange() returned, and new ones
+  // find it is not current: nobody reads it.
+  slots_[next] = std::move(value);
+  current_.store(next, std::memory_order_seq_cst);
+  wait_for_readers(previous);
+  return std::move(slots_[previous]);
+}
+
+template<typename T>
+typename PublishedPtr<T>::Stripe &PublishedPtr<T>::stripe() const {
+  static std::atomic<std::size_t> threads(0);
+  thread_local std::size_t const index
+      = threads.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+  return stripes_[index];
+}
+
+template<typename T>
+void PublishedPtr<T>::wait_for_readers(unsigned slot) const {
+  for (Stripe const &stripe : stripes_) {
+    while (stripe.counts[slot].load(std::memory_order_seq_cst) != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+}
+
+#endif //CMDO_PUBLISHEDPTR_H
@@ -0,0 +1,92 @@
+#include "cmdo/ResponseFile.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace cmdo {
+
+namespace {
+
+void tokenize_lines(char const *begin, char const *end,
+                    ResponseFile::TokenList &tokens) {
+  for_each_line(
+      std::string_view(begin, static_cast<std::size_t>(end - begin)),
+      [&tokens](std::string_view token) {
+        tokens.push_back(token);
+      });
+}
+
+// Moves pos past the next end of line, so that chunks start on a line.
+char const *next_line(char const *pos, char const *end) {
+  std::size_t const found = best_scan_kernels().find(
+      pos, static_cast<std::size_t>(end - pos), '\n');
+  return found == std::string_view::npos ? end : pos + found + 1;
+}
+
+}
+
+std::size_t const ResponseFile::PARALLEL_THRESHOLD = 1 << 20;
+
+ResponseFile::ResponseFile(std::string const &path)
+    : file_(path) {
+}
+
+bool ResponseFile::is_open() const {
+  return file_.is_open();
+}
+
+std::string_view ResponseFile::contents() const {
+  return file_.contents();
+}
+
+void ResponseFile::tokenize(TokenList &tokens) const {
+  unsigned threads(1);
+  std::size_t const size = contents().size();
+  if (size >= PARALLEL_THRESHOLD) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(
+        std::min<std::size_t>(threads, size / (PARALLEL_THRESHOLD / 4)));
+  }
+  tokenize(contents(), tokens, threads);
+}
+
+void ResponseFile::tokenize(std::string_view contents, TokenList &tokens,
+                            unsigned threads) {
+  char const *const begin = contents.data();
+  char const *const end = begin + contents.size();
+  if (threads <= 1 || contents.empty()) {
+    tokenize_lines(begin, end, tokens);
+    return;
+  }
+
+  // Split into chunks of about the same size, each one starting on a line.
+  std::vector<char const *> bounds{begin};
+  for (unsigned i(1); i < threads; ++i) {
+    char const *pos = begin + contents.size() / threads * i;
+    pos = next_line(std::max(pos, bounds.back()), end);
+    bounds.push_back(pos);
+  }
+  bounds.push_back(end);
+
+  std::vector<TokenList> chunkTokens(threads);
+  std::vector<std::thread> workers;
+  for (unsigned i(1); i < threads; ++i) {
+    workers.emplace_back(tokenize_lines, bounds[i], bounds[i + 1],
+                         std::ref(chunkTokens[i]));
+  }
+  tokenize_lines(bounds[0], bounds[1], tokens);
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  std::size_t total(tokens.size());
+  for (TokenList const &chunk : chunkTokens) {
+    total += chunk.size();
+  }
+  tokens.reserve(total);
+  for (TokenList const &chunk : chunkTokens) {
+    tokens.insert(tokens.end(), chunk.begin(), chunk.end());
+  }
+}
+
+}
@@ -0,0 +1,70 @@
+#ifndef CMDO_RESPONSEFILE_H
+#define CMDO_RESPONSEFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cmdo/CharScan.h"
+#include "cmdo/MappedFile.h"
+
+namespace cmdo {
+
+/**
+ * @brief A memory-mapped @file argument: a file with one command line
+ * argument per line, used when there are too many arguments for a real
+ * command line.
+ *
+ * Lines may end in "\n" or "\r\n", and empty lines are skipped. Nothing else
+ * is interpreted, so a line can hold any path, spaces included. The tokens
+ * are views into the mapping, which lives as long as the ResponseFile.
+ */
+class ResponseFile {
+public:
+  typedef std::vector<std::string_view> TokenList;
+
+  /**
+   * @brief Maps the file at path. Check is_open() to know if it worked.
+   */
+  explicit ResponseFile(std::string const &path);
+
+
+  bool is_open() const;
+
+  std::string_view contents() const;
+
+  /**
+   * @brief Appends the arguments in the file to tokens. Big files are split
+   * at line boundaries and tokenized by several threads.
+   */
+  void tokenize(TokenList &tokens) const;
+
+  /**
+   * @brief Calls f with every argument in the file, in order, without
+   * building a list.
+   */
+  template<typename Function>
+  void for_each_token(Function f) const {
+    for_each_line(contents(), f);
+  }
+
+  /**
+   * @brief Appends the lines of contents to tokens, using up to threads
+   * threads. The result doesn't depend on the number of threads.
+   */
+  static void tokenize(std::string_view contents, TokenList &tokens,
+                       unsigned threads);
+
+  /**
+   * @brief Files smaller than this are always tokenized by the calling
+   * thread.
+   */
+  static std::size_t const PARALLEL_THRESHOLD;
+
+private:
+  MappedFile file_;
+};
+
+}
+
+#endif //CMDO_RESPONSEFILE_H
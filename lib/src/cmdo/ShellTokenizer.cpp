@@ -0,0 +1,126 @@
+#include "cmdo/ShellTokenizer.h"
+
+namespace cmdo {
+
+namespace {
+
+bool is_blank(char c) {
+  return c == ' ' || c == '\t' || c == '\n';
+}
+
+// Characters that make an argument need unquoting.
+bool is_quoting(char c) {
+  return c == '\'' || c == '"' || c == '\\';
+}
+
+// Characters a backslash escapes between double quotes.
+bool is_escapable_in_double_quotes(char c) {
+  return c == '$' || c == '`' || c == '"' || c == '\\' || c == '\n';
+}
+
+}
+
+ShellTokenizer::ShellTokenizer()
+    : strings_(), scratch_() {
+}
+
+void ShellTokenizer::tokenize(std::string_view line, TokenList &tokens) {
+  std::size_t const size = tokens.size();
+  try {
+    for_each_token(line, [&tokens](std::string_view token) {
+      tokens.push_back(token);
+    });
+  } catch (BadCommandLine const &) {
+    tokens.resize(size);
+    throw;
+  }
+}
+
+bool ShellTokenizer::next_token(std::string_view line, std::size_t &pos,
+                                std::string_view &token) {
+  std::size_t const size = line.size();
+  // Blanks and line continuations between arguments.
+  while (pos < size) {
+    if (is_blank(line[pos])) {
+      ++pos;
+    } else if (line[pos] == '\\' && pos + 1 < size && line[pos + 1] == '\n') {
+      pos += 2;
+    } else {
+      break;
+    }
+  }
+  if (pos == size) {
+    return false;
+  }
+
+  std::size_t end = pos;
+  while (end < size && !is_blank(line[end]) && !is_quoting(line[end])) {
+    ++end;
+  }
+  if (end == size || is_blank(line[end])) {
+    token = line.substr(pos, end - pos);
+    pos = end;
+    return true;
+  }
+  token = unquote(line, pos);
+  return true;
+}
+
+std::string_view ShellTokenizer::unquote(std::string_view line,
+                                         std::size_t &pos) {
+  std::size_t const size = line.size();
+  std::size_t i = pos;
+  scratch_.clear();
+  while (i < size && !is_blank(line[i])) {
+    char const c = line[i];
+    if (c == '\\') {
+      if (i + 1 == size) {
+        throw BadCommandLine();
+      }
+      if (line[i + 1] != '\n') {
+        scratch_.push_back(line[i + 1]);
+      }
+      i += 2;
+    } else if (c == '\'') {
+      std::size_t const close = line.find('\'', i + 1);
+      if (close == line.npos) {
+        throw BadCommandLine();
+      }
+      scratch_.append(line.data() + i + 1, close - i - 1);
+      i = close + 1;
+    } else if (c == '"') {
+      ++i;
+      while (true) {
+        if (i == size) {
+          throw BadCommandLine();
+        }
+        char const d = line[i];
+        if (d == '"') {
+          ++i;
+          break;
+        }
+        if (d == '\\' && i + 1 < size
+            && is_escapable_in_double_quotes(line[i + 1])) {
+          if (line[i + 1] != '\n') {
+            scratch_.push_back(line[i + 1]);
+          }
+          i += 2;
+          continue;
+        }
+        scratch_.push_back(d);
+        ++i;
+      }
+    } else {
+      std::size_t end = i + 1;
+      while (end < size && !is_blank(line[end]) && !is_quoting(line[end])) {
+        ++end;
+      }
+      scratch_.append(line.data() + i, end - i);
+      i = end;
+    }
+  }
+  pos = i;
+  return strings_.store(scratch_);
+}
+
+}
@@ -0,0 +1,95 @@
+#ifndef CMDO_SHELLTOKENIZER_H
+#define CMDO_SHELLTOKENIZER_H
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cmdo/StringArena.h"
+
+namespace cmdo {
+
+struct BadCommandLine : public std::exception {
+
+};
+
+/**
+ * @brief Splits a command line held in a single string into arguments,
+ * following the quoting rules of a POSIX shell:
+ *  - unquoted spaces, tabs and newlines separate arguments,
+ *  - a backslash keeps the next character as is, and a backslash-newline
+ *    is removed,
+ *  - everything between single quotes is kept as is,
+ *  - between double quotes, a backslash only escapes $, `, ", \ and
+ *    newline.
+ * Nothing is expanded: $VAR, ~ and globs are kept as they are written.
+ *
+ * Arguments without quotes or backslashes are views into the line. The
+ * others are unquoted into memory owned by the tokenizer, which is reused by
+ * the next call, so their views are valid until then.
+ */
+class ShellTokenizer {
+public:
+  typedef std::vector<std::string_view> TokenList;
+
+  ShellTokenizer();
+
+  ShellTokenizer(ShellTokenizer const &) = delete;
+
+  ShellTokenizer &operator=(ShellTokenizer const &) = delete;
+
+  /**
+   * @brief Calls f with every argument of line, in order, without building
+   * a list.
+   * @throws BadCommandLine
+   *   If a quote is not closed or the line ends with a backslash. f has been
+   *   called with the arguments before the error.
+   */
+  template<typename Function>
+  void for_each_token(std::string_view line, Function f);
+
+  /**
+   * @brief Appends the arguments of line to tokens.
+   * @throws BadCommandLine
+   *   If a quote is not closed or the line ends with a backslash. tokens is
+   *   left unchanged.
+   */
+  void tokenize(std::string_view line, TokenList &tokens);
+
+private:
+  /**
+   * @brief Finds the argument starting at or after pos, and moves pos past
+   * it.
+   * @returns false if there are no more arguments.
+   * @throws BadCommandLine
+   */
+  bool next_token(std::string_view line, std::size_t &pos,
+                  std::string_view &token);
+
+  /**
+   * @brief Unquotes the argument starting at pos into scratch_, stores it
+   * in strings_ and moves pos past it.
+   * @throws BadCommandLine
+   */
+  std::string_view unquote(std::string_view line, std::size_t &pos);
+
+  // Unquoted arguments of the current line.
+  StringArena strings_;
+  // Reused to build one unquoted argument.
+  std::string scratch_;
+};
+
+template<typename Function>
+void ShellTokenizer::for_each_token(std::string_view line, Function f) {
+  strings_.clear();
+  std::size_t pos(0);
+  std::string_view token;
+  while (next_token(line, pos, token)) {
+    f(token);
+  }
+}
+
+}
+
+#endif //CMDO_SHELLTOKENIZER_H
@@ -0,0 +1,530 @@
+#ifndef CMDO_STATICOPTIONS_H
+#define CMDO_STATICOPTIONS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "cmdo/CmdLineOptions.h"
+
+/**
+ * Options known at compile time. Each option is a type:
+ *
+ *   CMDO_REQUIRED(Input, "-in", "an input file");
+ *   CMDO_OPTIONAL(Opt1, "-opt1", "this is optional", "5");
+ *   CMDO_SWITCH(Super, "-super", "do the work in super mode.", false);
+ *
+ *   cmdo::StaticOptions<Input, Opt1, Super> cmdo("program description");
+ *   cmdo.parse(argc, argv, leftOvers);
+ *   std::string_view in = cmdo.get_option<Input>();
+ *
+ * Duplicate names are rejected at compile time, there is no registration
+ * at runtime, and parse() matches tokens with a perfect hash computed by
+ * the compiler. Results are the same as a CmdLineOptions with the same
+ * options added in the same order.
+ */
+#define CMDO_REQUIRED(Type, Name, Description) \
+  struct Type : ::cmdo::StaticRequired { \
+    static constexpr std::string_view name{Name}; \
+    static constexpr std::string_view description{Description}; \
+  }
+
+#define CMDO_OPTIONAL(Type, Name, Description, DefaultValue) \
+  struct Type : ::cmdo::StaticOptional { \
+    static constexpr std::string_view name{Name}; \
+    static constexpr std::string_view description{Description}; \
+    static constexpr std::string_view default_value{DefaultValue}; \
+  }
+
+#define CMDO_SWITCH(Type, Name, Description, DefaultSetting) \
+  struct Type : ::cmdo::StaticSwitch { \
+    static constexpr std::string_view name{Name}; \
+    static constexpr std::string_view description{Description}; \
+    static constexpr bool default_setting = DefaultSetting; \
+  }
+
+namespace cmdo {
+
+enum class StaticOptionKind {
+  Required,
+  Optional,
+  Switch
+};
+
+struct StaticRequired {
+  static constexpr StaticOptionKind kind = StaticOptionKind::Required;
+  static constexpr std::string_view default_value{};
+  static constexpr bool default_setting = false;
+};
+
+struct StaticOptional {
+  static constexpr StaticOptionKind kind = StaticOptionKind::Optional;
+  static constexpr bool default_setting = false;
+};
+
+struct StaticSwitch {
+  static constexpr StaticOptionKind kind = StaticOptionKind::Switch;
+  static constexpr std::string_view default_value{};
+};
+
+// The -h switch is added by default, like in CmdLineOptions.
+CMDO_SWITCH(StaticHelpSwitch, "-h", "Show program help.", false);
+
+namespace detail {
+
+constexpr std::uint64_t hash_name(std::string_view name) {
+  // FNV-1a, then a murmur3 finalizer so that the low bits used to pick a
+  // bucket and a slot depend on every character.
+  std::uint64_t h = 14695981039346656037ULL;
+  for (char c : name) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+constexpr std::uint64_t displace(std::uint64_t h, std::uint32_t d) {
+  h += (d + 1) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 31;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 29;
+  return h;
+}
+
+constexpr bool valid_name(std::string_view name) {
+  if (name.empty()) {
+    return false;
+  }
+  for (char c : name) {
+    if (c == ' ') {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<std::size_t N>
+constexpr bool unique_names(std::array<std::string_view, N> const &names) {
+  for (std::size_t i(0); i < N; ++i) {
+    for (std::size_t j(i + 1); j < N; ++j) {
+      if (names[i] == names[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+constexpr std::size_t perfect_hash_size(std::size_t n) {
+  std::size_t size(1);
+  while (size < 2 * n) {
+    size <<= 1;
+  }
+  return size;
+}
+
+/**
+ * @brief Perfect hash over N names, built with hash-and-displace: names are
+ * spread over buckets, and each bucket (largest first) gets the smallest
+ * displacement that puts all of its names in free slots.
+ */
+template<std::size_t N>
+struct PerfectHash {
+  static constexpr std::size_t BUCKETS = N / 2 + 1;
+  static constexpr std::size_t SIZE = perfect_hash_size(N);
+
+  std::array<std::uint32_t, BUCKETS> displacement;
+  // Position of the name in each slot, or N if the slot is empty.
+  std::array<std::size_t, SIZE> slots;
+
+  constexpr std::size_t slot_of(std::uint64_t h) const {
+    return static_cast<std::size_t>(
+        displace(h, displacement[h % BUCKETS]) & (SIZE - 1));
+  }
+};
+
+template<std::size_t N>
+constexpr PerfectHash<N> make_perfect_hash(
+    std::array<std::string_view, N> const &names) {
+  typedef PerfectHash<N> Table;
+  Table table{};
+  std::array<std::uint64_t, N> hashes{};
+  std::array<std::size_t, Table::BUCKETS> bucketSize{};
+  for (std::size_t i(0); i < N; ++i) {
+    hashes[i] = hash_name(names[i]);
+    ++bucketSize[hashes[i] % Table::BUCKETS];
+  }
+  for (std::size_t &slot : table.slots) {
+    slot = N;
+  }
+
+  std::array<bool, Table::BUCKETS> placed{};
+  for (std::size_t round(0); round < Table::BUCKETS; ++round) {
+    std::size_t bucket(0);
+    std::size_t largest(0);
+    for (std::size_t b(0); b < Table::BUCKETS; ++b) {
+      if (!placed[b] && (bucketSize[b] > largest || largest == 0)) {
+        bucket = b;
+        largest = bucketSize[b];
+      }
+    }
+    placed[bucket] = true;
+    if (bucketSize[bucket] == 0) {
+      continue;
+    }
+
+    for (std::uint32_t d(0);; ++d) {
+      std::array<std::size_t, N> taken{};
+      std::size_t count(0);
+      bool fits(true);
+      for (std::size_t i(0); i < N && fits; ++i) {
+        if (hashes[i] % Table::BUCKETS != bucket) {
+          continue;
+        }
+        std::size_t const slot = static_cast<std::size_t>(
+            displace(hashes[i], d) & (Table::SIZE - 1));
+        if (table.slots[slot] != N) {
+          fits = false;
+        }
+        for (std::size_t k(0); k < count && fits; ++k) {
+          if (taken[k] == slot) {
+            fits = false;
+          }
+        }
+        taken[count++] = slot;
+      }
+      if (!fits) {
+        continue;
+      }
+      table.displacement[bucket] = d;
+      for (std::size_t i(0); i < N; ++i) {
+        if (hashes[i] % Table::BUCKETS == bucket) {
+          table.slots[table.slot_of(hashes[i])] = i;
+        }
+      }
+      break;
+    }
+  }
+  return table;
+}
+
+template<typename T, typename... Options>
+struct IndexOf;
+
+template<typename T, typename... Options>
+struct IndexOf<T, T, Options...> : std::integral_constant<std::size_t, 0> {
+};
+
+template<typename T, typename U, typename... Options>
+struct IndexOf<T, U, Options...>
+    : std::integral_constant<std::size_t,
+                             1 + IndexOf<T, Options...>::value> {
+};
+
+template<typename T>
+struct IndexOf<T> {
+  static_assert(sizeof(T) == 0, "option is not part of this StaticOptions");
+};
+
+}
+
+/**
+ * @brief Like CmdLineOptions, but the options are given as template
+ * arguments (see CMDO_REQUIRED, CMDO_OPTIONAL and CMDO_SWITCH).
+ *
+ * Values are views: defaults point to the string literals, and values set in
+ * parse() point into argv, which must outlive this object.
+ */
+template<typename... Options>
+class StaticOptions {
+public:
+  typedef CmdLineOptions::ValidatorFunction ValidatorFunction;
+  typedef CmdLineOptions::StringList StringList;
+  typedef CmdLineOptions::ParserResultHandler ParserResultHandler;
+
+  static constexpr std::size_t SIZE = sizeof...(Options) + 1;
+
+  explicit StaticOptions(std::string const &program_description);
+
+  std::string program_name() const {
+    return programName_;
+  }
+
+  std::string program_description() const {
+    return programDescription_;
+  }
+
+  /**
+   * @brief Same as CmdLineOptions::parse.
+   */
+  void parse(int argc, char **argv, StringList &left_overs);
+
+  /**
+   * @brief Position of a name in the schema (the help switch is 0), or SIZE
+   * if the name is not an option.
+   */
+  static constexpr std::size_t find(std::string_view name);
+
+  /**
+   * @brief Get the value of an argument option.
+   * @throws OptionNotSet
+   *   If a required argument was not set.
+   */
+  template<typename Option>
+  std::string_view get_option() const;
+
+  /**
+   * @brief Like get_option() but casts the argument value.
+   * @throws BadCast
+   *   If the value cannot be casted to what you want.
+   */
+  template<typename Option, typename T>
+  T get_option_as() const {
+    return from_string<T>(get_option<Option>());
+  }
+
+  template<typename Option>
+  bool get_switch() const;
+
+  /**
+   * @brief Adds a validator for an argument option.
+   * @throws BadFunction
+   *   If validator is not a valid function.
+   */
+  template<typename Option>
+  void attach_validator(ValidatorFunction validator);
+
+  /**
+   * @throws BadFunction
+   *   If handler is not a valid function.
+   */
+  void set_parser_result_handler(ParserResultHandler handler);
+
+  /**
+   * @brief Sets the width print_usage() wraps descriptions at.
+   * @param[in] columns 0 to use the width of the terminal.
+   */
+  void set_usage_width(std::size_t columns);
+
+  void print_usage(std::ostream &out) const;
+
+private:
+  typedef std::array<std::string_view, SIZE> NameArray;
+
+  template<typename Option>
+  static constexpr std::size_t index_of() {
+    return detail::IndexOf<Option, StaticHelpSwitch, Options...>::value;
+  }
+
+  static constexpr NameArray NAMES{{StaticHelpSwitch::name,
+                                    Options::name...}};
+  static constexpr std::array<std::string_view, SIZE> DESCRIPTIONS{{
+      StaticHelpSwitch::description, Options::description...}};
+  static constexpr std::array<StaticOptionKind, SIZE> KINDS{{
+      StaticHelpSwitch::kind, Options::kind...}};
+  static constexpr std::array<std::string_view, SIZE> DEFAULT_VALUES{{
+      StaticHelpSwitch::default_value, Options::default_value...}};
+  static constexpr std::array<bool, SIZE> DEFAULT_SETTINGS{{
+      StaticHelpSwitch::default_setting, Options::default_setting...}};
+
+  static_assert(detail::unique_names(NAMES),
+                "option names must be unique (-h is already defined)");
+  static_assert(std::conjunction<std::bool_constant<
+                    detail::valid_name(Options::name)>...>::value,
+                "option names cannot be empty or contain spaces");
+
+  static constexpr detail::PerfectHash<SIZE> HASH
+      = detail::make_perfect_hash(NAMES);
+
+  std::array<std::string_view, SIZE> values_;
+  std::array<bool, SIZE> isSet_;
+  std::array<std::vector<ValidatorFunction>, SIZE> validators_;
+  std::string programName_;
+  std::string programDescription_;
+  ParserResultHandler parserResultHandler_;
+  std::size_t usageWidth_;
+};
+
+template<typename... Options>
+StaticOptions<Options...>::StaticOptions(
+    std::string const &program_description)
+    : values_(DEFAULT_VALUES), isSet_(), validators_(), programName_(),
+      programDescription_(program_description), parserResultHandler_(),
+      usageWidth_(0) {
+  // Default fail function, same as CmdLineOptions.
+  parserResultHandler_ = [this](StringList const &unknownInput,
+                                StringList const &missingOptions,
+                                StringList const &emptyOptions,
+                                StringList const &invalidOptions) {
+    for (std::string const &name : emptyOptions) {
+      std::cerr << "* option requires an argument: " << name << "\n";
+    }
+    for (std::string const &name : invalidOptions) {
+      std::cerr << "* invalid argument: " << name << " = "
+      << values_[find(name)] << "\n";
+    }
+    for (std::string const &name : missingOptions) {
+      std::cerr << "* option is required: " << name << "\n";
+    }
+    if (!missingOptions.empty() || !invalidOptions.empty()
+        || !emptyOptions.empty()) {
+      exit(EXIT_FAILURE);
+    }
+  };
+}
+
+template<typename... Options>
+constexpr std::size_t StaticOptions<Options...>::find(std::string_view name) {
+  std::size_t const i = HASH.slots[HASH.slot_of(detail::hash_name(name))];
+  return (i != SIZE && NAMES[i] == name) ? i : SIZE;
+}
+
+template<typename... Options>
+void StaticOptions<Options...>::parse(int argc, char **argv,
+                                      StringList &left_overs) {
+  left_overs.clear();
+
+  programName_ = argv[0];
+  // Remove everything but the command's name.
+  std::size_t const pos = programName_.find_last_of("/");
+  if (pos != programName_.npos && pos + 1 < programName_.size()) {
+    programName_ = programName_.substr(pos);
+  }
+
+  StringList listOfOptionsWithNoValue;
+
+  for (int i(1); i < argc; ++i) {
+    std::string_view const arg(argv[i]);
+    std::size_t const position = find(arg);
+    if (position == SIZE) {
+      // not an option :/
+      left_overs.push_back(std::string(arg));
+      continue;
+    }
+    if (KINDS[position] == StaticOptionKind::Switch) {
+      isSet_[position] = true;
+      continue;
+    }
+    if ((i + 1) < argc) {
+      values_[position] = argv[++i];
+      isSet_[position] = true;
+    } else {
+      listOfOptionsWithNoValue.push_back(std::string(arg));
+    }
+  }
+
+  // check for the help switch.
+  if (get_switch<StaticHelpSwitch>()) {
+    print_usage(std::cout);
+    exit(EXIT_SUCCESS);
+  }
+
+  StringList listOfMissingRequiredOptions;
+  StringList listOfInvalidOptions;
+  for (std::size_t i(0); i < SIZE; ++i) {
+    if (KINDS[i] == StaticOptionKind::Switch) {
+      continue;
+    }
+    if (!isSet_[i] && KINDS[i] == StaticOptionKind::Required) {
+      listOfMissingRequiredOptions.push_back(std::string(NAMES[i]));
+      continue;
+    }
+    std::string const name(NAMES[i]);
+    for (ValidatorFunction const &validator : validators_[i]) {
+      if (!validator(name, std::string(values_[i]))) {
+        listOfInvalidOptions.push_back(name);
+      }
+    }
+  }
+
+  parserResultHandler_(left_overs, listOfMissingRequiredOptions,
+                       listOfOptionsWithNoValue, listOfInvalidOptions);
+}
+
+template<typename... Options>
+template<typename Option>
+std::string_view StaticOptions<Options...>::get_option() const {
+  constexpr std::size_t i = index_of<Option>();
+  static_assert(KINDS[i] != StaticOptionKind::Switch,
+                "use get_switch() for switches");
+  if (KINDS[i] == StaticOptionKind::Required && !isSet_[i]) {
+    throw OptionNotSet();
+  }
+  return values_[i];
+}
+
+template<typename... Options>
+template<typename Option>
+bool StaticOptions<Options...>::get_switch() const {
+  constexpr std::size_t i = index_of<Option>();
+  static_assert(KINDS[i] == StaticOptionKind::Switch,
+                "use get_option() for arguments");
+  return isSet_[i] ? !DEFAULT_SETTINGS[i] : DEFAULT_SETTINGS[i];
+}
+
+template<typename... Options>
+template<typename Option>
+void StaticOptions<Options...>::attach_validator(
+    ValidatorFunction validator) {
+  constexpr std::size_t i = index_of<Option>();
+  static_assert(KINDS[i] != StaticOptionKind::Switch,
+                "validators can only be attached to arguments");
+  if (!validator) {
+    throw BadFunction();
+  }
+  validators_[i].push_back(validator);
+}
+
+template<typename... Options>
+void StaticOptions<Options...>::set_parser_result_handler(
+    ParserResultHandler handler) {
+  if (handler) {
+    parserResultHandler_ = handler;
+    return;
+  }
+  throw BadFunction();
+}
+
+template<typename... Options>
+void StaticOptions<Options...>::set_usage_width(std::size_t columns) {
+  usageWidth_ = columns;
+}
+
+template<typename... Options>
+void StaticOptions<Options...>::print_usage(std::ostream &out) const {
+  UsageFormatter usage(usageWidth_);
+  usage.set_program(programName_, "", programDescription_);
+  for (bool switches : {true, false}) {
+    for (std::size_t i(0); i < SIZE; ++i) {
+      bool const isSwitch = KINDS[i] == StaticOptionKind::Switch;
+      if (isSwitch != switches) {
+        continue;
+      }
+      std::string const defaultValue = isSwitch
+                                       ? to_string(DEFAULT_SETTINGS[i])
+                                       : std::string(DEFAULT_VALUES[i]);
+      std::string_view const currentValue = isSwitch
+                                            ? (DEFAULT_SETTINGS[i] ? "0" : "1")
+                                            : values_[i];
+      usage.add_option(NAMES[i], isSwitch, DESCRIPTIONS[i],
+                       KINDS[i] == StaticOptionKind::Required, defaultValue,
+                       isSet_[i], currentValue);
+    }
+  }
+
+  std::string text;
+  usage.render(text);
+  out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+}
+
+#endif //CMDO_STATICOPTIONS_H
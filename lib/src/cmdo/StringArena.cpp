@@ -0,0 +1,71 @@
+#include "cmdo/StringArena.h"
+#include <algorithm>
+#include <cstring>
+
+namespace cmdo {
+
+StringArena::StringArena(std::size_t chunk_size,
+                         std::pmr::memory_resource *resource)
+    : chunkSize_(chunk_size > 0 ? chunk_size : 1), current_(0),
+      chunks_(resource) {
+}
+
+StringArena::~StringArena() {
+  std::pmr::memory_resource *const resource =
+      chunks_.get_allocator().resource();
+  for (Chunk const &chunk : chunks_) {
+    resource->deallocate(chunk.data, chunk.capacity, 1);
+  }
+}
+
+std::string_view StringArena::store(std::string_view str) {
+  if (str.empty()) {
+    return std::string_view();
+  }
+
+  while (current_ < chunks_.size()
+         && chunks_[current_].capacity - chunks_[current_].used < str.size()) {
+    ++current_;
+  }
+  if (current_ == chunks_.size()) {
+    std::size_t const capacity = std::max(chunkSize_, str.size());
+    // Room first, so that the chunk can't leak.
+    if (chunks_.size() == chunks_.capacity()) {
+      chunks_.reserve(std::max<std::size_t>(4, chunks_.size() * 2));
+    }
+    char *const data = static_cast<char *>(
+        chunks_.get_allocator().resource()->allocate(capacity, 1));
+    chunks_.push_back(Chunk{data, capacity, 0});
+  }
+
+  Chunk &chunk = chunks_[current_];
+  char *const dst = chunk.data + chunk.used;
+  std::memcpy(dst, str.data(), str.size());
+  chunk.used += str.size();
+  return std::string_view(dst, str.size());
+}
+
+void StringArena::clear() {
+  for (Chunk &chunk : chunks_) {
+    chunk.used = 0;
+  }
+  current_ = 0;
+}
+
+std::size_t StringArena::size() const {
+  std::size_t result(0);
+  for (Chunk const &chunk : chunks_) {
+    result += chunk.used;
+  }
+  return result;
+}
+
+std::size_t StringArena::capacity() const {
+  std::size_t result(0);
+  for (Chunk const &chunk : chunks_) {
+    result += chunk.capacity;
+  }
+  return result;
+}
+
+}
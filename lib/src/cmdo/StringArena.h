@@ -0,0 +1,64 @@
+#ifndef CMDO_STRINGARENA_H
+#define CMDO_STRINGARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace cmdo {
+
+/**
+ * @brief Owns copies of strings in a few large chunks. Views returned by
+ * store() stay valid until clear() or destruction, no matter how many
+ * strings are stored after them. Chunks are allocated from a memory
+ * resource, which must outlive the arena.
+ */
+class StringArena {
+public:
+  explicit StringArena(std::size_t chunk_size = 4096,
+                       std::pmr::memory_resource *resource
+                       = std::pmr::get_default_resource());
+
+  StringArena(StringArena const &) = delete;
+
+  StringArena &operator=(StringArena const &) = delete;
+
+  ~StringArena();
+
+  /**
+   * @brief Copies str into the arena.
+   */
+  std::string_view store(std::string_view str);
+
+  /**
+   * @brief Forgets every stored string. The chunks are kept and reused by
+   * the next calls to store().
+   */
+  void clear();
+
+  /**
+   * @brief Bytes used by stored strings.
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Bytes allocated for chunks.
+   */
+  std::size_t capacity() const;
+
+private:
+  struct Chunk {
+    char *data;
+    std::size_t capacity;
+    std::size_t used;
+  };
+
+  std::size_t chunkSize_;
+  std::size_t current_;
+  std::pmr::vector<Chunk> chunks_;
+};
+
+}
+
+#endif //CMDO_STRINGARENA_H
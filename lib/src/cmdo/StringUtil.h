@@ -1,11 +1,18 @@
 #ifndef CMDO_STRINGUTIL_H
 #define CMDO_STRINGUTIL_H
 
+#include <algorithm>
+#include <charconv>
+#include <locale>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <exception>
-#include <array>
-#include <algorithm>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cmdo/CharScan.h"
 
 
 namespace cmdo {
@@ -13,114 +20,235 @@ namespace cmdo {
 struct BadCast : public std::exception {
 
 };
-std::array<std::string, 2> const TRUE_STRINGS = {{"true", "yes"}};
-std::array<std::string, 2> const FALSE_STRINGS = {{"false", "no"}};
 
-template<typename T>
-static std::string to_string(const T &v);
+namespace detail {
 
-template<>
-std::string to_string<bool>(const bool &v) {
-  if (v) {
-    return TRUE_STRINGS[0];
-  } else {
-    return FALSE_STRINGS[0];
+/**
+ * @brief Compares str to lower, a lower case ASCII string, ignoring the case
+ * of str.
+ */
+inline bool equals_ignore_case(std::string_view str, std::string_view lower) {
+  if (str.size() != lower.size()) {
+    return false;
   }
+  for (std::size_t i(0); i < str.size(); ++i) {
+    char c = str[i];
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+    if (c != lower[i]) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template<typename T>
-std::string to_string(const T &v) {
-  std::stringstream ss;
-  ss << v;
-  return ss.str();
-}
+struct IsNumber : std::integral_constant<bool,
+    (std::is_integral<T>::value || std::is_floating_point<T>::value)
+    && !std::is_same<T, bool>::value && !std::is_same<T, char>::value
+    && !std::is_same<T, signed char>::value
+    && !std::is_same<T, unsigned char>::value> {
+};
 
+#if defined(__cpp_lib_to_chars)
 template<typename T>
-static T from_string(std::string const &str);
+struct HasCharConv : std::integral_constant<bool, IsNumber<T>::value> {
+};
+#else
+// Without floating point support in <charconv>, only integers use it.
+template<typename T>
+struct HasCharConv : std::integral_constant<bool, IsNumber<T>::value
+    && std::is_integral<T>::value> {
+};
+#endif
 
-template<>
-bool from_string<bool>(std::string const &str) {
-  std::string str_(str);
-  for (char &c: str_) {
-    c = std::tolower(c);
-  }
+}
 
-  if (std::any_of(TRUE_STRINGS.begin(),
-                  TRUE_STRINGS.end(),
-                  [str_](std::string const &s) { return s == str_; })) {
-    return true;
-  }
-  if (std::any_of(FALSE_STRINGS.begin(),
-                  FALSE_STRINGS.end(),
-                  [str_](std::string const &s) { return s == str_; })) {
-    return false;
+/**
+ * @brief Converts v to a string. Numbers are written with std::to_chars
+ * (shortest representation, no locale), bools as "true" or "false".
+ */
+template<typename T>
+std::string to_string(T const &v) {
+  if constexpr (std::is_same<T, bool>::value) {
+    return v ? "true" : "false";
+  } else if constexpr (detail::HasCharConv<T>::value) {
+    char buffer[64];
+    std::to_chars_result const r = std::to_chars(buffer,
+                                                 buffer + sizeof(buffer), v);
+    return std::string(buffer, r.ptr);
+  } else if constexpr (std::is_convertible<T const &,
+                                           std::string_view>::value) {
+    return std::string(std::string_view(v));
+  } else {
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    ss << v;
+    return ss.str();
   }
-  throw BadCast();
 }
 
+/**
+ * @brief Converts str to T.
+ *
+ * Numbers are read with std::from_chars: the whole string must be a number
+ * (an optional leading '+' is allowed), and values out of the range of T are
+ * rejected. Bools accept true/yes and false/no, ignoring case. Strings get
+ * the whole of str, and other types are read with operator>>.
+ * @throws BadCast
+ *   If str can't be converted to T.
+ */
 template<typename T>
-T from_string(std::string const &str) {
-  T v;
-  std::stringstream ss;
-  ss.str(str);
-  ss >> v;
-  if (ss.fail()) {
+T from_string(std::string_view str) {
+  if constexpr (std::is_same<T, bool>::value) {
+    if (detail::equals_ignore_case(str, "true")
+        || detail::equals_ignore_case(str, "yes")) {
+      return true;
+    }
+    if (detail::equals_ignore_case(str, "false")
+        || detail::equals_ignore_case(str, "no")) {
+      return false;
+    }
     throw BadCast();
+  } else if constexpr (detail::HasCharConv<T>::value) {
+    char const *first = str.data();
+    char const *const last = str.data() + str.size();
+    if (first != last && *first == '+') {
+      ++first;
+      if (first != last && *first == '-') {
+        throw BadCast();
+      }
+    }
+    T v;
+    std::from_chars_result const r = std::from_chars(first, last, v);
+    if (r.ec != std::errc() || r.ptr != last || first == last) {
+      throw BadCast();
+    }
+    return v;
+  } else if constexpr (std::is_constructible<T, std::string_view>::value) {
+    return T(str);
+  } else {
+    T v;
+    std::istringstream ss{std::string(str)};
+    ss.imbue(std::locale::classic());
+    ss >> v;
+    if (ss.fail()) {
+      throw BadCast();
+    }
+    return v;
   }
-  return v;
 }
 
+/**
+ * @brief Removes the spaces at both ends of flag.
+ * @see trim_view
+ */
 inline
 void trim(std::string &flag) {
-  std::string result;
-  for (size_t i(0); i < flag.size(); ++i) {
-    if (flag[i] == ' ') {
-      continue;
+  std::string_view const trimmed = trim_view(flag);
+  std::size_t const first = static_cast<std::size_t>(trimmed.data()
+                                                     - flag.data());
+  flag.erase(first + trimmed.size());
+  flag.erase(0, first);
+}
+
+/**
+ * @brief Levenshtein distance between a and b, giving up as soon as it is
+ * known to be over bound. Only the cells at most bound away from the
+ * diagonal are computed. row is scratch memory, reused between calls.
+ * @returns The distance, or bound + 1 if it is over bound.
+ */
+inline
+std::size_t edit_distance(std::string_view a, std::string_view b,
+                          std::size_t bound, std::vector<std::size_t> &row) {
+  std::size_t const over = bound + 1;
+  if (a.size() > b.size() + bound || b.size() > a.size() + bound) {
+    return over;
+  }
+  if (a.size() > b.size()) {
+    std::swap(a, b);
+  }
+  // row[j] is the distance between the first i characters of b and the
+  // first j of a, or over if it is outside the band.
+  row.resize(a.size() + 1);
+  for (std::size_t j(0); j <= a.size(); ++j) {
+    row[j] = std::min(j, over);
+  }
+  for (std::size_t i(1); i <= b.size(); ++i) {
+    std::size_t const first = i > bound ? i - bound : 1;
+    std::size_t const last = std::min(a.size(), i + bound);
+    std::size_t diagonal = row[first - 1];
+    row[first - 1] = first == 1 ? std::min(i, over) : over;
+    std::size_t rowMin = row[first - 1];
+    for (std::size_t j(first); j <= last; ++j) {
+      std::size_t const up = row[j];
+      std::size_t const cost = a[j - 1] == b[i - 1] ? 0 : 1;
+      row[j] = std::min(std::min(std::min(up, row[j - 1]) + 1,
+                                 diagonal + cost), over);
+      diagonal = up;
+      rowMin = std::min(rowMin, row[j]);
+    }
+    if (rowMin == over) {
+      return over;
     }
-    result = flag.substr(i);
-    break;
   }
-  if (!result.empty()) {
-    size_t i(result.size() - 1);
-    while (true) {
-      if (result[i] != ' ') {
-        result = result.substr(0, i + 1);
-        break;
-      }
-      if (i == 0) {
-        break;
-      }
-      i--;
+  return row[a.size()];
+}
+
+inline
+std::size_t edit_distance(std::string_view a, std::string_view b,
+                          std::size_t bound) {
+  std::vector<std::size_t> row;
+  return edit_distance(a, b, bound, row);
+}
+
+/**
+ * @brief Calls f with every item of text separated by separator, as views
+ * into text, skipping empty items like split() does.
+ */
+template<typename Function>
+void for_each_item(std::string_view text, char separator, Function f) {
+  std::size_t begin(0);
+  while (begin < text.size()) {
+    std::size_t end = find_byte(text, separator, begin);
+    if (end == text.npos) {
+      end = text.size();
     }
+    if (end != begin) {
+      f(text.substr(begin, end - begin));
+    }
+    begin = end + 1;
   }
-  flag = result;
 }
 
+/**
+ * @brief Replaces the contents of result with the items of input separated
+ * by separator, skipping empty items.
+ */
 template<typename T>
 static void split(std::vector<T> &result, std::string const &input,
                   char separator) {
-  auto has_data = [](std::stringstream & ss) -> bool {
-    ss.seekp(0, ss.end);
-    return ss.tellp() != 0;
-  };
   result.clear();
-
-  std::stringstream ss;
-  for(char const& c : input) {
-    if(c == separator) {
-      if(has_data(ss)) {
-        result.push_back(ss.str());
-        ss.str("");
-        continue;
-      } else {
-        continue;
-      }
+  for_each_item(input, separator, [&result](std::string_view item) {
+    if constexpr (std::is_constructible<T, std::string_view>::value) {
+      result.emplace_back(item);
+    } else {
+      result.emplace_back(std::string(item));
     }
-    ss << c;
-  }
-  if(has_data(ss)) {
-    result.push_back(ss.str());
-  }
+  });
+}
+
+/**
+ * @brief Like split(), but the items are views into input.
+ */
+inline
+void split_view(std::vector<std::string_view> &result,
+                std::string_view input, char separator) {
+  result.clear();
+  for_each_item(input, separator, [&result](std::string_view item) {
+    result.push_back(item);
+  });
 }
 
 }
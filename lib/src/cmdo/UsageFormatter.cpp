@@ -0,0 +1,142 @@
+#include "cmdo/UsageFormatter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace cmdo {
+
+namespace {
+
+// Descriptions are never squeezed narrower than this.
+std::size_t const MIN_DESCRIPTION_WIDTH = 20;
+
+}
+
+UsageFormatter::UsageFormatter(std::size_t width)
+    : width_(width != 0 ? width : terminal_width()), program_(),
+      arguments_(), description_(), options_(), commands_() {
+}
+
+void UsageFormatter::set_program(std::string_view program,
+                                 std::string_view arguments,
+                                 std::string_view description) {
+  program_ = program;
+  arguments_ = arguments;
+  description_ = description;
+}
+
+void UsageFormatter::add_option(std::string_view name, bool is_switch,
+                                std::string_view description, bool required,
+                                std::string_view default_value, bool is_set,
+                                std::string_view current_value) {
+  Row row;
+  row.name = name;
+  if (!is_switch) {
+    row.name += " [...]";
+  }
+  row.description = description;
+  row.description += required ? "(required" : " (def = ";
+  if (!required) {
+    row.description += default_value;
+  }
+  if (is_set) {
+    row.description += ", curr = ";
+    row.description += current_value;
+  }
+  row.description += ")";
+  options_.push_back(std::move(row));
+}
+
+void UsageFormatter::add_command(std::string_view name,
+                                 std::string_view description) {
+  commands_.push_back(Row{std::string(name), std::string(description)});
+}
+
+void UsageFormatter::render(std::string &out) const {
+  std::size_t nameWidth(0);
+  for (RowList const *rows : {&options_, &commands_}) {
+    for (Row const &row : *rows) {
+      nameWidth = std::max(nameWidth, row.name.size());
+    }
+  }
+  nameWidth += 2;
+
+  out += "Usage: ";
+  out += program_;
+  out += " [options]";
+  out += arguments_;
+  out += "\n";
+  if (!description_.empty()) {
+    out += "Description: \n ";
+    out += description_;
+    out += "\n\n";
+  }
+
+  out += "Available options:\n";
+  for (Row const &row : options_) {
+    render_row(row, nameWidth, out);
+  }
+  if (!commands_.empty()) {
+    out += "\nAvailable commands:\n";
+    for (Row const &row : commands_) {
+      render_row(row, nameWidth, out);
+    }
+  }
+  out += "\n";
+}
+
+std::size_t UsageFormatter::terminal_width() {
+  char const *const columns = std::getenv("COLUMNS");
+  if (columns != nullptr) {
+    long const width = std::strtol(columns, nullptr, 10);
+    if (width > 0) {
+      return static_cast<std::size_t>(width);
+    }
+  }
+  winsize size{};
+  if (::isatty(STDOUT_FILENO) && ::ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0
+      && size.ws_col > 0) {
+    return size.ws_col;
+  }
+  return 80;
+}
+
+void UsageFormatter::render_row(Row const &row, std::size_t name_width,
+                                std::string &out) const {
+  out += ' ';
+  out += row.name;
+  out.append(name_width - row.name.size(), ' ');
+
+  std::size_t const indent = 1 + name_width;
+  std::size_t const width = width_ > indent + MIN_DESCRIPTION_WIDTH
+                            ? width_ - indent : MIN_DESCRIPTION_WIDTH;
+  std::string_view const description(row.description);
+  std::size_t lineLength(0);
+  std::size_t pos(0);
+  while (pos < description.size()) {
+    if (description[pos] == ' ') {
+      ++pos;
+      continue;
+    }
+    std::size_t end = description.find(' ', pos);
+    if (end == description.npos) {
+      end = description.size();
+    }
+    std::size_t const wordLength = end - pos;
+    if (lineLength > 0 && lineLength + 1 + wordLength > width) {
+      out += '\n';
+      out.append(indent, ' ');
+      lineLength = 0;
+    } else if (lineLength > 0) {
+      out += ' ';
+      ++lineLength;
+    }
+    out.append(description.data() + pos, wordLength);
+    lineLength += wordLength;
+    pos = end;
+  }
+  out += '\n';
+}
+
+}
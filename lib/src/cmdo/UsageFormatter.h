@@ -0,0 +1,81 @@
+#ifndef CMDO_USAGEFORMATTER_H
+#define CMDO_USAGEFORMATTER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cmdo {
+
+/**
+ * @brief Lays out the help printed by print_usage(): a usage line, the
+ * program description, then options and subcommands in two columns. The
+ * name column is as wide as the longest name, and descriptions are wrapped
+ * at word boundaries to fit the width.
+ *
+ * Everything is rendered into a single string, so that it can be kept and
+ * written with one call.
+ */
+class UsageFormatter {
+public:
+  /**
+   * @param[in] width Columns to fit in. 0 uses terminal_width().
+   */
+  explicit UsageFormatter(std::size_t width);
+
+  /**
+   * @param[in] program Name of the program, as shown in the usage line.
+   * @param[in] arguments Shown after "[options]" in the usage line.
+   */
+  void set_program(std::string_view program, std::string_view arguments,
+                   std::string_view description);
+
+  /**
+   * @brief Adds an option, described with its default or "required", and
+   * its current value if is_set.
+   */
+  void add_option(std::string_view name, bool is_switch,
+                  std::string_view description, bool required,
+                  std::string_view default_value, bool is_set,
+                  std::string_view current_value);
+
+  void add_command(std::string_view name, std::string_view description);
+
+  /**
+   * @brief Appends the help to out.
+   */
+  void render(std::string &out) const;
+
+  /**
+   * @brief Columns of the terminal: $COLUMNS if set, else the width of the
+   * terminal on standard output, else 80.
+   */
+  static std::size_t terminal_width();
+
+private:
+  struct Row {
+    std::string name;
+    std::string description;
+  };
+
+  typedef std::vector<Row> RowList;
+
+  /**
+   * @brief Appends row, with its name padded to name_width and its
+   * description wrapped to the width.
+   */
+  void render_row(Row const &row, std::size_t name_width,
+                  std::string &out) const;
+
+  std::size_t width_;
+  std::string program_;
+  std::string arguments_;
+  std::string description_;
+  RowList options_;
+  RowList commands_;
+};
+
+}
+
+#endif //CMDO_USAGEFORMATTER_H
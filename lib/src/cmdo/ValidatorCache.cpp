@@ -0,0 +1,120 @@
+#include "cmdo/ValidatorCache.h"
+#include <iterator>
+
+namespace cmdo {
+
+ValidatorCache::ValidatorCache(std::size_t capacity,
+                               std::chrono::milliseconds ttl)
+    : mutex_(), capacity_(capacity), ttl_(ttl), entries_(), index_(),
+      key_(), hits_(0), misses_(0) {
+}
+
+void ValidatorCache::configure(std::size_t capacity,
+                               std::chrono::milliseconds ttl) {
+  std::unique_lock<std::mutex> l(mutex_);
+  capacity_ = capacity;
+  ttl_ = ttl;
+  while (entries_.size() > capacity_) {
+    erase(std::prev(entries_.end()));
+  }
+}
+
+bool ValidatorCache::find(std::size_t validator, std::string_view option,
+                          std::string_view value, bool &passed) {
+  std::unique_lock<std::mutex> l(mutex_);
+  make_key(validator, option, value);
+  auto const found = index_.find(key_);
+  if (found == index_.end()) {
+    ++misses_;
+    return false;
+  }
+  EntryList::iterator const it = found->second;
+  if (ttl_.count() > 0 && it->expires <= Clock::now()) {
+    erase(it);
+    ++misses_;
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it);
+  passed = it->passed;
+  ++hits_;
+  return true;
+}
+
+void ValidatorCache::insert(std::size_t validator, std::string_view option,
+                            std::string_view value, bool passed) {
+  std::unique_lock<std::mutex> l(mutex_);
+  if (capacity_ == 0) {
+    return;
+  }
+  Clock::time_point const expires = ttl_.count() > 0
+                                    ? Clock::now() + ttl_
+                                    : Clock::time_point::max();
+  make_key(validator, option, value);
+  auto const found = index_.find(key_);
+  if (found != index_.end()) {
+    EntryList::iterator const it = found->second;
+    it->passed = passed;
+    it->expires = expires;
+    entries_.splice(entries_.begin(), entries_, it);
+    return;
+  }
+
+  if (entries_.size() == capacity_) {
+    // Reuse the least recently used entry, and its key's memory.
+    EntryList::iterator const last = std::prev(entries_.end());
+    index_.erase(last->key);
+    entries_.splice(entries_.begin(), entries_, last);
+  } else {
+    entries_.emplace_front();
+  }
+  Entry &entry = entries_.front();
+  entry.key = key_;
+  entry.optionLength = option.size();
+  entry.passed = passed;
+  entry.expires = expires;
+  index_.emplace(entry.key, entries_.begin());
+}
+
+void ValidatorCache::clear() {
+  std::unique_lock<std::mutex> l(mutex_);
+  index_.clear();
+  entries_.clear();
+}
+
+void ValidatorCache::clear(std::string_view option) {
+  std::unique_lock<std::mutex> l(mutex_);
+  for (EntryList::iterator it = entries_.begin(); it != entries_.end();) {
+    EntryList::iterator const next = std::next(it);
+    if (std::string_view(it->key).substr(option_offset(), it->optionLength)
+        == option) {
+      erase(it);
+    }
+    it = next;
+  }
+}
+
+ValidatorCache::Stats ValidatorCache::stats() const {
+  std::unique_lock<std::mutex> l(mutex_);
+  return Stats{hits_, misses_, entries_.size()};
+}
+
+void ValidatorCache::make_key(std::size_t validator, std::string_view option,
+                              std::string_view value) {
+  // validator, then option and value separated by a '\0', which neither
+  // option names nor command line arguments can hold.
+  key_.assign(reinterpret_cast<char const *>(&validator), option_offset());
+  key_.append(option);
+  key_.push_back('\0');
+  key_.append(value);
+}
+
+std::size_t ValidatorCache::option_offset() {
+  return sizeof(std::size_t);
+}
+
+void ValidatorCache::erase(EntryList::iterator it) {
+  index_.erase(it->key);
+  entries_.erase(it);
+}
+
+}
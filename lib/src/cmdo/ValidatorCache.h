@@ -0,0 +1,111 @@
+#ifndef CMDO_VALIDATORCACHE_H
+#define CMDO_VALIDATORCACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cmdo {
+
+/**
+ * @brief Results of validators, keyed by validator, option and value, so
+ * that values seen again are not checked again.
+ *
+ * A bounded LRU: once full, the least recently used result is dropped. With
+ * a time to live, results older than that are checked again. Every member
+ * is thread safe.
+ */
+class ValidatorCache {
+public:
+  struct Stats {
+    // Lookups that found a result.
+    std::uint64_t hits;
+    // Lookups that found nothing, or an expired result.
+    std::uint64_t misses;
+    // Results held.
+    std::size_t size;
+  };
+
+  /**
+   * @param[in] capacity Most results held.
+   * @param[in] ttl Time a result is used. Zero for ever.
+   */
+  ValidatorCache(std::size_t capacity, std::chrono::milliseconds ttl);
+
+  ValidatorCache(ValidatorCache const &) = delete;
+
+  ValidatorCache &operator=(ValidatorCache const &) = delete;
+
+  /**
+   * @brief Changes the limits. Results over the new capacity are dropped,
+   * least recently used first.
+   */
+  void configure(std::size_t capacity, std::chrono::milliseconds ttl);
+
+  /**
+   * @brief Looks up the result of validator for value of option.
+   * @returns true, and sets passed, if it is known.
+   */
+  bool find(std::size_t validator, std::string_view option,
+            std::string_view value, bool &passed);
+
+  void insert(std::size_t validator, std::string_view option,
+              std::string_view value, bool passed);
+
+  /**
+   * @brief Drops every result.
+   */
+  void clear();
+
+  /**
+   * @brief Drops the results for option.
+   */
+  void clear(std::string_view option);
+
+  Stats stats() const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Entry {
+    std::string key;
+    std::size_t optionLength;
+    bool passed;
+    Clock::time_point expires;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  /**
+   * @brief Builds the key of a result into key_.
+   */
+  void make_key(std::size_t validator, std::string_view option,
+                std::string_view value);
+
+  /**
+   * @brief Where the option starts in a key.
+   */
+  static std::size_t option_offset();
+
+  void erase(EntryList::iterator it);
+
+  mutable std::mutex mutex_;
+  std::size_t capacity_;
+  std::chrono::milliseconds ttl_;
+  // Most recently used first.
+  EntryList entries_;
+  std::unordered_map<std::string_view, EntryList::iterator> index_;
+  // Reused to build keys.
+  std::string key_;
+  std::uint64_t hits_;
+  std::uint64_t misses_;
+};
+
+}
+
+#endif //CMDO_VALIDATORCACHE_H
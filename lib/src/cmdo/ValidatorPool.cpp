@@ -0,0 +1,266 @@
+#include "cmdo/ValidatorPool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+
+namespace cmdo {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+enum CheckState : char {
+  PENDING,
+  PASSED,
+  FAILED
+};
+
+std::size_t const NOT_STARTED = SIZE_MAX;
+
+}
+
+// The checks of one run(), which the threads may outlive.
+struct ValidatorPool::Run {
+  Run(CheckList &&list, bool timed)
+      : checks(std::move(list)), states(checks.size(), PENDING),
+        errors(checks.size()), started(checks.size()),
+        nanoseconds(timed ? checks.size() : 0, 0),
+        slots(checks.size(), NOT_STARTED), resolved(0) {
+  }
+
+  CheckList const checks;
+  std::vector<char> states;
+  std::vector<std::exception_ptr> errors;
+  std::vector<Clock::time_point> started;
+  // Time each check ran, if run() was asked for it.
+  std::vector<std::uint64_t> nanoseconds;
+  // Slot of the thread running each check, NOT_STARTED until it starts.
+  std::vector<std::size_t> slots;
+  // Checks done or expired.
+  std::size_t resolved;
+};
+
+// Shared by the pool and its threads, which may outlive it.
+struct ValidatorPool::Shared {
+  struct Job {
+    std::shared_ptr<Run> run;
+    std::size_t index;
+  };
+
+  explicit Shared(std::size_t slots)
+      : generations(slots, 0), stuck(slots, false), abandoned(0),
+        stopping(false) {
+  }
+
+  /**
+   * @brief Threads that can take a check from the queue.
+   */
+  std::size_t usable() const {
+    return stuck.size() - std::count(stuck.begin(), stuck.end(), true);
+  }
+
+  std::mutex mutex;
+  // Notified when a check is queued, or the pool stops.
+  std::condition_variable ready;
+  // Notified when a check starts or is done.
+  std::condition_variable changed;
+  std::deque<Job> jobs;
+  // Bumped when the thread of a slot is replaced.
+  std::vector<std::uint64_t> generations;
+  // Slots whose thread runs an expired check and was not replaced.
+  std::vector<char> stuck;
+  // Replaced threads still running their expired check.
+  unsigned abandoned;
+  bool stopping;
+};
+
+ValidatorPool::ValidatorPool(unsigned threads,
+                             std::chrono::milliseconds timeout)
+    : threads_(std::max(1u, threads)), timeout_(timeout),
+      shared_(std::make_shared<Shared>(threads_)), workers_() {
+  workers_.reserve(threads_);
+  for (std::size_t slot(0); slot < threads_; ++slot) {
+    workers_.emplace_back(work, shared_, slot, 0);
+  }
+}
+
+ValidatorPool::~ValidatorPool() {
+  std::vector<char> stuck;
+  {
+    std::unique_lock<std::mutex> l(shared_->mutex);
+    shared_->stopping = true;
+    stuck = shared_->stuck;
+  }
+  shared_->ready.notify_all();
+  for (std::size_t slot(0); slot < workers_.size(); ++slot) {
+    if (stuck[slot]) {
+      workers_[slot].detach();
+    } else {
+      workers_[slot].join();
+    }
+  }
+}
+
+unsigned ValidatorPool::threads() const {
+  return threads_;
+}
+
+std::chrono::milliseconds ValidatorPool::timeout() const {
+  return timeout_;
+}
+
+void ValidatorPool::run(CheckList checks, std::vector<char> &passed,
+                        std::vector<std::uint64_t> *nanoseconds) const {
+  std::size_t const count = checks.size();
+  passed.assign(count, false);
+  if (nanoseconds != nullptr) {
+    nanoseconds->assign(count, 0);
+  }
+  if (count == 0) {
+    return;
+  }
+
+  std::shared_ptr<Run> const run = std::make_shared<Run>(
+      std::move(checks), nanoseconds != nullptr);
+  std::unique_lock<std::mutex> l(shared_->mutex);
+  if (shared_->usable() == 0) {
+    // Every thread is stuck in an expired check, and none can be added.
+    return;
+  }
+  for (std::size_t i(0); i < count; ++i) {
+    shared_->jobs.push_back(Shared::Job{run, i});
+  }
+  shared_->ready.notify_all();
+
+  while (run->resolved < count) {
+    if (timeout_.count() <= 0) {
+      shared_->changed.wait(l);
+      continue;
+    }
+
+    Clock::time_point const now = Clock::now();
+    Clock::time_point deadline = Clock::time_point::max();
+    for (std::size_t i(0); i < count; ++i) {
+      if (run->states[i] != PENDING || run->slots[i] == NOT_STARTED) {
+        continue;
+      }
+      Clock::time_point const end = run->started[i] + timeout_;
+      if (end > now) {
+        deadline = std::min(deadline, end);
+        continue;
+      }
+      expire(*run, i);
+    }
+    if (run->resolved == count) {
+      break;
+    }
+    if (deadline == Clock::time_point::max()) {
+      shared_->changed.wait(l);
+    } else {
+      shared_->changed.wait_until(l, deadline);
+    }
+  }
+
+  for (std::size_t i(0); i < count; ++i) {
+    if (run->errors[i]) {
+      std::rethrow_exception(run->errors[i]);
+    }
+    passed[i] = run->states[i] == PASSED;
+  }
+  if (nanoseconds != nullptr) {
+    *nanoseconds = std::move(run->nanoseconds);
+  }
+}
+
+void ValidatorPool::expire(Run &run, std::size_t i) const {
+  run.states[i] = FAILED;
+  ++run.resolved;
+  if (!run.nanoseconds.empty()) {
+    run.nanoseconds[i] = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout_)
+            .count());
+  }
+  std::size_t const slot = run.slots[i];
+  if (shared_->abandoned < threads_) {
+    ++shared_->abandoned;
+    workers_[slot].detach();
+    workers_[slot] = std::thread(work, shared_, slot,
+                                 ++shared_->generations[slot]);
+    return;
+  }
+
+  shared_->stuck[slot] = true;
+  if (shared_->usable() > 0) {
+    return;
+  }
+  // Nothing would take the checks not started yet: fail them now.
+  for (std::size_t j(0); j < run.checks.size(); ++j) {
+    if (run.states[j] == PENDING && run.slots[j] == NOT_STARTED) {
+      run.states[j] = FAILED;
+      ++run.resolved;
+    }
+  }
+  std::deque<Shared::Job> &jobs = shared_->jobs;
+  jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                            [&run](Shared::Job const &job) {
+                              return job.run.get() == &run;
+                            }),
+             jobs.end());
+}
+
+void ValidatorPool::work(std::shared_ptr<Shared> shared, std::size_t slot,
+                         std::uint64_t generation) {
+  std::unique_lock<std::mutex> l(shared->mutex);
+  while (true) {
+    shared->ready.wait(l, [&shared]() {
+      return shared->stopping || !shared->jobs.empty();
+    });
+    if (shared->stopping) {
+      return;
+    }
+    Shared::Job const job = std::move(shared->jobs.front());
+    shared->jobs.pop_front();
+    Run &run = *job.run;
+    std::size_t const i = job.index;
+    run.started[i] = Clock::now();
+    run.slots[i] = slot;
+    // run() has a new deadline to wait for.
+    shared->changed.notify_all();
+    l.unlock();
+
+    CheckState state(FAILED);
+    std::exception_ptr error;
+    try {
+      state = run.checks[i]() ? PASSED : FAILED;
+    } catch (...) {
+      error = std::current_exception();
+    }
+    Clock::time_point const end = Clock::now();
+
+    l.lock();
+    if (shared->generations[slot] != generation) {
+      // Expired, and this thread was replaced.
+      --shared->abandoned;
+      return;
+    }
+    if (run.states[i] != PENDING) {
+      // Expired, but this thread was kept: it can take checks again.
+      shared->stuck[slot] = false;
+      continue;
+    }
+    run.states[i] = state;
+    run.errors[i] = error;
+    if (!run.nanoseconds.empty()) {
+      run.nanoseconds[i] = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              end - run.started[i]).count());
+    }
+    ++run.resolved;
+    shared->changed.notify_all();
+  }
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef CMDO_VALIDATORPOOL_H
+#define CMDO_VALIDATORPOOL_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace cmdo {
+
+/**
+ * @brief Runs validators on a fixed set of threads, each check with a
+ * deadline.
+ *
+ * The threads are started with the pool and take checks from a queue. A
+ * check still running when its deadline expires counts as failed and is
+ * not waited for: its thread is left to finish it on its own, and another
+ * one takes its place. At most threads() threads are left that way at
+ * once; past that, a thread whose check expired is not replaced, and when
+ * no thread is left to take checks, the ones not started yet fail at once.
+ * So run() returns at most timeout() after the last check started, and a
+ * validator that never returns costs a bounded number of threads. Checks
+ * own what they use, since they may outlive run().
+ */
+class ValidatorPool {
+public:
+  typedef std::function<bool()> Check;
+  typedef std::vector<Check> CheckList;
+
+  /**
+   * @param[in] threads Checks run at once. At least 1.
+   * @param[in] timeout Time a check is given. Zero waits for ever.
+   */
+  ValidatorPool(unsigned threads, std::chrono::milliseconds timeout);
+
+  ValidatorPool(ValidatorPool const &) = delete;
+
+  ValidatorPool &operator=(ValidatorPool const &) = delete;
+
+  /**
+   * @brief Stops the threads and joins them. The ones still running an
+   * expired check are detached instead, and exit once it returns.
+   */
+  ~ValidatorPool();
+
+  unsigned threads() const;
+
+  std::chrono::milliseconds timeout() const;
+
+  /**
+   * @brief Runs every check, and sets passed[i] to true if checks[i]
+   * returned true before its deadline.
+   * @param[out] nanoseconds If not null, set to the time each check ran,
+   * or the timeout for the ones that expired, 0 for the ones not started.
+   * @throws
+   *   Whatever the first check in the list that threw before its deadline
+   *   threw, once every check is done or expired.
+   */
+  void run(CheckList checks, std::vector<char> &passed,
+           std::vector<std::uint64_t> *nanoseconds = nullptr) const;
+
+private:
+  struct Run;
+  struct Shared;
+
+  /**
+   * @brief Runs the checks of the queue until the pool stops, or until the
+   * thread of slot is replaced (its generation changes).
+   */
+  static void work(std::shared_ptr<Shared> shared, std::size_t slot,
+                   std::uint64_t generation);
+
+  /**
+   * @brief Fails check i of run, which expired, and replaces its thread if
+   * the cap allows it. Called with shared_->mutex held.
+   */
+  void expire(Run &run, std::size_t i) const;
+
+  unsigned threads_;
+  std::chrono::milliseconds timeout_;
+  std::shared_ptr<Shared> shared_;
+  // One per slot; replaced by expire(), under shared_->mutex.
+  mutable std::vector<std::thread> workers_;
+};
+
+}
+
+#endif //CMDO_VALIDATORPOOL_H
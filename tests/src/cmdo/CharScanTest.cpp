@@ -0,0 +1 @@
+#include "cmdo/CharScanTest.h"
@@ -0,0 +1,169 @@
+#ifndef CMDO_CHARSCANTEST_H
+#define CMDO_CHARSCANTEST_H
+
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cmdo/CharScan.h>
+#include <cmdo/StringUtil.h>
+
+namespace char_scan_test {
+
+// trim() and split() as they were before the scanning kernels: the new ones
+// must give exactly the same results.
+inline void reference_trim(std::string &flag) {
+  std::string result;
+  for (size_t i(0); i < flag.size(); ++i) {
+    if (flag[i] == ' ') {
+      continue;
+    }
+    result = flag.substr(i);
+    break;
+  }
+  if (!result.empty()) {
+    size_t i(result.size() - 1);
+    while (true) {
+      if (result[i] != ' ') {
+        result = result.substr(0, i + 1);
+        break;
+      }
+      if (i == 0) {
+        break;
+      }
+      i--;
+    }
+  }
+  flag = result;
+}
+
+inline void reference_split(std::vector<std::string> &result,
+                            std::string const &input, char separator) {
+  auto has_data = [](std::stringstream &ss) -> bool {
+    ss.seekp(0, ss.end);
+    return ss.tellp() != 0;
+  };
+  result.clear();
+  std::stringstream ss;
+  for (char const &c : input) {
+    if (c == separator) {
+      if (has_data(ss)) {
+        result.push_back(ss.str());
+        ss.str("");
+      }
+      continue;
+    }
+    ss << c;
+  }
+  if (has_data(ss)) {
+    result.push_back(ss.str());
+  }
+}
+
+/**
+ * @brief Random strings of every length up to 100, mostly made of the
+ * bytes the kernels look for.
+ */
+inline std::vector<std::string> random_strings() {
+  std::mt19937 random(42);
+  std::string const alphabet(" ,\na\xff");
+  std::vector<std::string> strings;
+  for (std::size_t length(0); length <= 100; ++length) {
+    for (int i(0); i < 20; ++i) {
+      std::string s(length, ' ');
+      // Long runs, so that blocks are often all one byte.
+      std::size_t const kinds = i % 2 == 0 ? 2 : alphabet.size();
+      for (char &c : s) {
+        c = random() % 8 == 0 ? alphabet[random() % kinds] : s.front();
+      }
+      strings.push_back(s);
+    }
+  }
+  return strings;
+}
+
+}
+
+class CharScanTest : public ::testing::Test {
+};
+
+TEST_F(CharScanTest, Kernels_Match_Scalar) {
+  using namespace char_scan_test;
+  std::vector<cmdo::ScanLevel> levels{cmdo::ScanLevel::Scalar};
+  for (cmdo::ScanLevel level : {cmdo::ScanLevel::SSE2,
+                                cmdo::ScanLevel::AVX2}) {
+    if (cmdo::scan_kernels(level) != nullptr) {
+      levels.push_back(level);
+    }
+  }
+  ASSERT_NE(nullptr, cmdo::scan_kernels(cmdo::best_scan_level()));
+
+  for (std::string const &s : random_strings()) {
+    for (std::size_t offset(0); offset < 4 && offset <= s.size(); ++offset) {
+      std::string_view const text = std::string_view(s).substr(offset);
+      for (char c : {' ', ',', '\n', '\xff'}) {
+        for (cmdo::ScanLevel level : levels) {
+          cmdo::ScanKernels const *kernels = cmdo::scan_kernels(level);
+          std::string const what = "level " + std::to_string(int(level))
+                                   + " in \"" + std::string(text) + "\"";
+          EXPECT_EQ(text.find(c),
+                    kernels->find(text.data(), text.size(), c)) << what;
+          EXPECT_EQ(text.find_first_not_of(c),
+                    kernels->find_not(text.data(), text.size(), c)) << what;
+          EXPECT_EQ(text.find_last_not_of(c),
+                    kernels->rfind_not(text.data(), text.size(), c)) << what;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(CharScanTest, Trim_And_Split_Match_Previous_Versions) {
+  using namespace char_scan_test;
+  for (std::string const &s : random_strings()) {
+    std::string expected(s);
+    reference_trim(expected);
+    std::string trimmed(s);
+    cmdo::trim(trimmed);
+    EXPECT_EQ(expected, trimmed) << '"' << s << '"';
+    EXPECT_EQ(expected, cmdo::trim_view(s)) << '"' << s << '"';
+
+    for (char separator : {',', ' ', '\n'}) {
+      std::vector<std::string> expectedItems;
+      reference_split(expectedItems, s, separator);
+      std::vector<std::string> items{"left over"};
+      cmdo::split(items, s, separator);
+      EXPECT_EQ(expectedItems, items) << '"' << s << '"';
+      std::vector<std::string_view> views;
+      cmdo::split_view(views, s, separator);
+      EXPECT_EQ(expectedItems,
+                std::vector<std::string>(views.begin(), views.end()));
+    }
+  }
+}
+
+TEST_F(CharScanTest, Find_Byte_And_Lines) {
+  std::string_view const text("ab\n\ncd\n");
+  EXPECT_EQ(2, cmdo::find_byte(text, '\n'));
+  EXPECT_EQ(3, cmdo::find_byte(text, '\n', 3));
+  EXPECT_EQ(std::string_view::npos, cmdo::find_byte(text, 'x'));
+  EXPECT_EQ(std::string_view::npos, cmdo::find_byte(text, '\n', 7));
+
+  std::vector<std::string_view> lines;
+  cmdo::for_each_line(text, [&lines](std::string_view line) {
+    lines.push_back(line);
+  });
+  EXPECT_EQ((std::vector<std::string_view>{"ab", "cd"}), lines);
+  EXPECT_EQ(text.data() + 4, lines[1].data());
+
+  // "\r\n" ends a line too, and a line of just "\r" is empty.
+  lines.clear();
+  cmdo::for_each_line("a b\r\n\r\nc\rd\r", [&lines](std::string_view line) {
+    lines.push_back(line);
+  });
+  EXPECT_EQ((std::vector<std::string_view>{"a b", "c\rd"}), lines);
+}
+
+#endif //CMDO_CHARSCANTEST_H
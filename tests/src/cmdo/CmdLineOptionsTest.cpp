@@ -1,4 +1,61 @@
 #include "cmdo/CmdLineOptionsTest.h"
+#include <atomic>
+#include <fstream>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations(0);
+
+}
+
+// GCC takes the free() of the replaced operator delete, once inlined, for a
+// mismatch with operator new.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Counts every allocation of the test program, for allocation_count().
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (void *p = std::malloc(size > 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  operator delete(p);
+}
+
+// Used by std::pmr::new_delete_resource().
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  ++allocations;
+  std::size_t const align = static_cast<std::size_t>(alignment);
+  std::size_t const rounded = (size + align - 1) / align * align;
+  if (void *p = std::aligned_alloc(align, rounded > 0 ? rounded : align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t,
+                     std::align_val_t alignment) noexcept {
+  operator delete(p, alignment);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 CmdLineOptionsTest::CmdLineOptionsTest()
     : noopHandler_([](cmdo::CmdLineOptions::StringList const &,
@@ -31,4 +88,14 @@ void CmdLineOptionsTest::create_argv(int *argc_out, char ***argv_out,
   *argv_out = argv_;
 }
 
+std::string CmdLineOptionsTest::write_file(std::string const &name,
+                                           std::string const &contents) {
+  std::string const path = ::testing::TempDir() + name;
+  std::ofstream out(path, std::ios::out | std::ios::trunc);
+  out << contents;
+  return path;
+}
 
+std::uint64_t CmdLineOptionsTest::allocation_count() {
+  return allocations;
+}
@@ -2,7 +2,15 @@
 #define CMDO_CMDLINEOPTIONSTEST_H
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <string>
 #include <cmdo/CmdLineOptions.h>
@@ -15,6 +23,18 @@ public:
                           std::vector<std::string> const &args,
                           std::string const &program_name = "test_program");
 
+  /**
+   * @brief Writes contents to a file in the test temp directory.
+   * @returns The path of the file.
+   */
+  static std::string write_file(std::string const &name,
+                                std::string const &contents);
+
+  /**
+   * @brief Number of times operator new was called so far.
+   */
+  static std::uint64_t allocation_count();
+
 protected:
   // avoids program exit.
   cmdo::CmdLineOptions::ParserResultHandler noopHandler_;
@@ -215,6 +235,168 @@ TEST_F(CmdLineOptionsTest, Add_Throws_On_Bad_Option) {
                cmdo::BadOption);
 }
 
+TEST_F(CmdLineOptionsTest, Add_Throws_On_Defined_Option) {
+  std::string const desc("test program");
+  cmdo::CmdLineOptions gf(desc);
+  gf.add_optional("-a1", "argument #1", "empty");
+  gf.add_switch("-s1", "switch #1", false);
+  EXPECT_THROW(gf.add_required("-a1", "argument #1 again"),
+               cmdo::OptionDefined);
+  EXPECT_THROW(gf.add_switch(" -a1 ", "argument #1 as a switch", true),
+               cmdo::OptionDefined);
+  EXPECT_THROW(gf.add_optional("-s1", "switch #1 as argument", "x"),
+               cmdo::OptionDefined);
+  EXPECT_THROW(gf.add_switch("-h", "help again", false),
+               cmdo::OptionDefined);
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Many_Options) {
+  std::vector<std::string> args;
+  std::string const desc("test program");
+  cmdo::CmdLineOptions gf(desc);
+  gf.set_parser_result_handler(noopHandler_);
+  for (int i(0); i < 2000; ++i) {
+    std::string const n = std::to_string(i);
+    gf.add_optional("-a" + n, "argument", "def" + n);
+    gf.add_switch("-s" + n, "switch", false);
+    if (i % 3 == 0) {
+      args.push_back("-a" + n);
+      args.push_back("val" + n);
+      args.push_back("-s" + n);
+    }
+  }
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, args);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  gf.parse(argc, argv, leftOvers);
+  EXPECT_TRUE(leftOvers.empty());
+  for (int i(0); i < 2000; ++i) {
+    std::string const n = std::to_string(i);
+    EXPECT_EQ((i % 3 == 0 ? "val" : "def") + n, gf.get_option("-a" + n));
+    EXPECT_EQ(i % 3 == 0, gf.get_switch("-s" + n));
+  }
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Copies_Values) {
+  int argc;
+  char **argv;
+  std::vector<std::string> const args{{"-a1"},
+                                      {"a1_value"}};
+  create_argv(&argc, &argv, args);
+
+  cmdo::CmdLineOptions gf("test program");
+  gf.set_parser_result_handler(noopHandler_);
+  gf.add_optional("-a1", "argument #1", "empty");
+  cmdo::CmdLineOptions::StringList leftOvers;
+  gf.parse(argc, argv, leftOvers);
+
+  argv[2][0] = 'X';
+  EXPECT_EQ("a1_value", gf.get_option("-a1"));
+  EXPECT_EQ("a1_value", gf.get_option_view("-a1"));
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Views_Point_Into_Argv) {
+  int argc;
+  char **argv;
+  std::vector<std::string> const args{{"left1"},
+                                      {"-a1"},
+                                      {"a1_value"},
+                                      {"left2"}};
+  create_argv(&argc, &argv, args);
+
+  cmdo::CmdLineOptions gf("test program");
+  gf.set_parser_result_handler(noopHandler_);
+  gf.add_optional("-a1", "argument #1", "empty");
+  gf.add_optional("-a2", "argument #2", "empty");
+  cmdo::CmdLineOptions::ViewList leftOvers;
+  gf.parse(argc, argv, leftOvers);
+
+  ASSERT_EQ(2, leftOvers.size());
+  EXPECT_EQ(argv[1], leftOvers[0].data());
+  EXPECT_EQ(argv[4], leftOvers[1].data());
+  EXPECT_EQ("left1", leftOvers[0]);
+  EXPECT_EQ("left2", leftOvers[1]);
+
+  EXPECT_EQ(argv[3], gf.get_option_view("-a1").data());
+  EXPECT_EQ("a1_value", gf.get_option("-a1"));
+  EXPECT_EQ("empty", gf.get_option_view("-a2"));
+  EXPECT_THROW(gf.get_option_view("-a3"), cmdo::UndefinedOption);
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Typed_Options) {
+  int argc;
+  char **argv;
+  std::vector<std::string> const args{{"-threads"},
+                                      {"8"},
+                                      {"-ratio"},
+                                      {"0.25"}};
+  create_argv(&argc, &argv, args);
+
+  cmdo::CmdLineOptions gf("test program");
+  gf.set_parser_result_handler(noopHandler_);
+  gf.add_required<int>("-threads", "number of threads");
+  gf.add_optional("-ratio", "a ratio", 0.5);
+  gf.add_optional("-batch_size", "batch size", 64);
+  gf.add_optional("-verbose", "verbose output", false);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  gf.parse(argc, argv, leftOvers);
+
+  EXPECT_EQ(8, gf.get_option_as<int>("-threads"));
+  EXPECT_EQ(0.25, gf.get_option_as<double>("-ratio"));
+  EXPECT_EQ(64, gf.get_option_as<int>("-batch_size"));
+  EXPECT_FALSE(gf.get_option_as<bool>("-verbose"));
+  // The text of the value is still there.
+  EXPECT_EQ("8", gf.get_option("-threads"));
+  EXPECT_EQ("64", gf.get_option("-batch_size"));
+  // Other types are converted from the text.
+  EXPECT_EQ(8L, gf.get_option_as<long>("-threads"));
+  EXPECT_THROW(gf.get_option_as<int>("-undefined"), cmdo::UndefinedOption);
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Reports_Typed_Options_That_Fail_To_Convert) {
+  int argc;
+  char **argv;
+  std::vector<std::string> const args{{"-threads"},
+                                      {"many"},
+                                      {"-ratio"},
+                                      {"0.25"}};
+  create_argv(&argc, &argv, args);
+
+  cmdo::CmdLineOptions gf("test program");
+  cmdo::CmdLineOptions::StringList invalidList;
+  cmdo::CmdLineOptions::StringList missingList;
+  gf.set_parser_result_handler([&invalidList, &missingList](
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &missing,
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &invalid) {
+    invalidList = invalid;
+    missingList = missing;
+  });
+  gf.add_optional("-threads", "number of threads", 1);
+  gf.add_optional("-ratio", "a ratio", 0.5);
+  gf.add_required<int>("-count", "a count");
+
+  bool validatorCalled(false);
+  gf.attach_validator("-threads", [&validatorCalled](std::string const &,
+                                                     std::string const &) {
+    validatorCalled = true;
+    return true;
+  });
+  cmdo::CmdLineOptions::StringList leftOvers;
+  gf.parse(argc, argv, leftOvers);
+
+  ASSERT_EQ(1, invalidList.size());
+  EXPECT_EQ("-threads", invalidList[0]);
+  ASSERT_EQ(1, missingList.size());
+  EXPECT_EQ("-count", missingList[0]);
+  EXPECT_FALSE(validatorCalled);
+  EXPECT_EQ(0.25, gf.get_option_as<double>("-ratio"));
+  EXPECT_THROW(gf.get_option_as<int>("-count"), cmdo::OptionNotSet);
+}
+
 TEST_F(CmdLineOptionsTest, Parse_Stores_Unknown_Options_In_LeftOvers) {
   int argc;
   char **argv;
@@ -239,4 +421,1390 @@ TEST_F(CmdLineOptionsTest, Parse_Stores_Unknown_Options_In_LeftOvers) {
 }
 
 
+TEST_F(CmdLineOptionsTest, Reload_Config_File) {
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-in", "argv.txt"});
+
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_required("-in", "input file");
+  options.add_optional("-level", "log level", "info");
+  options.add_required<int>("-threads", "number of threads");
+  options.add_switch("-verbose", "more output", false);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_THROW(options.get_option_as<int>("-threads"), cmdo::OptionNotSet);
+
+  std::string const path = write_file("reload.conf",
+                                      "# comment\n"
+                                      "\n"
+                                      "-in file.txt\n"
+                                      "-level = debug\n"
+                                      "-threads=4\n"
+                                      "-verbose\n");
+  cmdo::CmdLineOptions::StringList problems;
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+  EXPECT_TRUE(problems.empty());
+  // argv takes precedence over the file.
+  EXPECT_EQ("argv.txt", options.get_option("-in"));
+  EXPECT_EQ("debug", options.get_option("-level"));
+  EXPECT_EQ(4, options.get_option_as<int>("-threads"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+
+  write_file("reload.conf", "-threads 8\n-verbose false\n");
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+  EXPECT_EQ("info", options.get_option("-level"));
+  EXPECT_EQ(8, options.get_option_as<int>("-threads"));
+  EXPECT_FALSE(options.get_switch("-verbose"));
+}
+
+TEST_F(CmdLineOptionsTest, Reload_Keeps_Old_Values_On_Problems) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional<int>("-threads", "number of threads", 2);
+  options.add_switch("-verbose", "more output", false);
+  options.add_required("-in", "input file");
+
+  cmdo::CmdLineOptions::StringList problems;
+  std::string const path = write_file("problems.conf",
+                                      "-in a.txt\n-threads 4\n");
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+
+  std::vector<std::pair<std::string, std::string>> const bad{
+      {"-in a.txt\n-threads four\n", "-threads"},
+      {"-in a.txt\n-verbose maybe\n", "-verbose"},
+      {"-in\n", "-in"},
+      {"-threads 5\n", "-in"}
+  };
+  for (auto const &contents : bad) {
+    write_file("problems.conf", contents.first);
+    EXPECT_FALSE(options.reload_config_file(path, problems));
+    ASSERT_EQ(1, problems.size()) << contents.first;
+    EXPECT_EQ(contents.second, problems[0]);
+    EXPECT_EQ(4, options.get_option_as<int>("-threads"));
+    EXPECT_EQ("a.txt", options.get_option("-in"));
+  }
+
+  // Options that are not defined are skipped.
+  write_file("problems.conf", "-in b.txt\n-unknown 1\n");
+  EXPECT_TRUE(options.reload_config_file(path, problems));
+  EXPECT_EQ("b.txt", options.get_option("-in"));
+
+  EXPECT_FALSE(options.reload_config_file(path + ".missing", problems));
+  ASSERT_EQ(1, problems.size());
+  EXPECT_EQ(path + ".missing", problems[0]);
+}
+
+TEST_F(CmdLineOptionsTest, Snapshots_Outlive_Reloads) {
+  cmdo::CmdLineOptions options("test");
+  options.add_optional("-level", "log level", "info");
+  options.add_optional<double>("-ratio", "a ratio", 0.5);
+
+  cmdo::CmdLineOptions::SnapshotPtr const before = options.snapshot();
+  std::string const path = write_file("snapshot.conf",
+                                      "-level debug\n-ratio 0.25\n");
+  cmdo::CmdLineOptions::StringList problems;
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+  cmdo::CmdLineOptions::SnapshotPtr const after = options.snapshot();
+
+  write_file("snapshot.conf", "-level warning\n");
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+
+  EXPECT_EQ("info", before->get_option("-level"));
+  EXPECT_EQ(0.5, before->get_option_as<double>("-ratio"));
+  EXPECT_EQ("debug", after->get_option_view("-level"));
+  EXPECT_EQ(0.25, after->get_option_as<double>("-ratio"));
+  EXPECT_EQ("warning", options.get_option("-level"));
+  EXPECT_THROW(after->get_option("-undefined"), cmdo::UndefinedOption);
+}
+
+TEST_F(CmdLineOptionsTest, Change_Handlers_Get_Changed_Names) {
+  cmdo::CmdLineOptions options("test");
+  options.add_optional("-level", "log level", "info");
+  options.add_optional("-out", "output file", "out.txt");
+  options.add_switch("-verbose", "more output", false);
+  EXPECT_THROW(options.add_change_handler(
+      cmdo::CmdLineOptions::ChangeHandler()), cmdo::BadFunction);
+
+  std::vector<cmdo::CmdLineOptions::StringList> calls;
+  options.add_change_handler([&calls](
+      cmdo::CmdLineOptions::StringList const &changed) {
+    calls.push_back(changed);
+  });
+
+  std::string const path = write_file("change.conf",
+                                      "-level debug\n-verbose\n");
+  cmdo::CmdLineOptions::StringList problems;
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+  ASSERT_EQ(1, calls.size());
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"-level", "-verbose"}),
+            calls[0]);
+
+  // Nothing changed, no call.
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+  EXPECT_EQ(1, calls.size());
+
+  write_file("change.conf", "-level debug\n-out out.txt\n");
+  ASSERT_TRUE(options.reload_config_file(path, problems));
+  ASSERT_EQ(2, calls.size());
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"-out", "-verbose"}), calls[1]);
+}
+
+TEST_F(CmdLineOptionsTest, Watch_Config_File) {
+  cmdo::CmdLineOptions options("test");
+  options.add_optional<int>("-threads", "number of threads", 1);
+
+  std::string const path = write_file("watch.conf", "-threads 2\n");
+  cmdo::CmdLineOptions::StringList problems;
+  ASSERT_TRUE(options.watch_config_file(path, problems));
+  EXPECT_EQ(2, options.get_option_as<int>("-threads"));
+
+  write_file("watch.conf", "-threads 3\n");
+  for (int i(0); i < 500 && options.get_option_as<int>("-threads") != 3; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(3, options.get_option_as<int>("-threads"));
+  options.stop_watching_config_file();
+}
+
+TEST_F(CmdLineOptionsTest, Read_While_Reloading) {
+  cmdo::CmdLineOptions options("test");
+  options.add_optional("-a", "value a", "0");
+  options.add_optional("-b", "value b", "0");
+
+  std::string const path = write_file("concurrent.conf", "-a 1\n-b 1\n");
+  std::atomic<bool> done(false);
+  std::atomic<int> inconsistent(0);
+  std::vector<std::thread> readers;
+  for (int i(0); i < 4; ++i) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        // Values from one snapshot are always consistent.
+        cmdo::CmdLineOptions::SnapshotPtr const s = options.snapshot();
+        if (s->get_option_view("-a") != s->get_option_view("-b")) {
+          ++inconsistent;
+        }
+      }
+    });
+  }
+
+  cmdo::CmdLineOptions::StringList problems;
+  for (int i(0); i < 50; ++i) {
+    std::string const value = std::to_string(i);
+    write_file("concurrent.conf", "-a " + value + "\n-b " + value + "\n");
+    ASSERT_TRUE(options.reload_config_file(path, problems));
+  }
+  done = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, inconsistent);
+  EXPECT_EQ("49", options.get_option("-a"));
+}
+
+
+TEST_F(CmdLineOptionsTest, Parse_Response_File) {
+  std::string contents("-out\nout dir\n-verbose\n");
+  for (int i(0); i < 1000; ++i) {
+    contents += "/data/input" + std::to_string(i) + ".txt\n";
+  }
+  std::string const path = write_file("args.rsp", contents);
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"first", "@" + path, "-in", "a.txt", "last"});
+
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_required("-in", "input file");
+  options.add_required("-out", "output dir");
+  options.add_switch("-verbose", "more output", false);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("a.txt", options.get_option("-in"));
+  EXPECT_EQ("out dir", options.get_option("-out"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+  ASSERT_EQ(1002, leftOvers.size());
+  EXPECT_EQ("first", leftOvers.front());
+  EXPECT_EQ("/data/input0.txt", leftOvers[1]);
+  EXPECT_EQ("/data/input999.txt", leftOvers[1000]);
+  EXPECT_EQ("last", leftOvers.back());
+
+  cmdo::CmdLineOptions::ViewList views;
+  options.parse(argc, argv, views);
+  ASSERT_EQ(1002, views.size());
+  EXPECT_EQ("/data/input0.txt", views[1]);
+  EXPECT_EQ("out dir", options.get_option_view("-out"));
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Keeps_Missing_Response_File) {
+  std::string const path = write_file("value.rsp", "-in\nfrom file\n");
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"@", "@/no/such/file", "-in", "@in", "-out",
+                             "@" + path});
+
+  cmdo::CmdLineOptions options("test");
+  cmdo::CmdLineOptions::StringList invalidList;
+  options.set_parser_result_handler(
+      [&invalidList](cmdo::CmdLineOptions::StringList const &,
+                     cmdo::CmdLineOptions::StringList const &,
+                     cmdo::CmdLineOptions::StringList const &,
+                     cmdo::CmdLineOptions::StringList const &invalid) {
+        invalidList = invalid;
+      });
+  options.add_optional("-in", "input file", "");
+  options.add_optional("-out", "output file", "");
+  options.add_switch("@in", "not a file", false);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_TRUE(invalidList.empty());
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"@", "@/no/such/file"}),
+            leftOvers);
+  // Option names and values are never read as files.
+  EXPECT_EQ("@in", options.get_option("-in"));
+  EXPECT_EQ("@" + path, options.get_option("-out"));
+
+  cmdo::CmdLineOptions::ViewList views;
+  options.parse(argc, argv, views);
+  EXPECT_EQ(2, views.size());
+  EXPECT_EQ("@" + path, options.get_option("-out"));
+
+  std::vector<std::string> positionals;
+  options.parse(argc, argv, [&positionals](std::string_view arg) {
+    positionals.emplace_back(arg);
+  });
+  EXPECT_EQ((std::vector<std::string>{"@", "@/no/such/file"}), positionals);
+  EXPECT_EQ("@" + path, options.get_option("-out"));
+
+  // The default handler doesn't take the argument for an invalid option.
+  cmdo::CmdLineOptions defaults("test");
+  defaults.add_optional("-out", "output file", "");
+  defaults.parse(argc, argv, leftOvers);
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"@", "@/no/such/file", "-in",
+                                              "@in"}), leftOvers);
+}
+
+
+TEST_F(CmdLineOptionsTest, Parse_Streams_Positionals_To_Sink) {
+  std::string contents("-out\nout dir\n");
+  for (int i(0); i < 1000; ++i) {
+    contents += "/data/input" + std::to_string(i) + ".txt\n";
+  }
+  contents += "-in";
+  std::string const path = write_file("stream.rsp", contents);
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"first", "-verbose", "@" + path, "a.txt",
+                             "@/no/such/file", "-level"});
+
+  cmdo::CmdLineOptions options("test");
+  bool handlerCalled(false);
+  cmdo::CmdLineOptions::StringList invalidList;
+  cmdo::CmdLineOptions::StringList noValueList;
+  options.set_parser_result_handler(
+      [&](cmdo::CmdLineOptions::StringList const &unknown,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &no_value,
+          cmdo::CmdLineOptions::StringList const &invalid) {
+        handlerCalled = true;
+        EXPECT_TRUE(unknown.empty());
+        noValueList = no_value;
+        invalidList = invalid;
+      });
+  options.add_required("-in", "input file");
+  options.add_required("-out", "output dir");
+  options.add_optional("-level", "log level", "info");
+  options.add_switch("-verbose", "more output", false);
+  EXPECT_THROW(options.parse(argc, argv,
+                             cmdo::CmdLineOptions::PositionalSink()),
+               cmdo::BadFunction);
+
+  std::vector<std::string> positionals;
+  options.parse(argc, argv, [&](std::string_view arg) {
+    EXPECT_FALSE(handlerCalled);
+    positionals.emplace_back(arg);
+  });
+  EXPECT_TRUE(handlerCalled);
+  ASSERT_EQ(1002, positionals.size());
+  EXPECT_EQ("first", positionals.front());
+  EXPECT_EQ("/data/input999.txt", positionals[1000]);
+  EXPECT_EQ("@/no/such/file", positionals.back());
+  // The value of the last line of the file is the next argument.
+  EXPECT_EQ("a.txt", options.get_option("-in"));
+  EXPECT_EQ("out dir", options.get_option("-out"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+  EXPECT_TRUE(invalidList.empty());
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-level"}, noValueList);
+}
+
+
+TEST_F(CmdLineOptionsTest, Parse_Config_File) {
+  std::string const path = write_file("parse.conf",
+                                      "# shared by several programs\n"
+                                      "-in file.txt\r\n"
+                                      "-other-program-option 12\n"
+                                      "-level=debug\r\n"
+                                      "-threads 16\n"
+                                      "-verbose yes\n");
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-level", "warning"});
+
+  cmdo::CmdLineOptions options("test");
+  cmdo::CmdLineOptions::StringList missingList;
+  cmdo::CmdLineOptions::StringList invalidList;
+  options.set_parser_result_handler(
+      [&](cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &missing,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &invalid) {
+        missingList = missing;
+        invalidList = invalid;
+      });
+  options.add_required("-in", "input file");
+  options.add_optional("-level", "log level", "info");
+  options.add_optional("-out", "output file", "out.txt");
+  options.add_optional<int>("-threads", "number of threads", 1);
+  options.add_switch("-verbose", "more output", false);
+  options.attach_validator("-threads", [](std::string const &,
+                                          std::string const &value) {
+    return value.size() == 1;
+  });
+  options.set_config_file(path);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_TRUE(missingList.empty());
+  // Validators run on values from the file.
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-threads"}, invalidList);
+  EXPECT_EQ("file.txt", options.get_option("-in"));
+  EXPECT_EQ("warning", options.get_option("-level"));
+  EXPECT_EQ("out.txt", options.get_option("-out"));
+  EXPECT_EQ(16, options.get_option_as<int>("-threads"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+
+  // Required options may come from either source.
+  write_file("parse.conf", "-level debug\n");
+  options.set_config_file(path);
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-in"}, missingList);
+  EXPECT_TRUE(invalidList.empty());
+
+  cmdo::CmdLineOptions::StringList unreadableList;
+  options.set_file_error_handler(
+      [&](cmdo::CmdLineOptions::StringList const &paths) {
+        unreadableList = paths;
+      });
+  options.set_config_file(path + ".missing");
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{path + ".missing"},
+            unreadableList);
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-in"}, missingList);
+  EXPECT_TRUE(invalidList.empty());
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Config_File_With_Bad_Values) {
+  std::string const path = write_file("bad.conf",
+                                      "-in file.txt\n"
+                                      "-verbose maybe\n");
+  int argc;
+  char **argv;
+  // The missing response file is kept as a positional; it doesn't drop the
+  // config file.
+  create_argv(&argc, &argv, {"@/no/such/file"});
+
+  cmdo::CmdLineOptions options("test");
+  cmdo::CmdLineOptions::StringList invalidList;
+  options.set_parser_result_handler(
+      [&](cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &invalid) {
+        invalidList = invalid;
+      });
+  options.add_required("-in", "input file");
+  options.add_switch("-verbose", "more output", false);
+  options.set_config_file(path);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-verbose"}, invalidList);
+  EXPECT_EQ("file.txt", options.get_option("-in"));
+  EXPECT_FALSE(options.get_switch("-verbose"));
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"@/no/such/file"}, leftOvers);
+
+  // The default handler prints the text from the file.
+  cmdo::CmdLineOptions defaults("test");
+  defaults.add_required("-in", "input file");
+  defaults.add_switch("-verbose", "more output", false);
+  defaults.set_config_file(path);
+  EXPECT_EXIT(defaults.parse(argc, argv, leftOvers),
+              ::testing::ExitedWithCode(EXIT_FAILURE),
+              "invalid argument: -verbose = maybe");
+  defaults.set_config_file(path + ".missing");
+  EXPECT_EXIT(defaults.parse(argc, argv, leftOvers),
+              ::testing::ExitedWithCode(EXIT_FAILURE),
+              "cannot read file: .*bad.conf.missing");
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Environment_Variables) {
+  ::setenv("CMDO_TEST_THREADS", "8", 1);
+  ::setenv("CMDO_TEST_LEVEL", "debug", 1);
+  ::setenv("CMDO_TEST_VERBOSE", "yes", 1);
+  ::setenv("CMDO_TEST_QUIET", "maybe", 1);
+  ::setenv("CMDO_TEST_OUT", "env.txt", 1);
+  ::unsetenv("CMDO_TEST_IN");
+  std::string const path = write_file("env.conf",
+                                      "-level info\n-ratio 0.5\n");
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-out", "argv.txt"});
+
+  cmdo::CmdLineOptions options("test");
+  cmdo::CmdLineOptions::StringList missingList;
+  cmdo::CmdLineOptions::StringList invalidList;
+  options.set_parser_result_handler(
+      [&](cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &missing,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &invalid) {
+        missingList = missing;
+        invalidList = invalid;
+      });
+  options.add_required("-in", "input file", "CMDO_TEST_IN");
+  options.add_optional("-out", "output file", "out.txt", "CMDO_TEST_OUT");
+  options.add_optional("-level", "log level", "warning", "CMDO_TEST_LEVEL");
+  options.add_optional<double>("-ratio", "a ratio", 0.25, "CMDO_TEST_RATIO");
+  options.add_required<int>("-threads", "number of threads",
+                            "CMDO_TEST_THREADS");
+  options.add_switch("-verbose", "more output", false, "CMDO_TEST_VERBOSE");
+  options.add_switch("-quiet", "less output", false, "CMDO_TEST_QUIET");
+  EXPECT_THROW(options.add_optional("-threads2", "", "", "CMDO_TEST_THREADS"),
+               cmdo::OptionDefined);
+  EXPECT_THROW(options.add_switch("-bad", "", false, "A=B"), cmdo::BadOption);
+  // Failed definitions leave nothing behind.
+  options.add_switch("-bad", "", false);
+  options.attach_validator("-threads", [](std::string const &,
+                                          std::string const &value) {
+    return value != "8";
+  });
+  options.set_config_file(path);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-in"}, missingList);
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"-quiet", "-threads"}),
+            invalidList);
+  // argv > environment > config file > default.
+  EXPECT_EQ("argv.txt", options.get_option("-out"));
+  EXPECT_EQ("debug", options.get_option("-level"));
+  EXPECT_EQ(0.5, options.get_option_as<double>("-ratio"));
+  EXPECT_EQ(8, options.get_option_as<int>("-threads"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+
+  // The environment is read again by every parse().
+  ::setenv("CMDO_TEST_IN", "env_in.txt", 1);
+  ::setenv("CMDO_TEST_THREADS", "4", 1);
+  ::unsetenv("CMDO_TEST_QUIET");
+  options.parse(argc, argv, leftOvers);
+  EXPECT_TRUE(missingList.empty());
+  EXPECT_TRUE(invalidList.empty());
+  EXPECT_EQ("env_in.txt", options.get_option("-in"));
+  EXPECT_EQ(4, options.get_option_as<int>("-threads"));
+
+  // The default handler prints the text of the variable.
+  ::setenv("CMDO_TEST_QUIET", "maybe", 1);
+  cmdo::CmdLineOptions defaults("test");
+  defaults.add_switch("-quiet", "less output", false, "CMDO_TEST_QUIET");
+  EXPECT_EXIT(defaults.parse(argc, argv, leftOvers),
+              ::testing::ExitedWithCode(EXIT_FAILURE),
+              "invalid argument: -quiet = maybe");
+
+  for (char const *name : {"CMDO_TEST_IN", "CMDO_TEST_OUT", "CMDO_TEST_LEVEL",
+                           "CMDO_TEST_THREADS", "CMDO_TEST_VERBOSE",
+                           "CMDO_TEST_QUIET"}) {
+    ::unsetenv(name);
+  }
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Again_Starts_Clean) {
+  int argc1;
+  char **argv1;
+  create_argv(&argc1, &argv1, {"-a1", "first", "-s1"});
+  int argc2;
+  char **argv2;
+  create_argv(&argc2, &argv2, {"-a2", "second"}, "other_program");
+
+  cmdo::CmdLineOptions options("test program");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-a1", "argument #1", "empty");
+  options.add_optional("-a2", "argument #2", "empty");
+  options.add_switch("-s1", "switch #1", false);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc1, argv1, leftOvers);
+  cmdo::CmdLineOptions::SnapshotPtr const first = options.snapshot();
+
+  for (int i(0); i < 100; ++i) {
+    cmdo::CmdLineOptions::ViewList views;
+    options.parse(argc1, argv1, views);
+    options.parse(argc2, argv2, leftOvers);
+    EXPECT_EQ("empty", options.get_option("-a1"));
+    EXPECT_EQ("second", options.get_option_view("-a2"));
+    EXPECT_FALSE(options.get_switch("-s1"));
+    EXPECT_EQ("other_program", options.program_name());
+  }
+
+  // Snapshots taken before keep their values.
+  EXPECT_EQ("first", first->get_option_view("-a1"));
+  EXPECT_EQ("empty", first->get_option("-a2"));
+  EXPECT_TRUE(first->get_switch("-s1"));
+}
+
+TEST_F(CmdLineOptionsTest, Reset_Restores_Defaults) {
+  ::setenv("CMDO_TEST_RESET", "env", 1);
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-a1", "a1_value", "-a2", "a2_value", "-s1"});
+
+  cmdo::CmdLineOptions options("test program");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-a1", "argument #1", "empty");
+  options.add_optional("-a2", "argument #2", "empty", "CMDO_TEST_RESET");
+  options.add_switch("-s1", "switch #1", false);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("a1_value", options.get_option("-a1"));
+  EXPECT_EQ("a2_value", options.get_option("-a2"));
+  EXPECT_TRUE(options.get_switch("-s1"));
+
+  std::vector<std::string> changedNames;
+  options.add_change_handler(
+      [&](cmdo::CmdLineOptions::StringList const &changed) {
+        changedNames = changed;
+      });
+  options.reset();
+  EXPECT_EQ("empty", options.get_option("-a1"));
+  EXPECT_EQ("env", options.get_option("-a2"));
+  EXPECT_FALSE(options.get_switch("-s1"));
+  EXPECT_EQ((std::vector<std::string>{"-a1", "-a2", "-s1"}), changedNames);
+  ::unsetenv("CMDO_TEST_RESET");
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Command_Line_String) {
+  std::string const path = write_file("command_line.args", "-a2\nfrom file\n");
+  cmdo::CmdLineOptions options("test program");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-a1", "argument #1", "empty");
+  options.add_optional("-a2", "argument #2", "empty");
+  options.add_switch("-s1", "switch #1", false);
+
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse("/usr/bin/prog -a1 'hello world' left\\ over -s1", leftOvers);
+  EXPECT_EQ("/prog", options.program_name());
+  EXPECT_EQ("hello world", options.get_option("-a1"));
+  EXPECT_EQ("empty", options.get_option("-a2"));
+  EXPECT_TRUE(options.get_switch("-s1"));
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"left over"}, leftOvers);
+
+  options.parse("prog \"@" + path + "\"", leftOvers);
+  EXPECT_EQ("empty", options.get_option("-a1"));
+  EXPECT_EQ("from file", options.get_option("-a2"));
+  EXPECT_TRUE(leftOvers.empty());
+
+  EXPECT_THROW(options.parse("prog -a1 'oops", leftOvers),
+               cmdo::BadCommandLine);
+  EXPECT_EQ("from file", options.get_option("-a2"));
+  options.reset();
+  EXPECT_EQ("empty", options.get_option("-a1"));
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Batch) {
+  std::vector<cmdo::CmdLineOptions::StringList> argvs;
+  for (int i(0); i < 1000; ++i) {
+    cmdo::CmdLineOptions::StringList argv{"/bin/job" + std::to_string(i)};
+    if (i % 3 != 0) {
+      argv.insert(argv.end(), {"-in", "input" + std::to_string(i)});
+    }
+    if (i % 5 == 0) {
+      argv.push_back("-verbose");
+    }
+    argv.insert(argv.end(), {"-threads", std::to_string(i % 10), "left"});
+    if (i % 7 == 0) {
+      argv.push_back("-level");
+    }
+    argvs.push_back(argv);
+  }
+
+  std::atomic<int> validated(0);
+  auto define = [&validated](cmdo::CmdLineOptions &options) {
+    options.add_required("-in", "input file");
+    options.add_optional("-level", "log level", "warning");
+    options.add_optional<int>("-threads", "number of threads", 1);
+    options.add_switch("-verbose", "more output", false);
+    options.attach_validator("-threads", [&validated](
+        std::string const &, std::string const &value) {
+      ++validated;
+      return value != "9";
+    });
+  };
+  cmdo::CmdLineOptions batch("test");
+  batch.set_parser_result_handler(noopHandler_);
+  define(batch);
+  cmdo::CmdLineOptions::BatchResultList const results =
+      batch.parse_batch(argvs, 4);
+  ASSERT_EQ(argvs.size(), results.size());
+  EXPECT_EQ(1000, validated);
+
+  // Same results as parse(), and the values of batch are left alone.
+  cmdo::CmdLineOptions::BatchResult expected;
+  cmdo::CmdLineOptions single("test");
+  single.set_parser_result_handler(
+      [&expected](cmdo::CmdLineOptions::StringList const &,
+                  cmdo::CmdLineOptions::StringList const &missing,
+                  cmdo::CmdLineOptions::StringList const &empty,
+                  cmdo::CmdLineOptions::StringList const &invalid) {
+        expected.missing_options = missing;
+        expected.options_with_no_value = empty;
+        expected.invalid_options = invalid;
+      });
+  define(single);
+  for (std::size_t i(0); i < argvs.size(); ++i) {
+    int argc;
+    char **argv;
+    create_argv(&argc, &argv,
+                cmdo::CmdLineOptions::StringList(argvs[i].begin() + 1,
+                                                 argvs[i].end()),
+                argvs[i][0]);
+    single.parse(argc, argv, expected.left_overs);
+
+    cmdo::CmdLineOptions::BatchResult const &result = results[i];
+    EXPECT_EQ(expected.left_overs, result.left_overs);
+    EXPECT_EQ(expected.missing_options, result.missing_options);
+    EXPECT_EQ(expected.options_with_no_value, result.options_with_no_value);
+    EXPECT_EQ(expected.invalid_options, result.invalid_options);
+    EXPECT_EQ(single.program_name(), result.options->program_name());
+    EXPECT_EQ(single.get_option("-level"),
+              result.options->get_option("-level"));
+    EXPECT_EQ(single.get_option_as<int>("-threads"),
+              result.options->get_option_as<int>("-threads"));
+    EXPECT_EQ(single.get_switch("-verbose"),
+              result.options->get_switch("-verbose"));
+    if (i % 3 != 0) {
+      EXPECT_EQ(single.get_option("-in"), result.options->get_option("-in"));
+    }
+  }
+  EXPECT_THROW(batch.get_option("-in"), cmdo::OptionNotSet);
+  EXPECT_EQ(1, batch.get_option_as<int>("-threads"));
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Batch_Rethrows_Validator_Exceptions) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-a1", "argument #1", "empty");
+  options.attach_validator("-a1", [](std::string const &,
+                                     std::string const &value) -> bool {
+    if (value == "bad") {
+      throw std::runtime_error("bad");
+    }
+    return true;
+  });
+  std::vector<cmdo::CmdLineOptions::StringList> argvs(
+      100, cmdo::CmdLineOptions::StringList{"prog", "-a1", "good"});
+  argvs[50][2] = "bad";
+  EXPECT_THROW(options.parse_batch(argvs, 4), std::runtime_error);
+  argvs[50][2] = "good";
+  EXPECT_EQ(100, options.parse_batch(argvs).size());
+  EXPECT_TRUE(options.parse_batch({}).empty());
+}
+
+TEST_F(CmdLineOptionsTest, Concurrent_Validators) {
+  cmdo::CmdLineOptions::StringList invalid;
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler([&invalid](
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &invalid_options) {
+    invalid = invalid_options;
+  });
+  options.add_optional("-a1", "argument #1", "x");
+  options.add_optional<int>("-a2", "argument #2", 0);
+  options.add_optional("-a3", "argument #3", "x");
+  options.add_optional("-a4", "argument #4", "x");
+  auto const is_ok = [](std::string const &, std::string const &value) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return value != "bad";
+  };
+  options.attach_validator("-a1", is_ok);
+  options.attach_validator("-a2", is_ok);
+  options.attach_validator("-a3", is_ok);
+  options.attach_validator("-a3", is_ok);
+  options.attach_validator("-a4", [](std::string const &,
+                                     std::string const &value) {
+    if (value == "slow") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    }
+    return true;
+  });
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-a1", "bad", "-a2", "two", "-a3", "bad",
+                             "-a4", "ok"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  cmdo::CmdLineOptions::StringList const sequential = invalid;
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"-a1", "-a2", "-a3", "-a3"}),
+            sequential);
+
+  // Same list, in the same order.
+  options.set_validator_threads(4, std::chrono::milliseconds(500));
+  for (int i(0); i < 5; ++i) {
+    options.parse(argc, argv, leftOvers);
+    EXPECT_EQ(sequential, invalid);
+  }
+
+  // A validator that does not return in time fails.
+  create_argv(&argc, &argv, {"-a1", "ok", "-a4", "slow"});
+  auto const start = std::chrono::steady_clock::now();
+  options.parse(argc, argv, leftOvers);
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(900));
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-a4"}, invalid);
+
+  options.set_validator_threads(0);
+  options.parse(argc, argv, leftOvers);
+  EXPECT_TRUE(invalid.empty());
+}
+
+TEST_F(CmdLineOptionsTest, Cached_Validators) {
+  cmdo::CmdLineOptions::StringList invalid;
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler([&invalid](
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &,
+      cmdo::CmdLineOptions::StringList const &invalid_options) {
+    invalid = invalid_options;
+  });
+  options.add_optional("-a1", "argument #1", "ok");
+  options.add_optional("-a2", "argument #2", "ok");
+  int cachedCalls(0);
+  int otherCalls(0);
+  options.attach_validator("-a1", [&cachedCalls](std::string const &,
+                                                 std::string const &value) {
+    ++cachedCalls;
+    return value != "bad";
+  }, true);
+  options.attach_validator("-a2", [&otherCalls](std::string const &,
+                                                std::string const &) {
+    ++otherCalls;
+    return true;
+  });
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-a1", "bad"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  for (int i(0); i < 3; ++i) {
+    options.parse(argc, argv, leftOvers);
+    EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-a1"}, invalid);
+  }
+  EXPECT_EQ(1, cachedCalls);
+  EXPECT_EQ(3, otherCalls);
+  cmdo::ValidatorCache::Stats stats = options.validator_cache_stats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(1, stats.misses);
+
+  options.invalidate_validator_cache("-a2");
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(1, cachedCalls);
+  options.invalidate_validator_cache("-a1");
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(2, cachedCalls);
+  options.invalidate_validator_cache();
+  options.set_validator_threads(2);
+  options.parse(argc, argv, leftOvers);
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(3, cachedCalls);
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"-a1"}, invalid);
+
+  options.set_validator_cache(0);
+  options.parse(argc, argv, leftOvers);
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(5, cachedCalls);
+}
+
+TEST_F(CmdLineOptionsTest, Abbreviations) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional<int>("-threads", "threads", 1);
+  options.add_optional("-throttle", "throttle", "none");
+  options.add_switch("-v", "short verbose", false);
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-thre", "4", "-thro", "x", "-verb"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(1, options.get_option_as<int>("-threads"));
+  EXPECT_EQ(5, leftOvers.size());
+
+  options.set_abbreviations(true);
+  // Options added once enabled are found too.
+  options.add_switch("-verbose", "verbose", false);
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(4, options.get_option_as<int>("-threads"));
+  EXPECT_EQ("x", options.get_option("-throttle"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+  EXPECT_FALSE(options.get_switch("-v"));
+  EXPECT_TRUE(leftOvers.empty());
+
+  // Ambiguous prefixes, and exact names, are not abbreviations.
+  create_argv(&argc, &argv, {"-thr", "-v", "-"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"-thr", "-"}), leftOvers);
+  EXPECT_TRUE(options.get_switch("-v"));
+  EXPECT_FALSE(options.get_switch("-verbose"));
+
+  options.set_abbreviations(false);
+  create_argv(&argc, &argv, {"-thre", "4"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(2, leftOvers.size());
+}
+
+TEST_F(CmdLineOptionsTest, Suggestions) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional<int>("-threads", "threads", 1);
+  options.add_optional("-in", "input", "none");
+  options.add_switch("-verbose", "verbose", false);
+
+  EXPECT_EQ("-threads", options.suggest_option("-thread"));
+  EXPECT_EQ("-threads", options.suggest_option("-thraeds"));
+  EXPECT_EQ("-verbose", options.suggest_option("-verbos"));
+  EXPECT_EQ("-in", options.suggest_option("-n"));
+  EXPECT_EQ("", options.suggest_option("-threads"));
+  EXPECT_EQ("", options.suggest_option("-trhaeds"));
+  EXPECT_EQ("", options.suggest_option("file.txt"));
+  EXPECT_EQ("", options.suggest_option(""));
+}
+
+TEST_F(CmdLineOptionsTest, Suggestions_In_Default_Handler) {
+  cmdo::CmdLineOptions options("test");
+  options.add_optional<int>("-threads", "threads", 1);
+  options.add_optional("-out", "output file", "out.txt");
+  options.add_switch("-v", "verbose", false);
+  options.set_suggestions(true);
+
+  int argc;
+  char **argv;
+  // Positional arguments are not typos, even when close to an option.
+  create_argv(&argc, &argv, {"file.txt", "out", "-5", "-"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"file.txt", "out", "-5", "-"}),
+            leftOvers);
+
+  create_argv(&argc, &argv, {"-thread", "4"});
+  EXPECT_EXIT(options.parse(argc, argv, leftOvers),
+              ::testing::ExitedWithCode(EXIT_FAILURE),
+              "unknown option: -thread, did you mean -threads\\?");
+}
+
+TEST_F(CmdLineOptionsTest, Subcommands) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_switch("-v", "verbose", false);
+  options.add_optional("-C", "directory", ".");
+  int commitBuilt(0);
+  int pushBuilt(0);
+  options.add_subcommand("commit", "Records changes.",
+                         [this, &commitBuilt](cmdo::CmdLineOptions &commit) {
+    ++commitBuilt;
+    commit.set_parser_result_handler(noopHandler_);
+    commit.add_optional("-m", "message", "");
+    commit.add_switch("-v", "show the diff", false);
+  });
+  options.add_subcommand("push", "Sends commits.",
+                         [&pushBuilt](cmdo::CmdLineOptions &) {
+    ++pushBuilt;
+  });
+  EXPECT_THROW(options.add_subcommand("push", "again",
+                                      [](cmdo::CmdLineOptions &) {}),
+               cmdo::OptionDefined);
+  EXPECT_THROW(options.add_subcommand("pull", "none", nullptr),
+               cmdo::BadFunction);
+
+  int argc;
+  char **argv;
+  // "commit" after -C is its value, not the subcommand.
+  create_argv(&argc, &argv, {"-C", "commit", "a", "-v", "commit", "-m",
+                             "fix", "-v", "b"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(1, commitBuilt);
+  EXPECT_EQ(0, pushBuilt);
+  EXPECT_EQ("commit", options.subcommand_name());
+  EXPECT_EQ("commit", options.get_option("-C"));
+  EXPECT_TRUE(options.get_switch("-v"));
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"a", "b"}), leftOvers);
+  cmdo::CmdLineOptions &commit = options.subcommand();
+  EXPECT_EQ("fix", commit.get_option("-m"));
+  EXPECT_TRUE(commit.get_switch("-v"));
+  EXPECT_EQ("commit", commit.program_name());
+
+  // The factory only runs once.
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(1, commitBuilt);
+
+  create_argv(&argc, &argv, {"-v"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("", options.subcommand_name());
+  EXPECT_THROW(options.subcommand(), cmdo::UndefinedOption);
+  EXPECT_THROW(options.subcommand("pull"), cmdo::UndefinedOption);
+  options.subcommand("push");
+  EXPECT_EQ(1, pushBuilt);
+
+  // Zero-copy and streaming parse() too.
+  create_argv(&argc, &argv, {"push", "origin"});
+  cmdo::CmdLineOptions::ViewList views;
+  options.parse(argc, argv, views);
+  EXPECT_EQ("push", options.subcommand_name());
+  EXPECT_EQ(cmdo::CmdLineOptions::ViewList{"origin"}, views);
+  cmdo::CmdLineOptions::StringList streamed;
+  options.parse(argc, argv, [&streamed](std::string_view arg) {
+    streamed.emplace_back(arg);
+  });
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"origin"}, streamed);
+}
+
+TEST_F(CmdLineOptionsTest, Subcommands_After_Response_Files) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_switch("-v", "verbose", false);
+  options.add_optional("-C", "directory", ".");
+  options.add_subcommand("commit", "Records changes.",
+                         [this](cmdo::CmdLineOptions &commit) {
+    commit.set_parser_result_handler(noopHandler_);
+    commit.add_optional("-m", "message", "");
+  });
+  std::string const optionsFile = write_file("options.rsp", "-v\n-C\nsrc\n");
+  std::string const dangling = write_file("dangling.rsp", "-v\n-C\n");
+  std::string const named = write_file("named.rsp", "commit\n-m\nfix\n");
+
+  int argc;
+  char **argv;
+  cmdo::CmdLineOptions::StringList leftOvers;
+  create_argv(&argc, &argv, {"@" + optionsFile, "commit", "-m", "fix"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("commit", options.subcommand_name());
+  EXPECT_EQ("src", options.get_option("-C"));
+  EXPECT_EQ("fix", options.subcommand().get_option("-m"));
+
+  // The file ends with -C, so "commit" is its value.
+  create_argv(&argc, &argv, {"@" + dangling, "commit"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("", options.subcommand_name());
+  EXPECT_EQ("commit", options.get_option("-C"));
+  cmdo::CmdLineOptions::StringList streamed;
+  options.parse(argc, argv, [&streamed](std::string_view arg) {
+    streamed.emplace_back(arg);
+  });
+  EXPECT_EQ("", options.subcommand_name());
+  EXPECT_TRUE(streamed.empty());
+
+  // A subcommand name in a response file is a positional argument.
+  create_argv(&argc, &argv, {"@" + named});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("", options.subcommand_name());
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"commit", "-m", "fix"}),
+            leftOvers);
+}
+
+TEST_F(CmdLineOptionsTest, Subcommand_Usage) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_subcommand("commit", "Records changes.",
+                         [this](cmdo::CmdLineOptions &commit) {
+    commit.set_parser_result_handler(noopHandler_);
+    commit.add_optional("-m", "message", "");
+  });
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"commit", "-m", "x"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+
+  std::ostringstream usage;
+  options.print_usage(usage);
+  EXPECT_NE(std::string::npos, usage.str().find(
+      "Usage: test_program [options] <command> [command options]\n"));
+  EXPECT_NE(std::string::npos, usage.str().find("Available commands:\n"));
+  EXPECT_NE(std::string::npos, usage.str().find("Records changes."));
+
+  std::ostringstream commitUsage;
+  options.subcommand().print_usage(commitUsage);
+  EXPECT_NE(std::string::npos, commitUsage.str().find(
+      "Usage: test_program commit [options]\n"));
+  EXPECT_NE(std::string::npos, commitUsage.str().find("-m [...]"));
+  EXPECT_EQ(std::string::npos, commitUsage.str().find("commands"));
+}
+
+TEST_F(CmdLineOptionsTest, Usage_Is_Kept_Until_Options_Change) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.set_usage_width(40);
+  options.add_optional("-o", "an option with a description longer than "
+                             "the width", "x");
+
+  std::ostringstream first;
+  options.print_usage(first);
+  EXPECT_NE(std::string::npos, first.str().find(
+      " -o [...]  an option with a description\n"
+      "           longer than the width (def =\n"
+      "           x)\n"));
+  std::ostringstream again;
+  options.print_usage(again);
+  EXPECT_EQ(first.str(), again.str());
+
+  options.add_switch("-longer-switch", "s", false);
+  std::ostringstream added;
+  options.print_usage(added);
+  EXPECT_NE(std::string::npos, added.str().find(" -longer-switch  s"));
+  EXPECT_NE(std::string::npos, added.str().find(" -o [...]        an"));
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-o", "y"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  std::ostringstream parsed;
+  options.print_usage(parsed);
+  EXPECT_NE(std::string::npos, parsed.str().find("curr = y"));
+
+  options.set_usage_width(200);
+  std::ostringstream wide;
+  options.print_usage(wide);
+  EXPECT_NE(std::string::npos, wide.str().find(
+      "longer than the width (def = x, curr = y)\n"));
+}
+
+TEST_F(CmdLineOptionsTest, Print_Usage_While_Parsing) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-o", "an option", "x");
+
+  std::atomic<bool> done(false);
+  std::atomic<int> incomplete(0);
+  std::thread printer([&]() {
+    while (!done) {
+      std::ostringstream out;
+      options.print_usage(out);
+      if (out.str().find(" -o ") == std::string::npos) {
+        ++incomplete;
+      }
+    }
+  });
+  int argc;
+  char **argv;
+  cmdo::CmdLineOptions::StringList leftOvers;
+  for (int i(0); i < 200; ++i) {
+    create_argv(&argc, &argv, {"-o", std::to_string(i)});
+    options.parse(argc, argv, leftOvers);
+    options.set_usage_width(40 + i % 40);
+  }
+  done = true;
+  printer.join();
+  EXPECT_EQ(0, incomplete);
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Lists) {
+  ::setenv("CMDO_TEST_SHARDS", "4,5", 1);
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-I", "a", "x", "-shards", "1,2,,3", "-I", "b",
+                             "-tags", "p:q", "-shards", "7"});
+
+  cmdo::CmdLineOptions options("test");
+  cmdo::CmdLineOptions::StringList invalidList;
+  options.set_parser_result_handler(
+      [&](cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &,
+          cmdo::CmdLineOptions::StringList const &invalid) {
+        invalidList = invalid;
+      });
+  options.add_list("-I", "include directories");
+  options.add_list<int>("-shards", "shard numbers", ',', "CMDO_TEST_SHARDS");
+  options.add_list("-tags", "tags", ':');
+  options.add_list("-empty", "never given", ',');
+  options.attach_validator("-tags", [](std::string const &,
+                                       std::string const &value) {
+    return value.size() == 1;
+  });
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+
+  EXPECT_TRUE(invalidList.empty());
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"x"}, leftOvers);
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), options.get_list("-I"));
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 7}),
+            options.get_list_as<int>("-shards"));
+  EXPECT_EQ((std::vector<std::string>{"1", "2", "3", "7"}),
+            options.get_list("-shards"));
+  EXPECT_EQ((std::vector<std::string>{"p", "q"}), options.get_list("-tags"));
+  EXPECT_TRUE(options.get_list("-empty").empty());
+  // The last value given.
+  EXPECT_EQ("b", options.get_option("-I"));
+  EXPECT_THROW(options.get_list("-undefined"), cmdo::UndefinedOption);
+  EXPECT_TRUE(options.schema().is_list("-I"));
+  EXPECT_FALSE(options.schema().is_list("-h"));
+
+  // Items are validated and converted one by one.
+  create_argv(&argc, &argv, {"-tags", "p:long", "-shards", "1,two"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ((cmdo::CmdLineOptions::StringList{"-shards", "-tags"}),
+            invalidList);
+
+  // Lists start empty again, and come from the environment.
+  create_argv(&argc, &argv, {});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_TRUE(invalidList.empty());
+  EXPECT_TRUE(options.get_list("-I").empty());
+  EXPECT_EQ((std::vector<int>{4, 5}), options.get_list_as<int>("-shards"));
+  ::unsetenv("CMDO_TEST_SHARDS");
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Lists_From_Config_File) {
+  std::string const path = write_file("lists.conf",
+                                      "-include a\n"
+                                      "-shards 1,2\n"
+                                      "-include b\n"
+                                      "-shards = 3\n");
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {});
+
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_list("-include", "include directories");
+  options.add_list<int>("-shards", "shard numbers", ',');
+  options.set_config_file(path);
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  // Every line adds items, as on the command line.
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), options.get_list("-include"));
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), options.get_list_as<int>("-shards"));
+  EXPECT_EQ("b", options.get_option("-include"));
+
+  // The command line replaces the items of the file.
+  create_argv(&argc, &argv, {"-include", "c"});
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(std::vector<std::string>{"c"}, options.get_list("-include"));
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), options.get_list_as<int>("-shards"));
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Lists_Zero_Copy) {
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-I", "a,b", "-I", "c"});
+
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_list("-I", "include directories", ',');
+  std::vector<std::string> changes;
+  options.add_change_handler(
+      [&changes](cmdo::CmdLineOptions::StringList const &names) {
+        changes.insert(changes.end(), names.begin(), names.end());
+      });
+  cmdo::CmdLineOptions::ViewList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), options.get_list("-I"));
+
+  // Same last value, different list.
+  create_argv(&argc, &argv, {"-I", "c"});
+  changes.clear();
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ((std::vector<std::string>{"c"}), options.get_list("-I"));
+  EXPECT_EQ(std::vector<std::string>{"-I"}, changes);
+}
+
+TEST_F(CmdLineOptionsTest, Save_And_Load_Schema) {
+  std::string const path = ::testing::TempDir() + "options.schema";
+  std::string usage;
+  {
+    cmdo::CmdLineOptions options("test");
+    options.add_required("-in", "input file");
+    options.add_optional<int>("-threads", "number of threads", 2,
+                              "CMDO_SCHEMA_THREADS");
+    options.add_list("-I", "include directories", ',');
+    options.add_switch("-verbose", "more output", false,
+                       "CMDO_SCHEMA_VERBOSE");
+    std::ostringstream out;
+    options.print_usage(out);
+    usage = out.str();
+    ASSERT_TRUE(options.save_schema(path));
+  }
+  ::setenv("CMDO_SCHEMA_VERBOSE", "yes", 1);
+
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-replaced", "gone after loading", "x");
+  ASSERT_TRUE(options.load_schema(path));
+  std::ostringstream out;
+  options.print_usage(out);
+  EXPECT_EQ(usage, out.str());
+  options.add_switch("-quiet", "less output", false);
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-in", "a.txt", "-I", "x,y", "-quiet"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ("a.txt", options.get_option("-in"));
+  EXPECT_EQ(2, options.get_option_as<int>("-threads"));
+  EXPECT_EQ((std::vector<std::string>{"x", "y"}), options.get_list("-I"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+  EXPECT_TRUE(options.get_switch("-quiet"));
+  EXPECT_THROW(options.get_option("-replaced"), cmdo::UndefinedOption);
+  EXPECT_TRUE(leftOvers.empty());
+  ::unsetenv("CMDO_SCHEMA_VERBOSE");
+
+  // Nothing changes if the file is not a schema.
+  EXPECT_FALSE(options.load_schema(write_file("bad.schema", "-in a.txt\n")));
+  EXPECT_FALSE(options.load_schema(path + ".missing"));
+  EXPECT_EQ("a.txt", options.get_option("-in"));
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Stats) {
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-in", "input file", "a.txt");
+  options.add_switch("-verbose", "more output", false);
+  options.attach_validator("-in", [](std::string const &,
+                                     std::string const &value) {
+    return !value.empty();
+  });
+  std::uint64_t allocations(0);
+  options.set_allocation_counter([&allocations]() {
+    return allocations += 3;
+  });
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-in", "b.txt", "-verbose", "extra"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  options.parse(argc, argv, leftOvers);
+
+  cmdo::ParseStats const stats = options.stats();
+  EXPECT_EQ(cmdo::STATS_ENABLED, stats.enabled);
+  EXPECT_LT(0u, stats.schema_bytes);
+  EXPECT_LT(0u, stats.value_bytes);
+  EXPECT_EQ(0u, stats.mapped_bytes);
+  std::ostringstream out;
+  options.print_stats(out);
+  if (!cmdo::STATS_ENABLED) {
+    EXPECT_EQ(0u, stats.parses);
+    EXPECT_EQ(0u, stats.tokens);
+    EXPECT_TRUE(stats.validators.empty());
+    EXPECT_NE(std::string::npos, out.str().find("enabled: false\n"));
+    return;
+  }
+  EXPECT_EQ(2u, stats.parses);
+  EXPECT_EQ(8u, stats.tokens);
+  // The value of -in is not looked up.
+  EXPECT_EQ(6u, stats.lookups);
+  EXPECT_EQ(6u, stats.allocations);
+  EXPECT_LE(stats.loop_ns + stats.merge_ns, stats.parse_ns);
+  EXPECT_LE(stats.validator_ns, stats.merge_ns);
+  ASSERT_EQ(1u, stats.validators.size());
+  EXPECT_EQ("-in", stats.validators[0].option);
+  EXPECT_EQ(0u, stats.validators[0].validator);
+  EXPECT_EQ(2u, stats.validators[0].calls);
+  EXPECT_NE(std::string::npos, out.str().find("parses: 2\n"));
+  EXPECT_NE(std::string::npos, out.str().find("validator -in#0: 2 calls"));
+
+  options.reset_stats();
+  EXPECT_EQ(0u, options.stats().parses);
+
+  // Validators run on threads are timed one by one too.
+  options.set_validator_threads(2, std::chrono::milliseconds(1000));
+  options.parse(argc, argv, leftOvers);
+  cmdo::ParseStats const threaded = options.stats();
+  ASSERT_EQ(1u, threaded.validators.size());
+  EXPECT_EQ("-in", threaded.validators[0].option);
+  EXPECT_EQ(1u, threaded.validators[0].calls);
+  EXPECT_LE(threaded.validators[0].ns, threaded.validator_ns);
+}
+
+TEST_F(CmdLineOptionsTest, Parse_Again_Does_Not_Allocate) {
+  ::setenv("CMDO_TEST_OUT", "some/directory/with/an/output.txt", 1);
+  cmdo::CmdLineOptions options("test");
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional("-in", "input file", "a.txt");
+  options.add_optional("-out", "output file", "b.txt", "CMDO_TEST_OUT");
+  options.add_optional<int>("-threads", "number of threads", 2);
+  options.add_list<int>("-ids", "ids", ',');
+  options.add_switch("-verbose", "more output", false);
+  options.attach_validator("-in", [](std::string const &,
+                                     std::string const &value) {
+    return !value.empty();
+  });
+
+  int argc;
+  char **argv;
+  // Longer than the strings kept inline.
+  create_argv(&argc, &argv, {"-in", "some/directory/with/an/input.txt",
+                             "-threads", "8", "-ids", "1,2,3", "-verbose",
+                             "extra"}, "/usr/local/bin/test_program");
+  cmdo::CmdLineOptions::StringList leftOvers;
+  // Parses alternate between two snapshots: the first ones size the buffers
+  // of both, and the values each converts into.
+  options.parse(argc, argv, leftOvers);
+  options.parse(argc, argv, leftOvers);
+  std::uint64_t const allocations = allocation_count();
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(allocations, allocation_count());
+
+  EXPECT_EQ("some/directory/with/an/input.txt", options.get_option("-in"));
+  EXPECT_EQ("some/directory/with/an/output.txt", options.get_option("-out"));
+  EXPECT_EQ(8, options.get_option_as<int>("-threads"));
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), options.get_list_as<int>("-ids"));
+  EXPECT_TRUE(options.get_switch("-verbose"));
+  EXPECT_EQ(cmdo::CmdLineOptions::StringList{"extra"}, leftOvers);
+  ::unsetenv("CMDO_TEST_OUT");
+}
+
+TEST_F(CmdLineOptionsTest, Allocate_From_Memory_Resource) {
+  std::pmr::monotonic_buffer_resource arena;
+  cmdo::CmdLineOptions options("test", "", &arena);
+  options.set_parser_result_handler(noopHandler_);
+  options.add_optional<int>("-threads", "number of threads", 2);
+  EXPECT_EQ(&arena, options.schema().memory_resource());
+
+  int argc;
+  char **argv;
+  create_argv(&argc, &argv, {"-threads", "8"});
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  cmdo::CmdLineOptions::SnapshotPtr const snapshot = options.snapshot();
+  EXPECT_EQ(&arena, snapshot->memory_resource());
+  EXPECT_EQ(8, snapshot->get_option_as<int>("-threads"));
+
+  // One thread, since the arena isn't thread safe.
+  cmdo::CmdLineOptions::BatchResultList const results = options.parse_batch(
+      {{"prog", "-threads", "4"}}, 1);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(&arena, results[0].options->memory_resource());
+  EXPECT_EQ(4, results[0].options->get_option_as<int>("-threads"));
+}
+
 #endif //CMDO_CMDLINEOPTIONSTEST_H
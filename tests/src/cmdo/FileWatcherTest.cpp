@@ -0,0 +1 @@
+#include "cmdo/FileWatcherTest.h"
@@ -0,0 +1,54 @@
+#ifndef CMDO_FILEWATCHERTEST_H
+#define CMDO_FILEWATCHERTEST_H
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <cmdo/CmdLineOptions.h>
+#include <cmdo/FileWatcher.h>
+
+class FileWatcherTest : public ::testing::Test {
+
+};
+
+TEST_F(FileWatcherTest, Throws_On_Bad_Function) {
+  EXPECT_THROW(cmdo::FileWatcher(::testing::TempDir() + "bad.conf",
+                                 cmdo::FileWatcher::ChangeFunction()),
+               cmdo::BadFunction);
+}
+
+TEST_F(FileWatcherTest, Calls_On_Write_And_Replace) {
+  std::string const path = ::testing::TempDir() + "watched.conf";
+  std::ofstream(path) << "1";
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  int calls(0);
+  cmdo::FileWatcher watcher(path, [&]() {
+    std::unique_lock<std::mutex> l(mutex);
+    ++calls;
+    changed.notify_all();
+  });
+  EXPECT_EQ(path, watcher.path());
+
+  auto wait_for_call = [&](int count) {
+    std::unique_lock<std::mutex> l(mutex);
+    return changed.wait_for(l, std::chrono::seconds(5), [&]() {
+      return calls >= count;
+    });
+  };
+
+  std::ofstream(path) << "2";
+  EXPECT_TRUE(wait_for_call(1));
+
+  std::string const replacement = path + ".new";
+  std::ofstream(replacement) << "3";
+  ASSERT_EQ(0, std::rename(replacement.c_str(), path.c_str()));
+  EXPECT_TRUE(wait_for_call(2));
+}
+
+#endif //CMDO_FILEWATCHERTEST_H
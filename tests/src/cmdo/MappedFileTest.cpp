@@ -0,0 +1 @@
+#include "cmdo/MappedFileTest.h"
@@ -0,0 +1,46 @@
+#ifndef CMDO_MAPPEDFILETEST_H
+#define CMDO_MAPPEDFILETEST_H
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <cmdo/MappedFile.h>
+
+class MappedFileTest : public ::testing::Test {
+
+};
+
+TEST_F(MappedFileTest, Map_File) {
+  std::string const path = ::testing::TempDir() + "mapped.txt";
+  std::ofstream(path) << "key value\n";
+
+  cmdo::MappedFile file(path);
+  ASSERT_TRUE(file.is_open());
+  EXPECT_EQ("key value\n", file.contents());
+
+  std::ofstream(path, std::ios::trunc);
+  cmdo::MappedFile empty(path);
+  EXPECT_TRUE(empty.is_open());
+  EXPECT_TRUE(empty.contents().empty());
+}
+
+TEST_F(MappedFileTest, Keeps_Contents_When_Replaced) {
+  std::string const path = ::testing::TempDir() + "replaced.txt";
+  std::ofstream(path) << "old";
+  cmdo::MappedFile file(path);
+
+  std::string const replacement = path + ".new";
+  std::ofstream(replacement) << "new contents";
+  ASSERT_EQ(0, std::rename(replacement.c_str(), path.c_str()));
+  EXPECT_EQ("old", file.contents());
+  EXPECT_EQ("new contents", cmdo::MappedFile(path).contents());
+}
+
+TEST_F(MappedFileTest, Fails_On_Missing_File_Or_Directory) {
+  EXPECT_FALSE(cmdo::MappedFile(::testing::TempDir() + "missing").is_open());
+  EXPECT_FALSE(cmdo::MappedFile(::testing::TempDir()).is_open());
+  EXPECT_TRUE(cmdo::MappedFile(::testing::TempDir()).contents().empty());
+}
+
+#endif //CMDO_MAPPEDFILETEST_H
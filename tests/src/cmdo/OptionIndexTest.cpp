@@ -0,0 +1 @@
+#include "cmdo/OptionIndexTest.h"
@@ -0,0 +1,163 @@
+#ifndef CMDO_OPTIONINDEXTEST_H
+#define CMDO_OPTIONINDEXTEST_H
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <cmdo/OptionIndex.h>
+
+class OptionIndexTest : public ::testing::Test {
+
+};
+
+TEST_F(OptionIndexTest, Insert_And_Find) {
+  cmdo::OptionIndex index;
+  EXPECT_TRUE(index.insert("-s1", cmdo::OptionIndex::Kind::Switch, 0));
+  EXPECT_TRUE(index.insert("-a1", cmdo::OptionIndex::Kind::Arg, 0));
+  EXPECT_TRUE(index.insert("-a2", cmdo::OptionIndex::Kind::Arg, 1));
+  EXPECT_EQ(3, index.size());
+
+  cmdo::OptionIndex::Entry e = index.find("-a2");
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Arg, e.kind);
+  EXPECT_EQ(1, e.position);
+
+  e = index.find(std::string("-s1"));
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Switch, e.kind);
+  EXPECT_EQ(0, e.position);
+
+  EXPECT_FALSE(index.find("-a3").found());
+  EXPECT_FALSE(index.find("-a").found());
+  EXPECT_FALSE(index.find("-a1x").found());
+  EXPECT_FALSE(index.find("").found());
+}
+
+TEST_F(OptionIndexTest, Insert_Rejects_Duplicates) {
+  cmdo::OptionIndex index;
+  EXPECT_TRUE(index.insert("-a1", cmdo::OptionIndex::Kind::Arg, 0));
+  EXPECT_FALSE(index.insert("-a1", cmdo::OptionIndex::Kind::Switch, 4));
+  EXPECT_EQ(1, index.size());
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Arg, index.find("-a1").kind);
+}
+
+TEST_F(OptionIndexTest, Find_With_Length_Does_Not_Need_Terminator) {
+  cmdo::OptionIndex index;
+  index.insert("-in", cmdo::OptionIndex::Kind::Arg, 7);
+  char const buffer[] = "-input";
+  EXPECT_EQ(7, index.find(buffer, 3).position);
+  EXPECT_FALSE(index.find(buffer, 6).found());
+}
+
+TEST_F(OptionIndexTest, Grows_Past_Initial_Capacity) {
+  cmdo::OptionIndex index;
+  for (std::size_t i(0); i < 5000; ++i) {
+    ASSERT_TRUE(index.insert("-opt" + std::to_string(i),
+                             cmdo::OptionIndex::Kind::Arg, i));
+  }
+  EXPECT_EQ(5000, index.size());
+  for (std::size_t i(0); i < 5000; ++i) {
+    cmdo::OptionIndex::Entry const e = index.find("-opt" + std::to_string(i));
+    ASSERT_TRUE(e.found());
+    EXPECT_EQ(i, e.position);
+  }
+  EXPECT_FALSE(index.find("-opt5000").found());
+}
+
+TEST_F(OptionIndexTest, Clear) {
+  cmdo::OptionIndex index;
+  index.insert("-a1", cmdo::OptionIndex::Kind::Arg, 0);
+  index.clear();
+  EXPECT_EQ(0, index.size());
+  EXPECT_FALSE(index.find("-a1").found());
+  EXPECT_TRUE(index.insert("-a1", cmdo::OptionIndex::Kind::Switch, 0));
+}
+
+TEST_F(OptionIndexTest, Attach_Uses_Saved_Table_In_Place) {
+  cmdo::OptionIndex saved;
+  saved.insert("-s1", cmdo::OptionIndex::Kind::Switch, 0);
+  for (int i(0); i < 40; ++i) {
+    saved.insert("-a" + std::to_string(i), cmdo::OptionIndex::Kind::Arg, i);
+  }
+  std::string_view const table = saved.table_bytes();
+  std::vector<std::uint64_t> aligned(table.size() / sizeof(std::uint64_t));
+  std::memcpy(aligned.data(), table.data(), table.size());
+  std::string const names(saved.name_bytes());
+  std::string_view const copy(reinterpret_cast<char const *>(aligned.data()),
+                              table.size());
+
+  cmdo::OptionIndex index;
+  EXPECT_FALSE(index.attach(copy.substr(1), names, 41, 1, 40));
+  EXPECT_FALSE(index.attach(copy.substr(0, copy.size() / 4 * 3), names, 41,
+                            1, 40));
+  ASSERT_TRUE(index.attach(copy, names, 41, 1, 40));
+  EXPECT_EQ(41, index.size());
+  EXPECT_EQ(copy.data(), index.table_bytes().data());
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Switch, index.find("-s1").kind);
+  EXPECT_EQ(39, index.find("-a39").position);
+  EXPECT_FALSE(index.find("-a40").found());
+
+  // Copied back before it changes.
+  EXPECT_FALSE(index.insert("-a1", cmdo::OptionIndex::Kind::Arg, 40));
+  EXPECT_TRUE(index.insert("-a40", cmdo::OptionIndex::Kind::Arg, 40));
+  EXPECT_NE(copy.data(), index.table_bytes().data());
+  EXPECT_EQ(42, index.size());
+  EXPECT_EQ(12, index.find("-a12").position);
+  EXPECT_EQ(40, index.find("-a40").position);
+}
+
+TEST_F(OptionIndexTest, Attach_Ignores_Out_Of_Bounds_Slots) {
+  cmdo::OptionIndex saved;
+  saved.insert("-s1", cmdo::OptionIndex::Kind::Switch, 0);
+  saved.insert("-a0", cmdo::OptionIndex::Kind::Arg, 0);
+  saved.insert("-a1", cmdo::OptionIndex::Kind::Arg, 1);
+  std::string_view const table = saved.table_bytes();
+  std::vector<std::uint64_t> aligned(table.size() / sizeof(std::uint64_t));
+  std::memcpy(aligned.data(), table.data(), table.size());
+  std::string_view const copy(reinterpret_cast<char const *>(aligned.data()),
+                              table.size());
+
+  // As if the file was damaged: positions or names out of bounds.
+  cmdo::OptionIndex index;
+  ASSERT_TRUE(index.attach(copy, saved.name_bytes(), 3, 1, 1));
+  EXPECT_TRUE(index.find("-a0").found());
+  EXPECT_FALSE(index.find("-a1").found());
+  ASSERT_TRUE(index.attach(copy, saved.name_bytes().substr(0, 6), 3, 1, 2));
+  EXPECT_TRUE(index.find("-s1").found());
+  EXPECT_TRUE(index.find("-a0").found());
+  EXPECT_FALSE(index.find("-a1").found());
+
+  // Left out when copied back.
+  EXPECT_TRUE(index.insert("-a2", cmdo::OptionIndex::Kind::Arg, 2));
+  EXPECT_EQ(3, index.size());
+  EXPECT_FALSE(index.find("-a1").found());
+  EXPECT_TRUE(index.insert("-a1", cmdo::OptionIndex::Kind::Arg, 3));
+}
+
+TEST_F(OptionIndexTest, Attach_Keeps_Probe_Chains_Past_Out_Of_Bounds_Slots) {
+  // Enough names for some to be stored past the slot of another.
+  int const count = 15;
+  for (int bad(0); bad < count; ++bad) {
+    cmdo::OptionIndex saved;
+    for (int i(0); i < count; ++i) {
+      saved.insert("-a" + std::to_string(i), cmdo::OptionIndex::Kind::Arg,
+                   i == bad ? count : i);
+    }
+    std::string_view const table = saved.table_bytes();
+    std::vector<std::uint64_t> aligned(table.size() / sizeof(std::uint64_t));
+    std::memcpy(aligned.data(), table.data(), table.size());
+    std::string_view const copy(
+        reinterpret_cast<char const *>(aligned.data()), table.size());
+
+    cmdo::OptionIndex index;
+    ASSERT_TRUE(index.attach(copy, saved.name_bytes(), count, 0, count));
+    EXPECT_TRUE(index.insert("-s1", cmdo::OptionIndex::Kind::Switch, 0));
+    EXPECT_EQ(count, index.size());
+    for (int i(0); i < count; ++i) {
+      EXPECT_EQ(i != bad, index.find("-a" + std::to_string(i)).found())
+          << "-a" << i << " with -a" << bad << " out of bounds";
+    }
+  }
+}
+
+#endif //CMDO_OPTIONINDEXTEST_H
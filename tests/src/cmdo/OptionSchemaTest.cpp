@@ -0,0 +1 @@
+#include "cmdo/OptionSchemaTest.h"
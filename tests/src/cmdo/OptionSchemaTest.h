@@ -0,0 +1,185 @@
+#ifndef CMDO_OPTIONSCHEMATEST_H
+#define CMDO_OPTIONSCHEMATEST_H
+
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmdo/OptionSchema.h>
+#include <cmdo/ParseResult.h>
+
+class OptionSchemaTest : public ::testing::Test {
+protected:
+  OptionSchemaTest() {
+    schema_.add_required("-in", "Input file.");
+    schema_.add_optional("-out", "Output file.", "a.out");
+    schema_.add_optional<int>("-n", "Count.", 1);
+    schema_.add_switch("-v", "Verbose.", false);
+  }
+
+  void parse(std::vector<std::string> args, cmdo::ParseResult &result,
+             cmdo::OptionSchema::StringList &left_overs,
+             cmdo::OptionSchema::Problems &problems) const {
+    std::vector<char *> argv;
+    for (std::string &arg : args) {
+      argv.push_back(&arg[0]);
+    }
+    schema_.parse(static_cast<int>(argv.size()), argv.data(), result,
+                  left_overs, problems);
+  }
+
+  cmdo::OptionSchema schema_;
+};
+
+TEST_F(OptionSchemaTest, Parse_Into_Result) {
+  cmdo::ParseResult result(schema_);
+  cmdo::OptionSchema::StringList leftOvers;
+  cmdo::OptionSchema::Problems problems;
+  parse({"prog", "-in", "x.txt", "extra", "-n", "5", "-v"}, result,
+        leftOvers, problems);
+
+  EXPECT_EQ("prog", result.program_name());
+  EXPECT_EQ("x.txt", result.get_option("-in"));
+  EXPECT_EQ("a.out", result.get_option("-out"));
+  EXPECT_EQ(5, result.get_option_as<int>("-n"));
+  EXPECT_TRUE(result.get_switch("-v"));
+  EXPECT_EQ(cmdo::OptionSchema::StringList{"extra"}, leftOvers);
+  EXPECT_TRUE(problems.missing_options.empty());
+  EXPECT_TRUE(problems.options_with_no_value.empty());
+  EXPECT_TRUE(problems.invalid_options.empty());
+}
+
+TEST_F(OptionSchemaTest, Parse_Reports_Problems) {
+  cmdo::ParseResult result(schema_);
+  cmdo::OptionSchema::StringList leftOvers;
+  cmdo::OptionSchema::Problems problems;
+  parse({"prog", "-n", "many", "-out"}, result, leftOvers, problems);
+
+  EXPECT_EQ(cmdo::OptionSchema::StringList{"-in"}, problems.missing_options);
+  EXPECT_EQ(cmdo::OptionSchema::StringList{"-out"},
+            problems.options_with_no_value);
+  EXPECT_EQ(cmdo::OptionSchema::StringList{"-n"}, problems.invalid_options);
+  EXPECT_THROW(result.get_option("-in"), cmdo::OptionNotSet);
+  EXPECT_THROW(result.get_option("-nope"), cmdo::UndefinedOption);
+
+  // A result is reused: nothing of the previous parse is left.
+  parse({"prog", "-in", "y"}, result, leftOvers, problems);
+  EXPECT_EQ("y", result.get_option("-in"));
+  EXPECT_EQ(1, result.get_option_as<int>("-n"));
+  EXPECT_TRUE(problems.missing_options.empty());
+  EXPECT_TRUE(problems.invalid_options.empty());
+}
+
+TEST_F(OptionSchemaTest, Concurrent_Parses) {
+  std::vector<std::string> failures(4);
+  std::vector<std::thread> threads;
+  for (std::size_t t(0); t < failures.size(); ++t) {
+    threads.emplace_back([this, t, &failures]() {
+      cmdo::ParseResult result(schema_);
+      cmdo::OptionSchema::StringList leftOvers;
+      cmdo::OptionSchema::Problems problems;
+      for (int i(0); i < 200; ++i) {
+        std::string const in = std::to_string(t) + "_" + std::to_string(i);
+        parse({"prog", "-in", in, "-n", std::to_string(i)}, result,
+              leftOvers, problems);
+        if (result.get_option("-in") != in
+            || result.get_option_as<int>("-n") != i
+            || !problems.invalid_options.empty()) {
+          failures[t] = in;
+          return;
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (std::string const &failure : failures) {
+    EXPECT_EQ("", failure);
+  }
+}
+
+TEST_F(OptionSchemaTest, Parse_Loaded_Schema) {
+  schema_.add_list("-I", "Include directories.", ',');
+  std::string const path = ::testing::TempDir() + "parse.schema";
+  ASSERT_TRUE(schema_.save(path));
+
+  // Read from the file in place.
+  cmdo::OptionSchema loaded;
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_TRUE(loaded.is_arg("-in"));
+  EXPECT_TRUE(loaded.is_list("-I"));
+  EXPECT_TRUE(loaded.is_switch("-v"));
+  EXPECT_FALSE(loaded.is_arg("-nope"));
+  EXPECT_EQ("-out", loaded.suggest_option("-ou"));
+  loaded.attach_validator("-n", [](std::string const &,
+                                   std::string const &value) {
+    return value != "0";
+  });
+
+  cmdo::ParseResult result(loaded);
+  cmdo::OptionSchema::StringList leftOvers;
+  cmdo::OptionSchema::Problems problems;
+  std::vector<std::string> args{"prog", "-in", "x.txt", "-n", "0", "-I",
+                                "a,b", "-v"};
+  std::vector<char *> argv;
+  for (std::string &arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  loaded.parse(static_cast<int>(argv.size()), argv.data(), result, leftOvers,
+               problems);
+  EXPECT_EQ("x.txt", result.get_option("-in"));
+  EXPECT_EQ("a.out", result.get_option("-out"));
+  EXPECT_EQ(0, result.get_option_as<int>("-n"));
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), result.get_list("-I"));
+  EXPECT_TRUE(result.get_switch("-v"));
+  EXPECT_EQ(cmdo::OptionSchema::StringList{"-n"}, problems.invalid_options);
+
+  // Copied out of the file once an option is added.
+  loaded.add_optional("-added", "Added after loading.", "z");
+  loaded.parse(static_cast<int>(argv.size()), argv.data(), result, leftOvers,
+               problems);
+  EXPECT_EQ("x.txt", result.get_option("-in"));
+  EXPECT_EQ("z", result.get_option("-added"));
+  EXPECT_TRUE(loaded.is_list("-I"));
+  EXPECT_EQ(cmdo::OptionSchema::StringList{"-n"}, problems.invalid_options);
+}
+
+TEST_F(OptionSchemaTest, Allocate_From_Memory_Resource) {
+  // Nothing can be allocated past the buffer.
+  std::vector<char> buffer(1 << 16);
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+                                            std::pmr::null_memory_resource());
+  cmdo::OptionSchema schema(&arena);
+  schema.add_required("-in", "Input file.");
+  schema.add_optional<int>("-n", "Count.", 1);
+  schema.add_list<int>("-id", "Ids.", ',');
+  schema.add_switch("-v", "Verbose.", false);
+  EXPECT_EQ(&arena, schema.memory_resource());
+
+  cmdo::ParseResult result(schema, &arena);
+  EXPECT_EQ(&arena, result.memory_resource());
+  std::vector<std::string> args{"prog", "-in", "x.txt", "-n", "5", "-id",
+                                "1,2", "-v"};
+  std::vector<char *> argv;
+  for (std::string &arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  cmdo::OptionSchema::StringList leftOvers;
+  cmdo::OptionSchema::Problems problems;
+  schema.parse(static_cast<int>(argv.size()), argv.data(), result, leftOvers,
+               problems);
+  EXPECT_EQ("x.txt", result.get_option("-in"));
+  EXPECT_EQ(5, result.get_option_as<int>("-n"));
+  EXPECT_EQ((std::vector<int>{1, 2}), result.get_list_as<int>("-id"));
+  EXPECT_TRUE(result.get_switch("-v"));
+
+  // Copies use the default resource.
+  cmdo::ParseResult const copy(result);
+  EXPECT_EQ(std::pmr::get_default_resource(), copy.memory_resource());
+  EXPECT_EQ("x.txt", copy.get_option("-in"));
+  EXPECT_EQ(5, copy.get_option_as<int>("-n"));
+}
+
+#endif //CMDO_OPTIONSCHEMATEST_H
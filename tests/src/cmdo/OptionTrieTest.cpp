@@ -0,0 +1 @@
+#include "cmdo/OptionTrieTest.h"
@@ -0,0 +1,48 @@
+#ifndef CMDO_OPTIONTRIETEST_H
+#define CMDO_OPTIONTRIETEST_H
+
+#include <gtest/gtest.h>
+#include <string>
+#include <cmdo/OptionTrie.h>
+
+class OptionTrieTest : public ::testing::Test {
+protected:
+  OptionTrieTest() {
+    trie_.insert("-threads", cmdo::OptionIndex::Kind::Arg, 0);
+    trie_.insert("-throttle", cmdo::OptionIndex::Kind::Arg, 1);
+    trie_.insert("-v", cmdo::OptionIndex::Kind::Switch, 0);
+    trie_.insert("-verbose", cmdo::OptionIndex::Kind::Switch, 1);
+  }
+
+  cmdo::OptionTrie trie_;
+};
+
+TEST_F(OptionTrieTest, Unique_Prefix) {
+  cmdo::OptionIndex::Entry entry = trie_.find_prefix("-thre");
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Arg, entry.kind);
+  EXPECT_EQ(0, entry.position);
+  entry = trie_.find_prefix("-thro");
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Arg, entry.kind);
+  EXPECT_EQ(1, entry.position);
+  entry = trie_.find_prefix("-ve");
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Switch, entry.kind);
+  EXPECT_EQ(1, entry.position);
+  entry = trie_.find_prefix("-threads");
+  EXPECT_EQ(cmdo::OptionIndex::Kind::Arg, entry.kind);
+}
+
+TEST_F(OptionTrieTest, Ambiguous_Or_Unknown) {
+  EXPECT_FALSE(trie_.find_prefix("-thr").found());
+  // "-v" is a name, but also the prefix of "-verbose".
+  EXPECT_FALSE(trie_.find_prefix("-v").found());
+  EXPECT_FALSE(trie_.find_prefix("-").found());
+  EXPECT_FALSE(trie_.find_prefix("-x").found());
+  EXPECT_FALSE(trie_.find_prefix("-threadsx").found());
+
+  trie_.clear();
+  EXPECT_FALSE(trie_.find_prefix("-thre").found());
+  trie_.insert("-threads", cmdo::OptionIndex::Kind::Arg, 3);
+  EXPECT_EQ(3, trie_.find_prefix("-t").position);
+}
+
+#endif //CMDO_OPTIONTRIETEST_H
@@ -0,0 +1 @@
+#include "cmdo/ParseResultTest.h"
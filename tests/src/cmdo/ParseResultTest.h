@@ -0,0 +1,102 @@
+#ifndef CMDO_PARSERESULTTEST_H
+#define CMDO_PARSERESULTTEST_H
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmdo/CmdLineOptions.h>
+#include <cmdo/OptionSchema.h>
+#include <cmdo/ParseResult.h>
+
+class ParseResultTest : public ::testing::Test {
+protected:
+  ParseResultTest() {
+    schema_.add_optional("-in", "Input file.", "none");
+    schema_.add_switch("-v", "Verbose.", false);
+  }
+
+  cmdo::OptionSchema schema_;
+};
+
+TEST_F(ParseResultTest, Defaults) {
+  cmdo::ParseResult const result(schema_);
+  EXPECT_EQ(&schema_, &result.schema());
+  EXPECT_EQ("none", result.get_option("-in"));
+  EXPECT_FALSE(result.get_switch("-v"));
+  EXPECT_FALSE(result.get_switch("-nope"));
+}
+
+TEST_F(ParseResultTest, Copy_Has_Its_Own_Values) {
+  std::string program("prog");
+  std::string in("-in");
+  std::string value("a.txt");
+  std::string verbose("-v");
+  char *argv[] = {&program[0], &in[0], &value[0], &verbose[0]};
+  cmdo::OptionSchema::StringList leftOvers;
+  cmdo::OptionSchema::Problems problems;
+
+  std::unique_ptr<cmdo::ParseResult> result(new cmdo::ParseResult(schema_));
+  schema_.parse(4, argv, *result, leftOvers, problems);
+  cmdo::ParseResult const copy(*result);
+  // Values were copied from argv, and the copy points into its own buffer.
+  value = "b.txt";
+  EXPECT_NE(result->get_option_view("-in").data(),
+            copy.get_option_view("-in").data());
+
+  result->clear();
+  EXPECT_EQ("a.txt", copy.get_option("-in"));
+  result.reset();
+  EXPECT_EQ("a.txt", copy.get_option("-in"));
+  EXPECT_TRUE(copy.get_switch("-v"));
+}
+
+TEST_F(ParseResultTest, Copy_Has_Its_Own_Items) {
+  cmdo::OptionSchema schema;
+  schema.add_list("-I", "Include directories.", ',');
+  schema.add_list<int>("-n", "Numbers.", ',');
+  std::string program("prog");
+  std::string include("-I");
+  std::string dirs("a,b");
+  std::string numbers("-n");
+  std::string values("1,2,3");
+  char *argv[] = {&program[0], &include[0], &dirs[0], &numbers[0],
+                  &values[0]};
+  cmdo::OptionSchema::StringList leftOvers;
+  cmdo::OptionSchema::Problems problems;
+
+  std::unique_ptr<cmdo::ParseResult> result(new cmdo::ParseResult(schema));
+  schema.parse(5, argv, *result, leftOvers, problems);
+  cmdo::ParseResult const copy(*result);
+  dirs = "x,y";
+  result.reset();
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), copy.get_list("-I"));
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), copy.get_list_as<int>("-n"));
+  EXPECT_EQ((std::vector<long>{1, 2, 3}), copy.get_list_as<long>("-n"));
+  EXPECT_THROW(copy.get_list_as<int>("-I"), cmdo::BadCast);
+}
+
+TEST_F(ParseResultTest, Copy_Of_Zero_Copy_Snapshot) {
+  cmdo::CmdLineOptions options("test program");
+  options.set_parser_result_handler([](cmdo::CmdLineOptions::StringList const &,
+                                       cmdo::CmdLineOptions::StringList const &,
+                                       cmdo::CmdLineOptions::StringList const &,
+                                       cmdo::CmdLineOptions::StringList const &) {
+  });
+  options.add_optional("-in", "Input file.", "none");
+  std::string program("prog");
+  std::string in("-in");
+  std::string value("a.txt");
+  char *argv[] = {&program[0], &in[0], &value[0]};
+  cmdo::CmdLineOptions::ViewList leftOvers;
+  options.parse(3, argv, leftOvers);
+
+  cmdo::ParseResult const copy(*options.snapshot());
+  options.reset();
+  // Still a view into argv, which is alive.
+  EXPECT_EQ(value.data(), copy.get_option_view("-in").data());
+  EXPECT_EQ("a.txt", copy.get_option("-in"));
+  EXPECT_EQ("none", options.get_option("-in"));
+}
+
+#endif //CMDO_PARSERESULTTEST_H
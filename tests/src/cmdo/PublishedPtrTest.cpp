@@ -0,0 +1 @@
+#include "cmdo/PublishedPtrTest.h"
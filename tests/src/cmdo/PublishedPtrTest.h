@@ -0,0 +1,65 @@
+#ifndef CMDO_PUBLISHEDPTRTEST_H
+#define CMDO_PUBLISHEDPTRTEST_H
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cmdo/PublishedPtr.h>
+
+class PublishedPtrTest : public ::testing::Test {
+
+};
+
+TEST_F(PublishedPtrTest, Exchange_Returns_Previous) {
+  cmdo::PublishedPtr<int> published(std::make_shared<int const>(1));
+  EXPECT_EQ(1, *published.load());
+  {
+    cmdo::PublishedPtr<int>::Reader reader(published);
+    EXPECT_EQ(1, *reader.get());
+  }
+
+  std::shared_ptr<int const> const previous = published.exchange(
+      std::make_shared<int const>(2));
+  EXPECT_EQ(1, *previous);
+  EXPECT_EQ(1, previous.use_count());
+  EXPECT_EQ(2, *published.load());
+  EXPECT_EQ(2, *published.exchange(std::make_shared<int const>(3)));
+  EXPECT_EQ(3, *published.load());
+}
+
+TEST_F(PublishedPtrTest, Readers_See_Whole_Values) {
+  typedef std::pair<int, int> Value;
+  cmdo::PublishedPtr<Value> published(std::make_shared<Value const>(0, 0));
+  std::atomic<bool> done(false);
+  std::atomic<int> torn(0);
+
+  std::vector<std::thread> readers;
+  for (int i(0); i < 4; ++i) {
+    readers.emplace_back([&published, &done, &torn]() {
+      while (!done.load()) {
+        cmdo::PublishedPtr<Value>::Reader reader(published);
+        if (reader->first != reader->second) {
+          ++torn;
+        }
+      }
+    });
+  }
+  for (int i(1); i <= 2000; ++i) {
+    std::shared_ptr<Value const> previous = published.exchange(
+        std::make_shared<Value const>(i, i));
+    // No reader holds the previous value anymore.
+    ASSERT_EQ(1, previous.use_count());
+    std::const_pointer_cast<Value>(previous)->first = -1;
+  }
+  done = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, torn.load());
+  EXPECT_EQ(2000, published.load()->first);
+}
+
+#endif //CMDO_PUBLISHEDPTRTEST_H
@@ -0,0 +1 @@
+#include "cmdo/ResponseFileTest.h"
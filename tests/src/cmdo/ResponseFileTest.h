@@ -0,0 +1,66 @@
+#ifndef CMDO_RESPONSEFILETEST_H
+#define CMDO_RESPONSEFILETEST_H
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <cmdo/ResponseFile.h>
+
+class ResponseFileTest : public ::testing::Test {
+
+};
+
+TEST_F(ResponseFileTest, Tokenize_Lines) {
+  cmdo::ResponseFile::TokenList tokens{"argv"};
+  cmdo::ResponseFile::tokenize("a b\n\nc\r\n\r\n  d\ne", tokens, 1);
+  EXPECT_EQ((cmdo::ResponseFile::TokenList{"argv", "a b", "c", "  d", "e"}),
+            tokens);
+}
+
+TEST_F(ResponseFileTest, Tokenize_In_Parallel) {
+  std::string contents;
+  for (int i(0); i < 1000; ++i) {
+    contents += "/some/path/file" + std::to_string(i)
+                + (i % 7 == 0 ? "\r\n" : "\n");
+    if (i % 13 == 0) {
+      contents += "\n";
+    }
+  }
+  cmdo::ResponseFile::TokenList expected;
+  cmdo::ResponseFile::tokenize(contents, expected, 1);
+  ASSERT_EQ(1000, expected.size());
+
+  for (unsigned threads : {2u, 3u, 8u, 64u, 5000u}) {
+    cmdo::ResponseFile::TokenList tokens;
+    cmdo::ResponseFile::tokenize(contents, tokens, threads);
+    EXPECT_EQ(expected, tokens) << threads << " threads";
+  }
+  cmdo::ResponseFile::TokenList tokens;
+  cmdo::ResponseFile::tokenize("x", tokens, 4);
+  EXPECT_EQ((cmdo::ResponseFile::TokenList{"x"}), tokens);
+}
+
+TEST_F(ResponseFileTest, Map_File) {
+  std::string const path = ::testing::TempDir() + "response.txt";
+  std::ofstream(path) << "-in\ninput file.txt\n";
+
+  cmdo::ResponseFile file(path);
+  ASSERT_TRUE(file.is_open());
+  EXPECT_EQ("-in\ninput file.txt\n", file.contents());
+  cmdo::ResponseFile::TokenList tokens;
+  file.tokenize(tokens);
+  ASSERT_EQ(2, tokens.size());
+  EXPECT_EQ("input file.txt", tokens[1]);
+  // Views into the mapping.
+  EXPECT_EQ(file.contents().data() + 4, tokens[1].data());
+
+  std::ofstream(path, std::ios::trunc);
+  cmdo::ResponseFile empty(path);
+  EXPECT_TRUE(empty.is_open());
+  EXPECT_TRUE(empty.contents().empty());
+
+  EXPECT_FALSE(cmdo::ResponseFile(path + ".missing").is_open());
+  EXPECT_FALSE(cmdo::ResponseFile(::testing::TempDir()).is_open());
+}
+
+#endif //CMDO_RESPONSEFILETEST_H
@@ -0,0 +1 @@
+#include "cmdo/ShellTokenizerTest.h"
@@ -0,0 +1,71 @@
+#ifndef CMDO_SHELLTOKENIZERTEST_H
+#define CMDO_SHELLTOKENIZERTEST_H
+
+#include <gtest/gtest.h>
+#include <string>
+#include <cmdo/ShellTokenizer.h>
+
+class ShellTokenizerTest : public ::testing::Test {
+protected:
+  cmdo::ShellTokenizer::TokenList tokenize(std::string_view line) {
+    cmdo::ShellTokenizer::TokenList tokens;
+    tokenizer_.tokenize(line, tokens);
+    return tokens;
+  }
+
+  cmdo::ShellTokenizer tokenizer_;
+};
+
+TEST_F(ShellTokenizerTest, Split_On_Blanks) {
+  EXPECT_TRUE(tokenize("").empty());
+  EXPECT_TRUE(tokenize(" \t\n ").empty());
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"prog", "-a", "1", "x"}),
+            tokenize("  prog -a\t1 \n x "));
+}
+
+TEST_F(ShellTokenizerTest, Unquoted_Tokens_Point_Into_Line) {
+  std::string const line = "prog -in /tmp/a.txt";
+  cmdo::ShellTokenizer::TokenList const tokens = tokenize(line);
+  ASSERT_EQ(3, tokens.size());
+  EXPECT_EQ(line.data(), tokens[0].data());
+  EXPECT_EQ(line.data() + 5, tokens[1].data());
+  EXPECT_EQ(line.data() + 9, tokens[2].data());
+}
+
+TEST_F(ShellTokenizerTest, Quotes_And_Escapes) {
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"a b", "c d", "e f", ""}),
+            tokenize("'a b' \"c d\" e\\ f ''"));
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"abcdef"}),
+            tokenize("a'b'\"c\"d\\ef"));
+  // Nothing is special between single quotes.
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"\\n \"$HOME\""}),
+            tokenize("'\\n \"$HOME\"'"));
+  // Between double quotes, a backslash only escapes a few characters.
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"\\n \"$`\\ 'x'"}),
+            tokenize("\"\\n \\\"\\$\\`\\\\ 'x'\""));
+  // Line continuations are removed.
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"ab", "c", "de"}),
+            tokenize("a\\\nb \\\n c \"d\\\ne\""));
+  // Nothing is expanded.
+  EXPECT_EQ((cmdo::ShellTokenizer::TokenList{"$HOME", "~", "*.txt"}),
+            tokenize("$HOME ~ *.txt"));
+}
+
+TEST_F(ShellTokenizerTest, Throws_On_Bad_Lines) {
+  cmdo::ShellTokenizer::TokenList tokens{"kept"};
+  for (char const *line : {"a 'b", "a \"b", "a \"b\\\"", "a b\\"}) {
+    EXPECT_THROW(tokenizer_.tokenize(line, tokens), cmdo::BadCommandLine)
+        << line;
+    EXPECT_EQ(cmdo::ShellTokenizer::TokenList{"kept"}, tokens);
+  }
+}
+
+TEST_F(ShellTokenizerTest, For_Each_Token) {
+  std::vector<std::string> tokens;
+  tokenizer_.for_each_token("x 'y z'", [&tokens](std::string_view token) {
+    tokens.emplace_back(token);
+  });
+  EXPECT_EQ((std::vector<std::string>{"x", "y z"}), tokens);
+}
+
+#endif //CMDO_SHELLTOKENIZERTEST_H
@@ -0,0 +1 @@
+#include "cmdo/StaticOptionsTest.h"
@@ -0,0 +1,183 @@
+#ifndef CMDO_STATICOPTIONSTEST_H
+#define CMDO_STATICOPTIONSTEST_H
+
+#include <gtest/gtest.h>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmdo/CmdLineOptions.h>
+#include <cmdo/StaticOptions.h>
+
+namespace static_options_test {
+
+CMDO_REQUIRED(In, "-in", "an input file");
+CMDO_REQUIRED(Out, "-out", "an output file");
+CMDO_OPTIONAL(Opt1, "-opt1", "this is optional", "5");
+CMDO_OPTIONAL(Opt2, "-opt2", "this is optional too", "empty");
+CMDO_SWITCH(Super, "-super", "do the work in super mode.", false);
+CMDO_SWITCH(Quiet, "-quiet", "less output.", true);
+
+typedef cmdo::StaticOptions<In, Out, Opt1, Opt2, Super, Quiet> Schema;
+
+struct Results {
+  cmdo::CmdLineOptions::StringList unknown;
+  cmdo::CmdLineOptions::StringList missing;
+  cmdo::CmdLineOptions::StringList empty;
+  cmdo::CmdLineOptions::StringList invalid;
+};
+
+inline cmdo::CmdLineOptions::ParserResultHandler capture(Results &results) {
+  return [&results](cmdo::CmdLineOptions::StringList const &unknown,
+                    cmdo::CmdLineOptions::StringList const &missing,
+                    cmdo::CmdLineOptions::StringList const &empty,
+                    cmdo::CmdLineOptions::StringList const &invalid) {
+    results = Results{unknown, missing, empty, invalid};
+  };
+}
+
+inline void add_runtime_options(cmdo::CmdLineOptions &options) {
+  options.add_required("-in", "an input file");
+  options.add_required("-out", "an output file");
+  options.add_optional("-opt1", "this is optional", "5");
+  options.add_optional("-opt2", "this is optional too", "empty");
+  options.add_switch("-super", "do the work in super mode.", false);
+  options.add_switch("-quiet", "less output.", true);
+}
+
+}
+
+class StaticOptionsTest : public ::testing::Test {
+protected:
+  /**
+   * @brief Builds an argv whose strings live as long as the fixture.
+   */
+  char **make_argv(int *argc_out, std::vector<std::string> const &args) {
+    storage_.push_back(args);
+    std::vector<std::string> &strings = storage_.back();
+    strings.insert(strings.begin(), "test_program");
+    pointers_.push_back(std::vector<char *>());
+    for (std::string &s : strings) {
+      pointers_.back().push_back(&s[0]);
+    }
+    *argc_out = static_cast<int>(strings.size());
+    return pointers_.back().data();
+  }
+
+  /**
+   * @brief Parses args with a CmdLineOptions and a StaticOptions defining
+   * the same options, and checks that both produce the same results.
+   */
+  void expect_same_results(std::vector<std::string> const &args) {
+    using namespace static_options_test;
+    int argc;
+    char **argv = make_argv(&argc, args);
+
+    cmdo::CmdLineOptions runtime("test program");
+    add_runtime_options(runtime);
+    Results runtimeResults;
+    runtime.set_parser_result_handler(capture(runtimeResults));
+    runtime.attach_validator("-opt1", [](std::string const &,
+                                         std::string const &value) {
+      return value.size() == 1;
+    });
+
+    Schema compiled("test program");
+    Results compiledResults;
+    compiled.set_parser_result_handler(capture(compiledResults));
+    compiled.attach_validator<Opt1>([](std::string const &,
+                                       std::string const &value) {
+      return value.size() == 1;
+    });
+
+    cmdo::CmdLineOptions::StringList runtimeLeftOvers;
+    cmdo::CmdLineOptions::StringList compiledLeftOvers;
+    runtime.parse(argc, argv, runtimeLeftOvers);
+    compiled.parse(argc, argv, compiledLeftOvers);
+
+    EXPECT_EQ(runtimeLeftOvers, compiledLeftOvers);
+    EXPECT_EQ(runtimeResults.unknown, compiledResults.unknown);
+    EXPECT_EQ(runtimeResults.missing, compiledResults.missing);
+    EXPECT_EQ(runtimeResults.empty, compiledResults.empty);
+    EXPECT_EQ(runtimeResults.invalid, compiledResults.invalid);
+    EXPECT_EQ(runtime.program_name(), compiled.program_name());
+
+    expect_same_option<In>(runtime, compiled, "-in");
+    expect_same_option<Out>(runtime, compiled, "-out");
+    expect_same_option<Opt1>(runtime, compiled, "-opt1");
+    expect_same_option<Opt2>(runtime, compiled, "-opt2");
+    EXPECT_EQ(runtime.get_switch("-super"), compiled.get_switch<Super>());
+    EXPECT_EQ(runtime.get_switch("-quiet"), compiled.get_switch<Quiet>());
+
+    runtime.set_usage_width(50);
+    compiled.set_usage_width(50);
+    std::ostringstream runtimeUsage;
+    std::ostringstream compiledUsage;
+    runtime.print_usage(runtimeUsage);
+    compiled.print_usage(compiledUsage);
+    EXPECT_EQ(runtimeUsage.str(), compiledUsage.str());
+  }
+
+  template<typename Option>
+  void expect_same_option(cmdo::CmdLineOptions const &runtime,
+                          static_options_test::Schema const &compiled,
+                          std::string const &name) {
+    try {
+      std::string const value = runtime.get_option(name);
+      EXPECT_EQ(value, compiled.get_option<Option>());
+    } catch (cmdo::OptionNotSet const &) {
+      EXPECT_THROW(compiled.get_option<Option>(), cmdo::OptionNotSet);
+    }
+  }
+
+private:
+  std::list<std::vector<std::string>> storage_;
+  std::list<std::vector<char *>> pointers_;
+};
+
+TEST_F(StaticOptionsTest, Find) {
+  using namespace static_options_test;
+  EXPECT_EQ(0, Schema::find("-h"));
+  EXPECT_EQ(1, Schema::find("-in"));
+  EXPECT_EQ(6, Schema::find("-quiet"));
+  EXPECT_EQ(Schema::SIZE, Schema::find("-i"));
+  EXPECT_EQ(Schema::SIZE, Schema::find("-input"));
+  EXPECT_EQ(Schema::SIZE, Schema::find(""));
+  static_assert(Schema::find("-opt2") == 4, "find() is constexpr");
+}
+
+TEST_F(StaticOptionsTest, Same_Results_As_CmdLineOptions) {
+  expect_same_results({});
+  expect_same_results({"-in", "a.txt", "-out", "b.txt"});
+  expect_same_results({"-in", "a.txt", "-super", "-quiet", "-opt1", "7"});
+  expect_same_results({"x", "-in", "a.txt", "y", "-out", "b.txt", "z"});
+  expect_same_results({"-opt1", "77", "-opt2", "-in"});
+  expect_same_results({"-in", "a.txt", "-out"});
+  expect_same_results({"-super", "-super", "-in", "1", "-in", "2"});
+}
+
+TEST_F(StaticOptionsTest, Get_Option_As) {
+  using namespace static_options_test;
+  int argc;
+  char **argv = make_argv(&argc, {"-opt2", "0.5"});
+
+  Schema options("test program");
+  Results results;
+  options.set_parser_result_handler(capture(results));
+  cmdo::CmdLineOptions::StringList leftOvers;
+  options.parse(argc, argv, leftOvers);
+  EXPECT_EQ(5, (options.get_option_as<Opt1, int>()));
+  EXPECT_EQ(0.5, (options.get_option_as<Opt2, double>()));
+  EXPECT_THROW((options.get_option_as<In, int>()), cmdo::OptionNotSet);
+}
+
+TEST_F(StaticOptionsTest, Bad_Functions_Throw) {
+  using namespace static_options_test;
+  Schema options("test program");
+  EXPECT_THROW(options.set_parser_result_handler(
+      cmdo::CmdLineOptions::ParserResultHandler()), cmdo::BadFunction);
+  EXPECT_THROW(options.attach_validator<In>(
+      cmdo::CmdLineOptions::ValidatorFunction()), cmdo::BadFunction);
+}
+
+#endif //CMDO_STATICOPTIONSTEST_H
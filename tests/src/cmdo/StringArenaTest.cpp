@@ -0,0 +1 @@
+#include "cmdo/StringArenaTest.h"
@@ -0,0 +1,53 @@
+#ifndef CMDO_STRINGARENATEST_H
+#define CMDO_STRINGARENATEST_H
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <cmdo/StringArena.h>
+
+class StringArenaTest : public ::testing::Test {
+
+};
+
+TEST_F(StringArenaTest, Store_Copies) {
+  cmdo::StringArena arena(16);
+  std::string s("hello");
+  std::string_view const v = arena.store(s);
+  s[0] = 'j';
+  EXPECT_EQ("hello", v);
+  EXPECT_NE(s.data(), v.data());
+  EXPECT_EQ(5, arena.size());
+  EXPECT_TRUE(arena.store("").empty());
+}
+
+TEST_F(StringArenaTest, Views_Survive_New_Chunks) {
+  cmdo::StringArena arena(16);
+  std::vector<std::string_view> views;
+  for (int i(0); i < 100; ++i) {
+    views.push_back(arena.store("value" + std::to_string(i)));
+  }
+  // Bigger than a chunk.
+  std::string const big(100, 'x');
+  std::string_view const bigView = arena.store(big);
+  for (int i(0); i < 100; ++i) {
+    EXPECT_EQ("value" + std::to_string(i), views[i]);
+  }
+  EXPECT_EQ(big, bigView);
+}
+
+TEST_F(StringArenaTest, Clear_Reuses_Chunks) {
+  cmdo::StringArena arena(64);
+  for (int i(0); i < 100; ++i) {
+    arena.store("value" + std::to_string(i));
+  }
+  std::size_t const capacity = arena.capacity();
+  arena.clear();
+  EXPECT_EQ(0, arena.size());
+  for (int i(0); i < 100; ++i) {
+    arena.store("value" + std::to_string(i));
+  }
+  EXPECT_EQ(capacity, arena.capacity());
+}
+
+#endif //CMDO_STRINGARENATEST_H
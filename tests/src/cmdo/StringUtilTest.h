@@ -2,6 +2,11 @@
 #define CMDO_STRINGUTILTEST_H
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <cmdo/StringUtil.h>
 
 class StringUtilTest : public ::testing::Test {
@@ -25,6 +30,56 @@ TEST_F(StringUtilTest, from_string) {
   EXPECT_EQ(1234, cmdo::from_string<int>("1234"));
 }
 
+TEST_F(StringUtilTest, to_string_numbers) {
+  EXPECT_EQ("-42", cmdo::to_string(-42));
+  EXPECT_EQ("18446744073709551615",
+            cmdo::to_string(std::numeric_limits<unsigned long long>::max()));
+  EXPECT_EQ("0.1", cmdo::to_string(0.1));
+  EXPECT_EQ("1e+20", cmdo::to_string(1e20));
+  EXPECT_EQ("abc", cmdo::to_string(std::string("abc")));
+  EXPECT_EQ("abc", cmdo::to_string(std::string_view("abc")));
+}
+
+TEST_F(StringUtilTest, from_string_bool_ignores_case) {
+  EXPECT_TRUE(cmdo::from_string<bool>("TRUE"));
+  EXPECT_TRUE(cmdo::from_string<bool>("Yes"));
+  EXPECT_FALSE(cmdo::from_string<bool>("False"));
+  EXPECT_FALSE(cmdo::from_string<bool>("NO"));
+  EXPECT_THROW(cmdo::from_string<bool>("tru"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<bool>("yess"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<bool>("1"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<bool>(""), cmdo::BadCast);
+}
+
+TEST_F(StringUtilTest, from_string_consumes_whole_string) {
+  EXPECT_EQ(5, cmdo::from_string<int>("+5"));
+  EXPECT_EQ(-5, cmdo::from_string<int>("-5"));
+  EXPECT_EQ(2.5, cmdo::from_string<double>("2.5"));
+  EXPECT_EQ(1e-3, cmdo::from_string<double>("1e-3"));
+  EXPECT_THROW(cmdo::from_string<int>("12abc"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<int>(" 12"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<int>("12 "), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<int>("1.5"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<int>(""), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<int>("+"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<int>("+-1"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<double>("0.5x"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<double>("0,5"), cmdo::BadCast);
+}
+
+TEST_F(StringUtilTest, from_string_detects_overflow) {
+  EXPECT_EQ(2147483647, cmdo::from_string<int>("2147483647"));
+  EXPECT_THROW(cmdo::from_string<int>("2147483648"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<short>("40000"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<unsigned>("-1"), cmdo::BadCast);
+  EXPECT_THROW(cmdo::from_string<double>("1e999"), cmdo::BadCast);
+}
+
+TEST_F(StringUtilTest, from_string_strings) {
+  EXPECT_EQ("two words", cmdo::from_string<std::string>("two words"));
+  EXPECT_EQ('c', cmdo::from_string<char>("c"));
+}
+
 TEST_F(StringUtilTest, trim) {
   std::string s1 = "    spaces in front";
   std::string s2 = "spaces in back    ";
@@ -91,4 +146,73 @@ TEST_F(StringUtilTest, split_skips_empty){
 
 }
 
+TEST_F(StringUtilTest, for_each_item) {
+  std::string const text = "==a=bc===d=";
+  std::vector<std::string_view> items;
+  cmdo::for_each_item(text, '=', [&items](std::string_view item) {
+    items.push_back(item);
+  });
+  ASSERT_EQ(3, items.size());
+  EXPECT_EQ("a", items[0]);
+  EXPECT_EQ("bc", items[1]);
+  EXPECT_EQ("d", items[2]);
+  // Views into text.
+  EXPECT_EQ(text.data() + 2, items[0].data());
+
+  // Same items as split().
+  std::vector<std::string> split;
+  cmdo::split(split, text, '=');
+  EXPECT_EQ(split, std::vector<std::string>(items.begin(), items.end()));
+
+  items.clear();
+  cmdo::for_each_item("abc", '\0', [&items](std::string_view item) {
+    items.push_back(item);
+  });
+  EXPECT_EQ(std::vector<std::string_view>{"abc"}, items);
+}
+
+TEST_F(StringUtilTest, edit_distance) {
+  EXPECT_EQ(0, cmdo::edit_distance("-threads", "-threads", 2));
+  EXPECT_EQ(1, cmdo::edit_distance("-thread", "-threads", 2));
+  EXPECT_EQ(1, cmdo::edit_distance("-threads", "-thread", 2));
+  EXPECT_EQ(2, cmdo::edit_distance("-thraeds", "-threads", 1));
+  EXPECT_EQ(2, cmdo::edit_distance("-thraeds", "-threads", 2));
+  EXPECT_EQ(1, cmdo::edit_distance("-ot", "-out", 3));
+  EXPECT_EQ(3, cmdo::edit_distance("", "abc", 5));
+  // Over the bound, the bound + 1.
+  EXPECT_EQ(2, cmdo::edit_distance("-in", "-verbose", 1));
+  EXPECT_EQ(3, cmdo::edit_distance("-abcdef", "-uvwxyz", 2));
+}
+
+TEST_F(StringUtilTest, edit_distance_matches_full_matrix) {
+  auto const full = [](std::string const &a, std::string const &b) {
+    std::vector<std::vector<std::size_t>> d(
+        a.size() + 1, std::vector<std::size_t>(b.size() + 1));
+    for (std::size_t i(0); i <= a.size(); ++i) {
+      for (std::size_t j(0); j <= b.size(); ++j) {
+        if (i == 0 || j == 0) {
+          d[i][j] = i + j;
+          continue;
+        }
+        d[i][j] = std::min(std::min(d[i - 1][j], d[i][j - 1]) + 1,
+                           d[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1));
+      }
+    }
+    return d[a.size()][b.size()];
+  };
+  std::vector<std::string> const words{"", "-a", "-ab", "-ba", "-abc",
+                                       "-thread", "-threads", "-thraeds",
+                                       "-throttle", "--threads", "threads-"};
+  std::vector<std::size_t> row;
+  for (std::string const &a : words) {
+    for (std::string const &b : words) {
+      for (std::size_t bound(0); bound < 4; ++bound) {
+        EXPECT_EQ(std::min(full(a, b), bound + 1),
+                  cmdo::edit_distance(a, b, bound, row))
+            << a << " " << b << " " << bound;
+      }
+    }
+  }
+}
+
 #endif //CMDO_STRINGUTILTEST_H
@@ -0,0 +1 @@
+#include "cmdo/UsageFormatterTest.h"
@@ -0,0 +1,62 @@
+#ifndef CMDO_USAGEFORMATTERTEST_H
+#define CMDO_USAGEFORMATTERTEST_H
+
+#include <gtest/gtest.h>
+#include <string>
+#include <cmdo/UsageFormatter.h>
+
+class UsageFormatterTest : public ::testing::Test {
+};
+
+TEST_F(UsageFormatterTest, Aligns_On_Longest_Name) {
+  cmdo::UsageFormatter usage(80);
+  usage.set_program("prog", "", "Does things.");
+  usage.add_option("-v", true, "verbose", false, "0", false, "");
+  usage.add_option("-output", false, "where to write", true, "", true,
+                   "a.txt");
+  usage.add_command("run", "runs it");
+  std::string text;
+  usage.render(text);
+  EXPECT_EQ("Usage: prog [options]\n"
+            "Description: \n"
+            " Does things.\n"
+            "\n"
+            "Available options:\n"
+            " -v             verbose (def = 0)\n"
+            " -output [...]  where to write(required, curr = a.txt)\n"
+            "\n"
+            "Available commands:\n"
+            " run            runs it\n"
+            "\n", text);
+}
+
+TEST_F(UsageFormatterTest, Wraps_To_Width) {
+  cmdo::UsageFormatter usage(30);
+  usage.set_program("prog", " files", "");
+  usage.add_option("-x", true,
+                   "one two three four five six seven eight nine ten", false,
+                   "1", false, "");
+  std::string text;
+  usage.render(text);
+  EXPECT_EQ("Usage: prog [options] files\n"
+            "Available options:\n"
+            " -x  one two three four five\n"
+            "     six seven eight nine ten\n"
+            "     (def = 1)\n"
+            "\n", text);
+  for (std::size_t pos(0), end; (end = text.find('\n', pos)) != text.npos;
+       pos = end + 1) {
+    EXPECT_LE(end - pos, 30u);
+  }
+
+  // Words longer than the width are kept whole.
+  cmdo::UsageFormatter narrow(10);
+  narrow.add_option("-x", true, "abcdefghijklmnopqrstuvwxyz", true, "",
+                    false, "");
+  text.clear();
+  narrow.render(text);
+  EXPECT_NE(std::string::npos, text.find(
+      " -x  abcdefghijklmnopqrstuvwxyz(required)\n"));
+}
+
+#endif //CMDO_USAGEFORMATTERTEST_H
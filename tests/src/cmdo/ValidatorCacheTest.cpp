@@ -0,0 +1 @@
+#include "cmdo/ValidatorCacheTest.h"
@@ -0,0 +1,74 @@
+#ifndef CMDO_VALIDATORCACHETEST_H
+#define CMDO_VALIDATORCACHETEST_H
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <cmdo/ValidatorCache.h>
+
+class ValidatorCacheTest : public ::testing::Test {
+};
+
+TEST_F(ValidatorCacheTest, Find_And_Insert) {
+  cmdo::ValidatorCache cache(10, std::chrono::milliseconds::zero());
+  bool passed(false);
+  EXPECT_FALSE(cache.find(0, "-in", "a.txt", passed));
+  cache.insert(0, "-in", "a.txt", true);
+  cache.insert(0, "-in", "b.txt", false);
+  EXPECT_TRUE(cache.find(0, "-in", "a.txt", passed));
+  EXPECT_TRUE(passed);
+  EXPECT_TRUE(cache.find(0, "-in", "b.txt", passed));
+  EXPECT_FALSE(passed);
+  // Keyed by validator and option too.
+  EXPECT_FALSE(cache.find(1, "-in", "a.txt", passed));
+  EXPECT_FALSE(cache.find(0, "-out", "a.txt", passed));
+  EXPECT_FALSE(cache.find(0, "-in", "a.tx", passed));
+
+  cmdo::ValidatorCache::Stats const stats = cache.stats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(4, stats.misses);
+  EXPECT_EQ(2, stats.size);
+}
+
+TEST_F(ValidatorCacheTest, Drops_Least_Recently_Used) {
+  cmdo::ValidatorCache cache(2, std::chrono::milliseconds::zero());
+  bool passed(false);
+  cache.insert(0, "-a", "1", true);
+  cache.insert(0, "-a", "2", true);
+  EXPECT_TRUE(cache.find(0, "-a", "1", passed));
+  cache.insert(0, "-a", "3", true);
+  EXPECT_TRUE(cache.find(0, "-a", "1", passed));
+  EXPECT_FALSE(cache.find(0, "-a", "2", passed));
+  EXPECT_TRUE(cache.find(0, "-a", "3", passed));
+  EXPECT_EQ(2, cache.stats().size);
+
+  cache.configure(1, std::chrono::milliseconds::zero());
+  EXPECT_EQ(1, cache.stats().size);
+  EXPECT_TRUE(cache.find(0, "-a", "3", passed));
+
+  cache.configure(0, std::chrono::milliseconds::zero());
+  cache.insert(0, "-a", "4", true);
+  EXPECT_EQ(0, cache.stats().size);
+}
+
+TEST_F(ValidatorCacheTest, Expires_And_Clears) {
+  cmdo::ValidatorCache cache(10, std::chrono::milliseconds(20));
+  bool passed(false);
+  cache.insert(0, "-a", "1", true);
+  EXPECT_TRUE(cache.find(0, "-a", "1", passed));
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  EXPECT_FALSE(cache.find(0, "-a", "1", passed));
+
+  cache.configure(10, std::chrono::milliseconds::zero());
+  cache.insert(0, "-a", "1", true);
+  cache.insert(0, "-ab", "1", true);
+  cache.insert(1, "-b", "1", true);
+  cache.clear("-a");
+  EXPECT_FALSE(cache.find(0, "-a", "1", passed));
+  EXPECT_TRUE(cache.find(0, "-ab", "1", passed));
+  EXPECT_TRUE(cache.find(1, "-b", "1", passed));
+  cache.clear();
+  EXPECT_EQ(0, cache.stats().size);
+}
+
+#endif //CMDO_VALIDATORCACHETEST_H
@@ -0,0 +1 @@
+#include "cmdo/ValidatorPoolTest.h"
@@ -0,0 +1,149 @@
+#ifndef CMDO_VALIDATORPOOLTEST_H
+#define CMDO_VALIDATORPOOLTEST_H
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <cmdo/ValidatorPool.h>
+
+class ValidatorPoolTest : public ::testing::Test {
+};
+
+TEST_F(ValidatorPoolTest, Results_In_Order) {
+  cmdo::ValidatorPool const pool(4, std::chrono::milliseconds::zero());
+  cmdo::ValidatorPool::CheckList checks;
+  for (int i(0); i < 50; ++i) {
+    checks.emplace_back([i]() {
+      return i % 3 != 0;
+    });
+  }
+  std::vector<char> passed;
+  pool.run(checks, passed);
+  ASSERT_EQ(50, passed.size());
+  for (int i(0); i < 50; ++i) {
+    EXPECT_EQ(i % 3 != 0, passed[i] != 0) << i;
+  }
+
+  pool.run(cmdo::ValidatorPool::CheckList(), passed);
+  EXPECT_TRUE(passed.empty());
+}
+
+TEST_F(ValidatorPoolTest, At_Most_Threads_At_Once) {
+  cmdo::ValidatorPool const pool(3, std::chrono::milliseconds::zero());
+  std::atomic<int> running(0);
+  std::atomic<int> most(0);
+  cmdo::ValidatorPool::CheckList checks;
+  for (int i(0); i < 12; ++i) {
+    checks.emplace_back([&running, &most]() {
+      int const now = ++running;
+      int seen = most.load();
+      while (now > seen && !most.compare_exchange_weak(seen, now)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      --running;
+      return true;
+    });
+  }
+  std::vector<char> passed;
+  pool.run(checks, passed);
+  EXPECT_EQ(12, std::count(passed.begin(), passed.end(), 1));
+  EXPECT_LE(most.load(), 3);
+}
+
+TEST_F(ValidatorPoolTest, Expired_Checks_Fail) {
+  cmdo::ValidatorPool const pool(1, std::chrono::milliseconds(50));
+  cmdo::ValidatorPool::CheckList checks;
+  checks.emplace_back([]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    return true;
+  });
+  checks.emplace_back([]() {
+    return true;
+  });
+  std::vector<char> passed;
+  std::vector<std::uint64_t> nanoseconds;
+  auto const start = std::chrono::steady_clock::now();
+  pool.run(checks, passed, &nanoseconds);
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  // The slow check is not waited for, and its thread is replaced so that
+  // the next one still runs.
+  EXPECT_LT(elapsed, std::chrono::milliseconds(900));
+  EXPECT_EQ((std::vector<char>{0, 1}), passed);
+  // The expired check counts for the timeout.
+  ASSERT_EQ(2u, nanoseconds.size());
+  EXPECT_EQ(50000000u, nanoseconds[0]);
+  EXPECT_GT(50000000u, nanoseconds[1]);
+}
+
+TEST_F(ValidatorPoolTest, Reuses_Its_Threads) {
+  cmdo::ValidatorPool const pool(2, std::chrono::milliseconds(1000));
+  std::mutex mutex;
+  std::set<std::thread::id> ids;
+  cmdo::ValidatorPool::CheckList checks;
+  for (int i(0); i < 8; ++i) {
+    checks.emplace_back([&mutex, &ids]() {
+      std::lock_guard<std::mutex> const l(mutex);
+      ids.insert(std::this_thread::get_id());
+      return true;
+    });
+  }
+  std::vector<char> passed;
+  for (int run(0); run < 5; ++run) {
+    pool.run(checks, passed);
+  }
+  EXPECT_LE(ids.size(), 2);
+  EXPECT_EQ(0, ids.count(std::this_thread::get_id()));
+}
+
+TEST_F(ValidatorPoolTest, Caps_Threads_Left_To_Expired_Checks) {
+  cmdo::ValidatorPool const pool(1, std::chrono::milliseconds(20));
+  auto const hang = []() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    return true;
+  };
+  auto const pass = []() {
+    return true;
+  };
+  std::vector<char> passed;
+  auto const start = std::chrono::steady_clock::now();
+  // The first expired check gets its thread replaced; the second one hits
+  // the cap, which leaves no thread for the last check.
+  pool.run({hang, hang, pass}, passed);
+  EXPECT_EQ((std::vector<char>{0, 0, 0}), passed);
+  // Nothing is started while every thread is stuck.
+  pool.run({pass}, passed);
+  EXPECT_EQ(std::vector<char>{0}, passed);
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(250));
+
+  // The stuck thread takes checks again once its check returns.
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  pool.run({pass}, passed);
+  EXPECT_EQ(std::vector<char>{1}, passed);
+}
+
+TEST_F(ValidatorPoolTest, Rethrows_First_Exception) {
+  cmdo::ValidatorPool const pool(2, std::chrono::milliseconds::zero());
+  cmdo::ValidatorPool::CheckList checks;
+  checks.emplace_back([]() {
+    return true;
+  });
+  checks.emplace_back([]() -> bool {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    throw std::runtime_error("first");
+  });
+  checks.emplace_back([]() -> bool {
+    throw std::logic_error("second");
+  });
+  std::vector<char> passed;
+  EXPECT_THROW(pool.run(checks, passed), std::runtime_error);
+}
+
+#endif //CMDO_VALIDATORPOOLTEST_H